@@ -0,0 +1,287 @@
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "system.h"
+#include "audio_decoder.h"
+#include "audio_midi.h"
+#include "audio_mixer.h"
+#include "audio_resampler.h"
+#include "decoder_drwav.h"
+#include "decoder_libsndfile.h"
+#include "filefinder.h"
+#include "filesystem_stream.h"
+#include "utils.h"
+
+/*
+ * Runs the compiled decoders on generated WAV and MIDI files and on every
+ * file of the directory in EP_BENCH_AUDIO_PATH (for the formats which can
+ * not be generated, e.g. OGG, Opus, MP3 and tracker modules).
+ *
+ * Decode/...: DecodeAll in the native format of the decoder
+ * Render/...: resampled to the output format and mixed like the audio callback
+ *
+ * "realtime" is the decoded audio time per second, "allocs" the heap
+ * allocations per second.
+ */
+
+using Format = AudioDecoderBase::Format;
+
+constexpr int output_rate = 44100;
+constexpr int buffer_frames = 2048;
+
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(std::size_t size) {
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+namespace {
+using Factory = std::function<std::unique_ptr<AudioDecoderBase>(Filesystem_Stream::InputStream&, bool resample)>;
+
+void Put16(std::vector<uint8_t>& out, uint16_t v) {
+	out.push_back(v & 0xFF);
+	out.push_back(v >> 8);
+}
+
+void Put32(std::vector<uint8_t>& out, uint32_t v) {
+	Put16(out, v & 0xFFFF);
+	Put16(out, v >> 16);
+}
+
+/** 10 seconds of 16 bit stereo at 22050 Hz */
+std::vector<uint8_t> MakeWav() {
+	const int rate = 22050;
+	const int frames = rate * 10;
+	const uint32_t data_size = frames * 4;
+
+	std::vector<uint8_t> file = { 'R', 'I', 'F', 'F' };
+	Put32(file, 36 + data_size);
+	file.insert(file.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+	Put32(file, 16);
+	Put16(file, 1); // PCM
+	Put16(file, 2);
+	Put32(file, rate);
+	Put32(file, rate * 4);
+	Put16(file, 4);
+	Put16(file, 16);
+	file.insert(file.end(), { 'd', 'a', 't', 'a' });
+	Put32(file, data_size);
+
+	for (int i = 0; i < frames; ++i) {
+		Put16(file, static_cast<int16_t>(12000.0 * std::sin(2.0 * 3.14159265 * 440.0 * i / rate)));
+		Put16(file, static_cast<int16_t>(12000.0 * std::sin(2.0 * 3.14159265 * 660.0 * i / rate)));
+	}
+	return file;
+}
+
+/** 10 seconds at 120 BPM, every channel plays a different program and chords */
+std::vector<uint8_t> MakeMidi() {
+	std::vector<uint8_t> track;
+	auto event = [&](uint8_t delta, std::initializer_list<uint8_t> bytes) {
+		track.push_back(delta);
+		track.insert(track.end(), bytes);
+	};
+
+	for (uint8_t ch = 0; ch < 16; ++ch) {
+		event(0, { static_cast<uint8_t>(0xC0 | ch), static_cast<uint8_t>(ch * 8) });
+	}
+
+	// 20 quarters as eighth notes, 4 channels at once
+	uint32_t seed = 1;
+	for (int step = 0; step < 40; ++step) {
+		uint8_t notes[4];
+		for (int i = 0; i < 4; ++i) {
+			seed = seed * 1103515245 + 12345;
+			notes[i] = static_cast<uint8_t>(36 + (seed >> 16) % 48);
+			event(0, { static_cast<uint8_t>(0x90 | ((step + i * 4) % 16)), notes[i], 100 });
+		}
+		for (int i = 0; i < 4; ++i) {
+			event(i == 0 ? 48 : 0, { static_cast<uint8_t>(0x80 | ((step + i * 4) % 16)), notes[i], 64 });
+		}
+	}
+	event(0, { 0xFF, 0x2F, 0x00 });
+
+	const uint32_t size = static_cast<uint32_t>(track.size());
+	std::vector<uint8_t> file = {
+		'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+		'M', 'T', 'r', 'k', static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16),
+		static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size)
+	};
+	file.insert(file.end(), track.begin(), track.end());
+	return file;
+}
+
+std::unique_ptr<AudioDecoderBase> Open(std::vector<uint8_t>& data, const Factory& create, bool resample) {
+	Filesystem_Stream::InputStream stream(new Filesystem_Stream::InputMemoryStreamBufView(data), "bench");
+	auto dec = create(stream, resample);
+	if (!dec || !dec->Open(std::move(stream))) {
+		return nullptr;
+	}
+	// Like the Player does, the MIDI decoders need it for the tempo
+	dec->SetPitch(100);
+	return dec;
+}
+
+void SetCounters(benchmark::State& state, double seconds, uint64_t allocs) {
+	state.counters["realtime"] = benchmark::Counter(seconds, benchmark::Counter::kIsRate);
+	state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocs), benchmark::Counter::kIsRate);
+}
+
+void BM_Decode(benchmark::State& state, std::vector<uint8_t>* data, Factory create) {
+	double seconds = 0.0;
+	uint64_t allocs = 0;
+
+	for (auto _: state) {
+		const uint64_t start = allocations;
+		auto dec = Open(*data, create, false);
+		if (!dec) {
+			state.SkipWithError("Open failed");
+			break;
+		}
+		auto out = dec->DecodeAll();
+		allocs += allocations - start;
+
+		int frequency;
+		Format format;
+		int channels;
+		dec->GetFormat(frequency, format, channels);
+		seconds += static_cast<double>(out.size()) / (AudioDecoder::GetSamplesizeForFormat(format) * channels * frequency);
+		benchmark::DoNotOptimize(out.data());
+	}
+	SetCounters(state, seconds, allocs);
+}
+
+void BM_Render(benchmark::State& state, std::vector<uint8_t>* data, Factory create) {
+	std::vector<uint8_t> scrap(buffer_frames * 2 * sizeof(float));
+	std::vector<float> mix(buffer_frames * 2);
+	std::vector<int16_t> out(buffer_frames * 2);
+	int64_t frames = 0;
+	uint64_t allocs = 0;
+
+	for (auto _: state) {
+		const uint64_t start = allocations;
+		auto dec = Open(*data, create, true);
+		if (!dec) {
+			state.SkipWithError("Open failed");
+			break;
+		}
+		dec->SetFormat(output_rate, Format::S16, 2);
+		int frequency;
+		Format format;
+		int channels;
+		dec->GetFormat(frequency, format, channels);
+		const int frame_size = AudioDecoder::GetSamplesizeForFormat(format) * channels;
+
+		while (!dec->IsFinished()) {
+			int read = dec->Decode(scrap.data(), buffer_frames * frame_size);
+			if (read <= 0) {
+				break;
+			}
+			std::fill(mix.begin(), mix.end(), 0.0f);
+			AudioMixer::Accumulate(mix.data(), scrap.data(), format, channels, read / frame_size, 1.0f);
+			AudioMixer::Limit(out.data(), mix.data(), static_cast<int>(mix.size()), 1.0f);
+			frames += read / frame_size;
+		}
+		allocs += allocations - start;
+		benchmark::DoNotOptimize(out.data());
+	}
+	SetCounters(state, static_cast<double>(frames) / output_rate, allocs);
+}
+
+void Register(const std::string& name, std::vector<uint8_t>* data, Factory create) {
+	benchmark::RegisterBenchmark(("Decode/" + name).c_str(), BM_Decode, data, create)
+		->Unit(benchmark::kMillisecond)->UseRealTime();
+	benchmark::RegisterBenchmark(("Render/" + name).c_str(), BM_Render, data, create)
+		->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+template <typename T>
+Factory MakeFactory() {
+	return [](Filesystem_Stream::InputStream&, bool resample) -> std::unique_ptr<AudioDecoderBase> {
+		auto dec = std::make_unique<T>();
+		if (resample) {
+			return std::make_unique<AudioResampler>(std::move(dec));
+		}
+		return dec;
+	};
+}
+
+Factory MakeMidiFactory(std::unique_ptr<AudioDecoderBase> (*create)(bool)) {
+	return [create](Filesystem_Stream::InputStream&, bool resample) {
+		return create(resample);
+	};
+}
+
+void RegisterAll() {
+	static std::vector<uint8_t> wav = MakeWav();
+	static std::vector<uint8_t> midi = MakeMidi();
+
+#ifdef WANT_DRWAV
+	Register("drwav/wav", &wav, MakeFactory<DrWavDecoder>());
+#endif
+#ifdef HAVE_LIBSNDFILE
+	Register("libsndfile/wav", &wav, MakeFactory<LibsndfileDecoder>());
+#endif
+#ifdef WANT_FMMIDI
+	Register("fmmidi/mid", &midi, MakeMidiFactory(&MidiDecoder::CreateFmMidi));
+#endif
+#if defined(HAVE_FLUIDSYNTH) || defined(HAVE_FLUIDLITE)
+	Register("fluidsynth/mid", &midi, MakeMidiFactory(&MidiDecoder::CreateFluidsynth));
+#endif
+#ifdef HAVE_LIBWILDMIDI
+	Register("wildmidi/mid", &midi, MakeMidiFactory(&MidiDecoder::CreateWildMidi));
+#endif
+
+	// Every file is played by the decoder the Player would choose
+	const char* path = getenv("EP_BENCH_AUDIO_PATH");
+	if (!path) {
+		return;
+	}
+	static std::vector<std::vector<uint8_t>> files;
+	auto fs = FileFinder::Root().Subtree(path);
+	auto* entries = fs ? fs.ListDirectory() : nullptr;
+	if (!entries) {
+		return;
+	}
+	files.reserve(entries->size());
+	for (const auto& entry: *entries) {
+		if (entry.second.type != DirectoryTree::FileType::Regular) {
+			continue;
+		}
+		auto is = fs.OpenInputStream(entry.second.name);
+		if (!is) {
+			continue;
+		}
+		files.push_back(Utils::ReadStream(is));
+		Register("auto/" + entry.second.name, &files.back(), &AudioDecoder::Create);
+	}
+}
+}
+
+int main(int argc, char** argv) {
+	RegisterAll();
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
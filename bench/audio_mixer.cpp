@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "audio_mixer.h"
+
+using Format = AudioDecoderBase::Format;
+
+// Samples per channel of one audio callback (stereo frames * 2)
+constexpr int buffer_frames = 4096;
+
+template <typename T>
+static std::vector<T> make_channel(int channels, T scale) {
+	std::vector<T> data(buffer_frames * channels);
+	uint32_t seed = 12345;
+	for (auto& v: data) {
+		seed = seed * 1103515245 + 12345;
+		v = static_cast<T>(static_cast<int>((seed >> 16) % 2001) - 1000) * scale / 1000;
+	}
+	return data;
+}
+
+template <typename T>
+static void BM_Accumulate(benchmark::State& state, Format format, int channels, T scale) {
+	const int num_channels = state.range(0);
+	std::vector<std::vector<T>> sources;
+	for (int i = 0; i < num_channels; ++i) {
+		sources.push_back(make_channel<T>(channels, scale));
+	}
+	std::vector<float> mix(buffer_frames * 2);
+
+	for (auto _: state) {
+		std::fill(mix.begin(), mix.end(), 0.0f);
+		for (auto& src: sources) {
+			AudioMixer::Accumulate(mix.data(), src.data(), format, channels, buffer_frames, 0.5f);
+		}
+		benchmark::DoNotOptimize(mix.data());
+	}
+	state.SetItemsProcessed(state.iterations() * num_channels * buffer_frames);
+}
+
+static void BM_AccumulateS16Stereo(benchmark::State& state) {
+	BM_Accumulate<int16_t>(state, Format::S16, 2, 32767);
+}
+
+BENCHMARK(BM_AccumulateS16Stereo)->Arg(1)->Arg(8)->Arg(18);
+
+static void BM_AccumulateS16Mono(benchmark::State& state) {
+	BM_Accumulate<int16_t>(state, Format::S16, 1, 32767);
+}
+
+BENCHMARK(BM_AccumulateS16Mono)->Arg(1)->Arg(8)->Arg(18);
+
+static void BM_AccumulateS32Stereo(benchmark::State& state) {
+	BM_Accumulate<int32_t>(state, Format::S32, 2, 2147483647);
+}
+
+BENCHMARK(BM_AccumulateS32Stereo)->Arg(1)->Arg(8)->Arg(18);
+
+static void BM_AccumulateF32Stereo(benchmark::State& state) {
+	BM_Accumulate<float>(state, Format::F32, 2, 1.0f);
+}
+
+BENCHMARK(BM_AccumulateF32Stereo)->Arg(1)->Arg(8)->Arg(18);
+
+static void BM_AccumulateU8Mono(benchmark::State& state) {
+	// No vector path, for comparison
+	BM_Accumulate<uint8_t>(state, Format::U8, 1, 127);
+}
+
+BENCHMARK(BM_AccumulateU8Mono)->Arg(1)->Arg(8)->Arg(18);
+
+static void BM_Limit(benchmark::State& state) {
+	const float total_volume = state.range(0) / 100.0f;
+	auto mix = make_channel<float>(2, total_volume);
+	std::vector<int16_t> out(mix.size());
+
+	for (auto _: state) {
+		AudioMixer::Limit(out.data(), mix.data(), static_cast<int>(mix.size()), total_volume);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * mix.size());
+}
+
+BENCHMARK(BM_Limit)->Arg(100)->Arg(400);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,146 @@
+#include <cmath>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "system.h"
+#include "audio_sinc_resampler.h"
+
+#if defined(HAVE_LIBSPEEXDSP)
+#include <speex/speex_resampler.h>
+#endif
+#if defined(HAVE_LIBSAMPLERATE)
+#include <samplerate.h>
+#endif
+
+// All backends process the same stereo input: 1 second at 22050 Hz
+constexpr int input_rate = 22050;
+constexpr int channels = 2;
+constexpr int block_frames = 256;
+
+static const std::vector<float>& make_input() {
+	static std::vector<float> data = []() {
+		std::vector<float> d(input_rate * channels);
+		for (int i = 0; i < input_rate; ++i) {
+			d[i * 2] = 0.4f * std::sin(2.0f * 3.14159265f * 440.0f * i / input_rate);
+			d[i * 2 + 1] = 0.4f * std::sin(2.0f * 3.14159265f * 3000.0f * i / input_rate);
+		}
+		return d;
+	}();
+	return data;
+}
+
+/**
+ * Resamples the input with the built-in resampler in blocks like the audio callback.
+ * Arguments: quality, output rate, pitch change every block (0/1)
+ */
+static void BM_SincResampler(benchmark::State& state) {
+	const auto quality = static_cast<AudioSincResampler::Quality>(state.range(0));
+	const double ratio = static_cast<double>(input_rate) / state.range(1);
+	const bool vary_pitch = state.range(2) != 0;
+	const auto& input = make_input();
+	std::vector<float> out(block_frames * channels);
+
+	int64_t frames = 0;
+	for (auto _: state) {
+		AudioSincResampler r(channels, quality);
+		r.SetRatio(ratio);
+
+		int pos = 0;
+		int block = 0;
+		for (;;) {
+			if (vary_pitch) {
+				r.SetRatio(ratio * ((++block & 1) ? 1.02 : 0.98));
+			}
+			int n = r.Read(out.data(), block_frames);
+			frames += n;
+			if (n > 0) {
+				continue;
+			}
+			if (pos >= input_rate) {
+				break;
+			}
+			r.Write(&input[pos * channels], block_frames);
+			pos += block_frames;
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(frames);
+}
+
+BENCHMARK(BM_SincResampler)
+	->Args({0, 44100, 0})->Args({1, 44100, 0})->Args({2, 44100, 0})
+	->Args({0, 11025, 0})->Args({1, 11025, 0})->Args({2, 11025, 0})
+	->Args({1, 44100, 1});
+
+#if defined(HAVE_LIBSPEEXDSP)
+/** Arguments: speexdsp quality, output rate, pitch change every block (0/1) */
+static void BM_Speexdsp(benchmark::State& state) {
+	const int quality = state.range(0);
+	const spx_uint32_t output_rate = state.range(1);
+	const bool vary_pitch = state.range(2) != 0;
+	const auto& input = make_input();
+	std::vector<float> out(block_frames * 4 * channels);
+
+	int64_t frames = 0;
+	for (auto _: state) {
+		int err = 0;
+		auto* r = speex_resampler_init(channels, input_rate, output_rate, quality, &err);
+		speex_resampler_skip_zeros(r);
+
+		int block = 0;
+		for (int pos = 0; pos < input_rate; pos += block_frames) {
+			if (vary_pitch) {
+				spx_uint32_t num = (++block & 1) ? input_rate * 102 : input_rate * 98;
+				speex_resampler_set_rate_frac(r, num, output_rate * 100, input_rate, output_rate);
+			}
+			spx_uint32_t in_len = block_frames;
+			spx_uint32_t out_len = block_frames * 4;
+			speex_resampler_process_interleaved_float(r, &input[pos * channels], &in_len, out.data(), &out_len);
+			frames += out_len;
+		}
+		speex_resampler_destroy(r);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(frames);
+}
+
+BENCHMARK(BM_Speexdsp)
+	->Args({0, 44100, 0})->Args({3, 44100, 0})->Args({5, 44100, 0})
+	->Args({0, 11025, 0})->Args({3, 11025, 0})->Args({5, 11025, 0})
+	->Args({3, 44100, 1});
+#endif
+
+#if defined(HAVE_LIBSAMPLERATE)
+/** Arguments: libsamplerate converter, output rate */
+static void BM_Samplerate(benchmark::State& state) {
+	const int converter = state.range(0);
+	const double src_ratio = static_cast<double>(state.range(1)) / input_rate;
+	const auto& input = make_input();
+	std::vector<float> out(block_frames * 4 * channels);
+
+	int64_t frames = 0;
+	for (auto _: state) {
+		int err = 0;
+		auto* r = src_new(converter, channels, &err);
+
+		for (int pos = 0; pos < input_rate; pos += block_frames) {
+			SRC_DATA data = {};
+			data.data_in = &input[pos * channels];
+			data.input_frames = block_frames;
+			data.data_out = out.data();
+			data.output_frames = block_frames * 4;
+			data.src_ratio = src_ratio;
+			src_process(r, &data);
+			frames += data.output_frames_gen;
+		}
+		src_delete(r);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(frames);
+}
+
+BENCHMARK(BM_Samplerate)
+	->Args({SRC_SINC_FASTEST, 44100})->Args({SRC_SINC_MEDIUM_QUALITY, 44100})->Args({SRC_SINC_BEST_QUALITY, 44100})
+	->Args({SRC_SINC_FASTEST, 11025})->Args({SRC_SINC_MEDIUM_QUALITY, 11025})->Args({SRC_SINC_BEST_QUALITY, 11025});
+#endif
+
+BENCHMARK_MAIN();
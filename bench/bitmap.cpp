@@ -4,6 +4,7 @@
 #include <bitmap.h>
 #include <pixel_format.h>
 #include <transform.h>
+#include <bitmap_blit.h>
 
 constexpr auto opacity_100 = Opacity::Opaque();
 constexpr auto opacity_0 = Opacity(0);
@@ -264,6 +265,26 @@ static void BM_HueChangeBlit(benchmark::State& state) {
 
 BENCHMARK(BM_HueChangeBlit);
 
+static void BM_HueChangeBlitBattler(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	auto dest = Bitmap::Create(320, 240);
+	auto src = Bitmap::Create(320, 240);
+	// Paletted graphic with 256 colors
+	for (int y = 0; y < 240; y += 16) {
+		for (int x = 0; x < 320; x += 20) {
+			int c = x / 20 + y;
+			src->FillRect(Rect(x, y, 20, 16), Color(c, 255 - c, (c * 7) & 0xFF, 255));
+		}
+	}
+	auto rect = src->GetRect();
+	double hue = 120.0;
+	for (auto _: state) {
+		dest->HueChangeBlit(0, 0, *src, rect, hue);
+	}
+}
+
+BENCHMARK(BM_HueChangeBlitBattler);
+
 static void BM_ToneBlit(benchmark::State& state) {
 	Bitmap::SetFormat(format);
 	auto dest = Bitmap::Create(320, 240);
@@ -376,6 +397,100 @@ BENCHMARK(BM_EffectsBlit);
 
 
 
+// Comparison of pixman and the BitmapBlit kernels.
+// Arg 0 uses pixman, Arg 1 the kernels.
+
+static BitmapRef CreateAlphaBitmap(int w, int h) {
+	auto bm = Bitmap::Create(w, h);
+	bm->Fill(Color(255, 128, 64, 128));
+	return bm;
+}
+
+static void BM_KernelBlit(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	BitmapBlit::SetEnabled(state.range(0));
+	auto dest = Bitmap::Create(320, 240);
+	auto src = CreateAlphaBitmap(320, 240);
+	auto rect = src->GetRect();
+	for (auto _: state) {
+		dest->Blit(0, 0, *src, rect, opacity_100);
+	}
+	BitmapBlit::SetEnabled(true);
+}
+
+BENCHMARK(BM_KernelBlit)->Arg(0)->Arg(1);
+
+static void BM_KernelBlitOpacity(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	BitmapBlit::SetEnabled(state.range(0));
+	auto dest = Bitmap::Create(320, 240);
+	auto src = CreateAlphaBitmap(320, 240);
+	auto rect = src->GetRect();
+	for (auto _: state) {
+		dest->Blit(0, 0, *src, rect, opacity_50);
+	}
+	BitmapBlit::SetEnabled(true);
+}
+
+BENCHMARK(BM_KernelBlitOpacity)->Arg(0)->Arg(1);
+
+static void BM_KernelBlitFast(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	BitmapBlit::SetEnabled(state.range(0));
+	auto dest = Bitmap::Create(320, 240);
+	auto src = CreateAlphaBitmap(320, 240);
+	auto rect = src->GetRect();
+	for (auto _: state) {
+		dest->BlitFast(0, 0, *src, rect, opacity_100);
+	}
+	BitmapBlit::SetEnabled(true);
+}
+
+BENCHMARK(BM_KernelBlitFast)->Arg(0)->Arg(1);
+
+static void BM_KernelFlipBlit(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	BitmapBlit::SetEnabled(state.range(0));
+	auto dest = Bitmap::Create(320, 240);
+	auto src = CreateAlphaBitmap(320, 240);
+	auto rect = src->GetRect();
+	for (auto _: state) {
+		dest->FlipBlit(0, 0, *src, rect, true, true, opacity_50);
+	}
+	BitmapBlit::SetEnabled(true);
+}
+
+BENCHMARK(BM_KernelFlipBlit)->Arg(0)->Arg(1);
+
+static void BM_KernelBlendBlit(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	BitmapBlit::SetEnabled(state.range(0));
+	auto dest = Bitmap::Create(320, 240);
+	auto src = CreateAlphaBitmap(320, 240);
+	auto rect = src->GetRect();
+	auto color = Color(255, 255, 255, 128);
+	for (auto _: state) {
+		dest->BlendBlit(0, 0, *src, rect, color, opacity_100);
+	}
+	BitmapBlit::SetEnabled(true);
+}
+
+BENCHMARK(BM_KernelBlendBlit)->Arg(0)->Arg(1);
+
+static void BM_KernelEffectsBlit(benchmark::State& state) {
+	Bitmap::SetFormat(format);
+	BitmapBlit::SetEnabled(state.range(0));
+	auto dest = Bitmap::Create(320, 240);
+	auto src = CreateAlphaBitmap(320, 240);
+	auto rect = src->GetRect();
+	for (auto _: state) {
+		dest->EffectsBlit(0, 0, 0, 0, *src, rect, opacity_50, 1.0, 1.0, 0.0, 0, 0.0);
+	}
+	BitmapBlit::SetEnabled(true);
+}
+
+BENCHMARK(BM_KernelEffectsBlit)->Arg(0)->Arg(1);
+
 BENCHMARK_MAIN();
 
 
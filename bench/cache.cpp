@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+#include <bitmap.h>
+#include <cache.h>
+#include <color.h>
+#include <pixel_format.h>
+#include <rect.h>
+#include <tone.h>
+
+// Battlers flashing and screen tone fades applied to charsets:
+// The tone changes every call.
+static void BM_SpriteEffectToneFade(benchmark::State& state) {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	auto charset = Bitmap::Create(288, 256);
+	int frame = 0;
+	for (auto _: state) {
+		int v = frame++ % 256;
+		auto bm = Cache::SpriteEffect(charset, Rect(24, 32, 24, 32), false, false, Tone(v, 128, 255 - v, 128), Color());
+		benchmark::DoNotOptimize(bm);
+	}
+	auto stats = Cache::GetSpriteEffectStats();
+	state.counters["entries"] = stats.entries;
+	state.counters["hit_rate"] = stats.hits / static_cast<double>(stats.hits + stats.misses);
+	Cache::Clear();
+}
+
+BENCHMARK(BM_SpriteEffectToneFade);
+
+// Many sprites cycling through the same few flash colors
+static void BM_SpriteEffectFlashCycle(benchmark::State& state) {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	auto charset = Bitmap::Create(288, 256);
+	int frame = 0;
+	for (auto _: state) {
+		int sprite = frame % 96;
+		int alpha = (frame / 96 % 16) * 16;
+		++frame;
+		auto rect = Rect((sprite % 12) * 24, (sprite / 12) * 32, 24, 32);
+		auto bm = Cache::SpriteEffect(charset, rect, false, false, Tone(), Color(255, 255, 255, alpha));
+		benchmark::DoNotOptimize(bm);
+	}
+	auto stats = Cache::GetSpriteEffectStats();
+	state.counters["entries"] = stats.entries;
+	state.counters["hit_rate"] = stats.hits / static_cast<double>(stats.hits + stats.misses);
+	Cache::Clear();
+}
+
+BENCHMARK(BM_SpriteEffectFlashCycle);
+
+BENCHMARK_MAIN();
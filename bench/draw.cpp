@@ -6,6 +6,8 @@
 #include <graphics.h>
 #include <drawable_list.h>
 #include <drawable_mgr.h>
+#include <bitmap_blit.h>
+#include <pixel_format.h>
 #include <iostream>
 
 constexpr int num_sprites = 5000;
@@ -45,4 +47,26 @@ static void BM_DrawSortLocality(benchmark::State& state) {
 
 BENCHMARK(BM_DrawSortLocality);
 
+// Blits a screen full of 24x32 character frames, like a busy map.
+// Arg 0 uses pixman, Arg 1 the BitmapBlit kernels.
+static void BM_DrawCharsets(benchmark::State& state) {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	BitmapBlit::SetEnabled(state.range(0));
+
+	auto screen = Bitmap::Create(320, 240);
+	auto charset = Bitmap::Create(288, 256);
+	charset->Fill(Color(255, 128, 64, 128));
+
+	for (auto _: state) {
+		for (int y = -16; y < 240; y += 16) {
+			for (int x = -12; x < 320; x += 12) {
+				screen->Blit(x, y, *charset, Rect(24, 32, 24, 32), Opacity::Opaque());
+			}
+		}
+	}
+	BitmapBlit::SetEnabled(true);
+}
+
+BENCHMARK(BM_DrawCharsets)->Arg(0)->Arg(1);
+
 BENCHMARK_MAIN();
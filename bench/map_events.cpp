@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+#include "game_actors.h"
+#include "game_event.h"
+#include "game_map.h"
+#include "game_party.h"
+#include "game_pictures.h"
+#include "game_player.h"
+#include "game_screen.h"
+#include "game_switches.h"
+#include "game_system.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "map_data.h"
+#include "rand.h"
+#include <lcf/data.h>
+
+// 100x100 map with 1000 randomly walking events
+static void SetupMap() {
+	lcf::Data::data = {};
+
+	lcf::rpg::Chipset chipset;
+	chipset.passable_data_lower.resize(162, 0xF);
+	chipset.passable_data_upper.resize(144, 0xF);
+	lcf::Data::chipsets.push_back(chipset);
+	lcf::Data::terrains.push_back({});
+
+	auto& treemap = lcf::Data::treemap;
+	treemap.maps.push_back(lcf::rpg::MapInfo());
+	treemap.maps.back().type = lcf::rpg::TreeMap::MapType_root;
+	treemap.maps.push_back(lcf::rpg::MapInfo());
+	treemap.maps.back().ID = 1;
+	treemap.maps.back().type = lcf::rpg::TreeMap::MapType_map;
+
+	Main_Data::game_actors = std::make_unique<Game_Actors>();
+	Main_Data::game_party = std::make_unique<Game_Party>();
+	Game_Map::Init();
+	Main_Data::game_system = std::make_unique<Game_System>();
+	Main_Data::game_switches = std::make_unique<Game_Switches>();
+	Main_Data::game_variables = std::make_unique<Game_Variables>(Game_Variables::min_2k3, Game_Variables::max_2k3);
+	Main_Data::game_pictures = std::make_unique<Game_Pictures>();
+	Main_Data::game_screen = std::make_unique<Game_Screen>();
+	Main_Data::game_player = std::make_unique<Game_Player>();
+	Main_Data::game_player->SetMapId(1);
+
+	const int size = 100;
+	auto map = std::make_unique<lcf::rpg::Map>();
+	map->width = size;
+	map->height = size;
+	map->lower_layer.resize(size * size, BLOCK_E);
+	map->upper_layer.resize(size * size, BLOCK_F);
+
+	for (int i = 0; i < 1000; ++i) {
+		map->events.push_back({});
+		auto& ev = map->events.back();
+		ev.ID = i + 1;
+		ev.x = (i * 7) % size;
+		ev.y = (i * 13) % size;
+		ev.pages.resize(1);
+		ev.pages[0].ID = 1;
+		ev.pages[0].character_name = "Chara1";
+		ev.pages[0].move_type = lcf::rpg::EventPage::MoveType_random;
+		ev.pages[0].move_frequency = 8;
+		ev.pages[0].move_speed = 3;
+	}
+
+	Game_Map::Setup(std::move(map));
+	Game_Map::Refresh();
+}
+
+static void BM_UpdateMapEvents(benchmark::State& state) {
+	SetupMap();
+	Rand::SeedRandomNumberGenerator(1);
+	Game_Map::SetEventSchedulingEnabled(state.range(0) != 0);
+
+	for (auto _: state) {
+		Game_Map::UpdateProcessedFlags(false);
+		MapUpdateAsyncContext actx;
+		Game_Map::UpdateMapEvents(actx);
+	}
+
+	Game_Map::SetEventSchedulingEnabled(true);
+	Game_Map::Quit();
+}
+
+// Arg 0: Update every event, Arg 1: Batched walking events
+BENCHMARK(BM_UpdateMapEvents)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
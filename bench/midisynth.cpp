@@ -0,0 +1,90 @@
+#include <cstdint>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "system.h"
+
+#ifdef WANT_FMMIDI
+#include "decoder_fmmidi.h"
+
+constexpr int rate = 44100;
+
+static FmMidiDecoder& get_decoder() {
+	static FmMidiDecoder decoder;
+	return decoder;
+}
+
+/**
+ * One voice rendered sample by sample or in blocks of the audio callback.
+ * Arguments: program, block rendering (0/1)
+ */
+static void BM_Voice(benchmark::State& state) {
+	midisynth::FMPARAMETER params;
+	get_decoder().note_factory->get_program(state.range(0), params);
+	const bool block = state.range(1) != 0;
+	std::vector<int> out(1024);
+
+	for (auto _: state) {
+		midisynth::fm_sound_generator gen(params, 60, 1.0f);
+		gen.set_rate(rate);
+		gen.set_vibrato(0.3f, 5.0f);
+		for (int i = 0; i < rate / 1024; ++i) {
+			if (block) {
+				gen.render(out.data(), out.size());
+			} else {
+				for (auto& v: out) {
+					v = gen.get_next();
+				}
+			}
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * (rate / 1024) * 1024);
+}
+
+BENCHMARK(BM_Voice)->Args({0, 0})->Args({0, 1})->Args({48, 0})->Args({48, 1})->Args({80, 0})->Args({80, 1});
+
+/**
+ * Plays 10 seconds of a generated song with a fixed number of new notes per
+ * callback on all channels, "realtime" is the rendered audio time per second.
+ * Arguments: notes per callback, voice limit (0: unlimited), render threads
+ */
+static void BM_Song(benchmark::State& state) {
+	const int notes_per_block = state.range(0);
+	const int frames = 512;
+	const int blocks = rate * 10 / frames;
+	std::vector<int_least16_t> out(frames * 2);
+
+	for (auto _: state) {
+		midisynth::synthesizer synth(get_decoder().note_factory.get());
+		synth.set_max_notes(state.range(1));
+		synth.set_render_threads(state.range(2));
+
+		uint32_t seed = 1;
+		auto rnd = [&]() {
+			seed = seed * 1103515245 + 12345;
+			return static_cast<int>((seed >> 16) & 0x7FFF);
+		};
+		for (int ch = 0; ch < 16; ++ch) {
+			synth.program_change(ch, rnd() % 128);
+		}
+		synth.control_change(1, 1, 80);
+
+		for (int b = 0; b < blocks; ++b) {
+			for (int e = 0; e < notes_per_block; ++e) {
+				synth.note_on(rnd() % 16, 36 + rnd() % 48, 40 + rnd() % 80);
+				synth.note_off(rnd() % 16, 36 + rnd() % 48, 64);
+			}
+			synth.synthesize(out.data(), frames, rate);
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.counters["realtime"] = benchmark::Counter(state.iterations() * 10.0, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_Song)
+	->Args({1, 0, 1})->Args({3, 0, 1})->Args({3, 64, 1})
+	->Args({3, 0, 2})->Args({3, 0, 4})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include "pathfinder.h"
+#include "game_actors.h"
+#include "game_map.h"
+#include "game_party.h"
+#include "game_pictures.h"
+#include "game_player.h"
+#include "game_screen.h"
+#include "game_switches.h"
+#include "game_system.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "map_data.h"
+#include <lcf/data.h>
+
+// Looping map with vertical walls every 8 tiles, the gaps alternate
+// between the top and the bottom so the path has to zigzag.
+static void SetupMap(int size) {
+	lcf::Data::data = {};
+
+	lcf::rpg::Chipset chipset;
+	chipset.passable_data_lower.resize(162, 0xF);
+	chipset.passable_data_upper.resize(144, 0xF);
+	chipset.passable_data_upper[1] = 0;
+	lcf::Data::chipsets.push_back(chipset);
+	lcf::Data::terrains.push_back({});
+
+	auto& treemap = lcf::Data::treemap;
+	treemap.maps.push_back(lcf::rpg::MapInfo());
+	treemap.maps.back().type = lcf::rpg::TreeMap::MapType_root;
+	treemap.maps.push_back(lcf::rpg::MapInfo());
+	treemap.maps.back().ID = 1;
+	treemap.maps.back().type = lcf::rpg::TreeMap::MapType_map;
+
+	Main_Data::game_actors = std::make_unique<Game_Actors>();
+	Main_Data::game_party = std::make_unique<Game_Party>();
+	Game_Map::Init();
+	Main_Data::game_system = std::make_unique<Game_System>();
+	Main_Data::game_switches = std::make_unique<Game_Switches>();
+	Main_Data::game_variables = std::make_unique<Game_Variables>(Game_Variables::min_2k3, Game_Variables::max_2k3);
+	Main_Data::game_pictures = std::make_unique<Game_Pictures>();
+	Main_Data::game_screen = std::make_unique<Game_Screen>();
+	Main_Data::game_player = std::make_unique<Game_Player>();
+	Main_Data::game_player->SetMapId(1);
+
+	auto map = std::make_unique<lcf::rpg::Map>();
+	map->width = size;
+	map->height = size;
+	map->scroll_type = lcf::rpg::Map::ScrollType_both;
+	map->lower_layer.resize(size * size, BLOCK_E);
+	map->upper_layer.resize(size * size, BLOCK_F);
+
+	for (int x = 4; x < size; x += 8) {
+		const int gap = (x / 8) % 2 ? 0 : size - 1;
+		for (int y = 0; y < size; ++y) {
+			if (y != gap) {
+				map->upper_layer[x + y * size] = BLOCK_F + 1;
+			}
+		}
+	}
+
+	Game_Map::Setup(std::move(map));
+}
+
+static void BM_PathfinderSearch(benchmark::State& state, bool cached) {
+	const int size = static_cast<int>(state.range(0));
+	SetupMap(size);
+	Pathfinder::ClearCache();
+
+	auto& player = *Main_Data::game_player;
+	player.SetX(0);
+	player.SetY(size / 2);
+
+	Pathfinder::Params params;
+	params.search_limit = size * size;
+
+	std::vector<int> directions;
+	for (auto _: state) {
+		if (!cached) {
+			Pathfinder::ClearCache();
+		}
+		bool reached = Pathfinder::FindPath(player, size / 2 + 2, size / 2, params, directions);
+		benchmark::DoNotOptimize(reached);
+	}
+	state.counters["steps"] = directions.size();
+	state.counters["expanded"] = Pathfinder::GetStats().expanded;
+
+	Game_Map::Quit();
+}
+
+static void BM_PathfinderUncached(benchmark::State& state) {
+	BM_PathfinderSearch(state, false);
+}
+
+BENCHMARK(BM_PathfinderUncached)->Arg(64)->Arg(256)->Arg(500);
+
+static void BM_PathfinderCached(benchmark::State& state) {
+	BM_PathfinderSearch(state, true);
+}
+
+BENCHMARK(BM_PathfinderCached)->Arg(64)->Arg(256)->Arg(500);
+
+BENCHMARK_MAIN();
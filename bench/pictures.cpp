@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include "game_pictures.h"
+#include "player.h"
+
+constexpr int num_pictures = 2000;
+
+static void MovePictures(Game_Pictures& pictures, int first_id, int stride, int num, int frame) {
+	for (int i = 0; i < num; ++i) {
+		Game_Pictures::MoveParams params;
+		params.position_x = (frame * 7 + i * 13) % 320;
+		params.position_y = (frame * 11 + i * 17) % 240;
+		params.duration = -60;
+		pictures.Move(first_id + i * stride, params);
+	}
+}
+
+static void ShowPictures(Game_Pictures& pictures, int first_id, int stride, int num) {
+	for (int i = 0; i < num; ++i) {
+		Game_Pictures::ShowParams params;
+		params.position_x = (i * 13) % 320;
+		params.position_y = (i * 17) % 240;
+		pictures.Show(first_id + i * stride, params);
+	}
+}
+
+// 2000 pictures which are moving all the time
+static void BM_UpdateMovingPictures(benchmark::State& state) {
+	Player::game_config.engine = Player::EngineRpg2k3 | Player::EngineMajorUpdated | Player::EngineEnglish;
+	Game_Pictures pictures;
+	ShowPictures(pictures, 1, 1, num_pictures);
+
+	int frame = 0;
+	for (auto _: state) {
+		if (frame % 60 == 0) {
+			MovePictures(pictures, 1, 1, num_pictures, frame);
+		}
+		pictures.Update(false);
+		++frame;
+	}
+}
+
+BENCHMARK(BM_UpdateMovingPictures);
+
+// Maniac style UI: 2000 static pictures and 50 moving pictures with IDs up to 10000
+static void BM_UpdateSparsePictures(benchmark::State& state) {
+	Player::game_config.engine = Player::EngineRpg2k3 | Player::EngineMajorUpdated | Player::EngineEnglish;
+	Game_Pictures pictures;
+	ShowPictures(pictures, 1, 5, num_pictures);
+	ShowPictures(pictures, 3, 200, 50);
+
+	int frame = 0;
+	for (auto _: state) {
+		if (frame % 60 == 0) {
+			MovePictures(pictures, 3, 200, 50, frame);
+		}
+		pictures.Update(false);
+		++frame;
+	}
+}
+
+BENCHMARK(BM_UpdateSparsePictures);
+
+BENCHMARK_MAIN();
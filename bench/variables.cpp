@@ -106,6 +106,30 @@ static void BM_VariableModRange(benchmark::State& state) {
 
 BENCHMARK(BM_VariableModRange);
 
+static void BM_VariableBitOrRange(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.BitOrRange(1, max_vars, val); });
+}
+
+BENCHMARK(BM_VariableBitOrRange);
+
+static void BM_VariableBitXorRange(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.BitXorRange(1, max_vars, val); });
+}
+
+BENCHMARK(BM_VariableBitXorRange);
+
+static void BM_VariableBitShiftLeftRange(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.BitShiftLeftRange(1, max_vars, val % 32); });
+}
+
+BENCHMARK(BM_VariableBitShiftLeftRange);
+
+static void BM_VariableAddRangeSaturate(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto) { v.AddRange(1, max_vars, Game_Variables::max_2k3); });
+}
+
+BENCHMARK(BM_VariableAddRangeSaturate);
+
 static void BM_VariableSetRangeVariable(benchmark::State& state) {
 	BM_VariableOp(state, [](auto& v, auto, auto val) { v.SetRangeVariable(1, max_vars, val); });
 }
@@ -124,4 +148,48 @@ static void BM_VariableSetRangeRandom(benchmark::State& state) {
 
 BENCHMARK(BM_VariableSetRangeRandom);
 
+template <typename F>
+static void BM_VariableArrayOp(benchmark::State& state, F&& op) {
+	constexpr int n = max_vars / 2;
+	auto v = make();
+	v.EnumerateRange(1, max_vars, 1);
+	for (auto _: state) {
+		op(v, 1, n, n + 1);
+	}
+}
+
+static void BM_VariableSetArray(benchmark::State& state) {
+	BM_VariableArrayOp(state, [](auto& v, auto a, auto last_a, auto b) { v.SetArray(a, last_a, b); });
+}
+
+BENCHMARK(BM_VariableSetArray);
+
+static void BM_VariableAddArray(benchmark::State& state) {
+	BM_VariableArrayOp(state, [](auto& v, auto a, auto last_a, auto b) { v.AddArray(a, last_a, b); });
+}
+
+BENCHMARK(BM_VariableAddArray);
+
+static void BM_VariableSubArray(benchmark::State& state) {
+	BM_VariableArrayOp(state, [](auto& v, auto a, auto last_a, auto b) { v.SubArray(a, last_a, b); });
+}
+
+BENCHMARK(BM_VariableSubArray);
+
+static void BM_VariableBitXorArray(benchmark::State& state) {
+	BM_VariableArrayOp(state, [](auto& v, auto a, auto last_a, auto b) { v.BitXorArray(a, last_a, b); });
+}
+
+BENCHMARK(BM_VariableBitXorArray);
+
+static void BM_VariableTakeChangedRange(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) {
+		int first, last;
+		v.AddRange(1, max_vars, val);
+		benchmark::DoNotOptimize(v.TakeChangedRange(first, last));
+	});
+}
+
+BENCHMARK(BM_VariableTakeChangedRange);
+
 BENCHMARK_MAIN();
@@ -65,7 +65,7 @@ EmptyAudio::EmptyAudio(const Game_ConfigAudio& cfg) : AudioInterface(cfg) {
 }
 
 AudioInterface::AudioInterface(const Game_ConfigAudio& cfg) : cfg(cfg) {
-
+	AudioSeCache::SetMemoryLimit(static_cast<size_t>(cfg.se_cache_size.Get()) * 1024 * 1024);
 }
 
 Game_ConfigAudio AudioInterface::GetConfig() const {
@@ -84,6 +84,7 @@ Game_ConfigAudio AudioInterface::GetConfig() const {
 #endif
 #ifndef WANT_FMMIDI
 	acfg.fmmidi_midi.SetOptionVisible(false);
+	acfg.fmmidi_threads.SetOptionVisible(false);
 #endif
 
 	vGetConfig(acfg);
@@ -106,6 +107,14 @@ void AudioInterface::SE_SetGlobalVolume(int volume) {
 	cfg.sound_volume.Set(volume);
 }
 
+int AudioInterface::BGM_GetCrossfade() const {
+	return cfg.bgm_crossfade.Get();
+}
+
+void AudioInterface::BGM_SetCrossfade(int crossfade) {
+	cfg.bgm_crossfade.Set(crossfade);
+}
+
 bool AudioInterface::GetFluidsynthEnabled() const {
 	return cfg.fluidsynth_midi.Get();
 }
@@ -138,3 +147,7 @@ void AudioInterface::SetFluidsynthSoundfont(StringView sf) {
 	cfg.soundfont.Set(ToString(sf));
 	MidiDecoder::ChangeFluidsynthSoundfont(sf);
 }
+
+int AudioInterface::GetFmMidiThreads() const {
+	return cfg.fmmidi_threads.Get();
+}
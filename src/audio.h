@@ -143,6 +143,9 @@ struct AudioInterface {
 	int SE_GetGlobalVolume() const;
 	void SE_SetGlobalVolume(int volume);
 
+	int BGM_GetCrossfade() const;
+	void BGM_SetCrossfade(int crossfade);
+
 	bool GetFluidsynthEnabled() const;
 	void SetFluidsynthEnabled(bool enable);
 
@@ -155,6 +158,8 @@ struct AudioInterface {
 	std::string GetFluidsynthSoundfont() const;
 	void SetFluidsynthSoundfont(StringView sf);
 
+	int GetFmMidiThreads() const;
+
 protected:
 	Game_ConfigAudio cfg;
 };
@@ -24,8 +24,6 @@
 
 using namespace std::chrono_literals;
 
-constexpr int AudioDecoderMidi::midi_default_tempo;
-
 constexpr int bytes_per_sample = sizeof(int16_t) * 2;
 
 // ~1.5 ms of MIDI message resolution
@@ -145,8 +143,6 @@ bool AudioDecoderMidi::Open(Filesystem_Stream::InputStream stream) {
 	}
 
 	seq->rewind();
-	tempo.clear();
-	tempo.emplace_back(this, midi_default_tempo);
 	mtime = seq->get_start_skipping_silence();
 
 	if (!mididec->SupportsMidiMessages()) {
@@ -155,7 +151,7 @@ bool AudioDecoderMidi::Open(Filesystem_Stream::InputStream stream) {
 			return false;
 		}
 
-		mididec->Seek(tempo.back().GetSamples(mtime), std::ios_base::beg);
+		mididec->Seek(GetSamples(mtime), std::ios_base::beg);
 	}
 
 	return true;
@@ -217,24 +213,35 @@ void AudioDecoderMidi::SetFade(int end, std::chrono::milliseconds duration) {
 }
 
 bool AudioDecoderMidi::Seek(std::streamoff offset, std::ios_base::seekdir origin) {
-	assert(!tempo.empty());
-
 	if (offset == 0 && origin == std::ios_base::beg) {
 		mtime = seq->rewind_to_loop()->time;
-		reset_tempos_after_loop();
 
 		// When the loop points to the end of the track keep it alive to match
 		// RPG_RT behaviour.
 		loops_to_end = mtime >= seq->get_total_time();
 
 		if (!mididec->SupportsMidiMessages()) {
-			mididec->Seek(tempo.back().GetSamples(loops_to_end ? seq->get_total_time() : mtime), origin);
+			mididec->Seek(GetSamples(loops_to_end ? seq->get_total_time() : mtime), origin);
 		}
 
 		return true;
 	}
 
-	return false;
+	if (origin == std::ios_base::cur) {
+		offset += GetTicks();
+	} else if (origin != std::ios_base::beg) {
+		return false;
+	}
+
+	mtime = seq->get_time(static_cast<int>(std::max<std::streamoff>(offset, 0)));
+	seq->set_time(mtime, this);
+	loops_to_end = false;
+
+	if (!mididec->SupportsMidiMessages()) {
+		mididec->Seek(GetSamples(mtime), std::ios_base::beg);
+	}
+
+	return true;
 }
 
 bool AudioDecoderMidi::IsFinished() const {
@@ -288,7 +295,6 @@ void AudioDecoderMidi::UpdateMidi(std::chrono::microseconds delta) {
 
 	if (IsFinished() && looping) {
 		mtime = seq->rewind_to_loop()->time;
-		reset_tempos_after_loop();
 		loop_count += 1;
 	}
 }
@@ -315,9 +321,11 @@ bool AudioDecoderMidi::SetPitch(int pitch) {
 }
 
 int AudioDecoderMidi::GetTicks() const {
-	assert(!tempo.empty());
+	return seq->get_ticks(mtime);
+}
 
-	return tempo.back().GetTicks(mtime);
+int AudioDecoderMidi::GetSamples(std::chrono::microseconds time) const {
+	return static_cast<int>(time.count() * frequency / 1'000'000);
 }
 
 void AudioDecoderMidi::Reset() {
@@ -404,15 +412,12 @@ void AudioDecoderMidi::sysex_message(int, const void* data, std::size_t size) {
 	mididec->SendSysExMessage(reinterpret_cast<const uint8_t*>(data), size);
 }
 
-void AudioDecoderMidi::meta_event(int event, const void* data, std::size_t size) {
+void AudioDecoderMidi::meta_event(int event, const void*, std::size_t) {
 	// Meta events are never sent over MIDI ports.
-	assert(!tempo.empty());
-	const auto* d = reinterpret_cast<const uint8_t*>(data);
-	if (size == 3 && event == 0x51) {
-		uint32_t new_tempo = (static_cast<uint32_t>(static_cast<unsigned char>(d[0])) << 16)
-			| (static_cast<unsigned char>(d[1]) << 8)
-			| static_cast<unsigned char>(d[2]);
-		tempo.emplace_back(this, new_tempo, &tempo.back());
+	// Tempo changes are handled by the index of the sequencer.
+	if (event == META_EVENT_ALL_NOTE_OFF) {
+		// Seeking, the notes of the old position must stop
+		SendMessageToAllChannels(midimsg_all_sound_off(0));
 	}
 }
 
@@ -444,41 +449,3 @@ void AudioDecoderMidi::reset() {
 		mididec->SendMidiMessage(midi_msg);
 	}
 }
-
-void AudioDecoderMidi::reset_tempos_after_loop() {
-	if (mtime > 0us) {
-		// Throw away all tempo data after the loop point
-		auto rit = std::find_if(tempo.rbegin(), tempo.rend(), [&](auto& t) { return t.mtime <= mtime; });
-		auto it = rit.base();
-		if (it != tempo.end()) {
-			tempo.erase(it, tempo.end());
-		}
-	} else {
-		tempo.clear();
-		tempo.emplace_back(this, midi_default_tempo);
-	}
-}
-
-AudioDecoderMidi::MidiTempoData::MidiTempoData(const AudioDecoderMidi* midi, uint32_t cur_tempo, const MidiTempoData* prev)
-	: tempo(cur_tempo) {
-	ticks_per_us = (float)midi->seq->get_division() / tempo;
-	samples_per_tick = midi->frequency * 1 / (ticks_per_us * 1000000);
-	mtime = midi->mtime;
-	if (prev) {
-		std::chrono::microseconds delta = mtime - prev->mtime;
-		int ticks_since_last = static_cast<int>(ticks_per_us * delta.count());
-		ticks = prev->ticks + ticks_since_last;
-		samples = prev->samples + ticks_since_last * samples_per_tick;
-	}
-}
-
-int AudioDecoderMidi::MidiTempoData::GetTicks(std::chrono::microseconds mtime_cur) const {
-	std::chrono::microseconds delta = mtime_cur - mtime;
-	return ticks + static_cast<int>(ticks_per_us * delta.count());
-}
-
-int AudioDecoderMidi::MidiTempoData::GetSamples(std::chrono::microseconds mtime_cur) const {
-	std::chrono::microseconds delta = mtime_cur - mtime;
-	int ticks_since_last = static_cast<int>(ticks_per_us * delta.count());
-	return samples + static_cast<int>(ticks_since_last * samples_per_tick);
-}
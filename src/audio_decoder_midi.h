@@ -77,6 +77,9 @@ public:
 
 	/**
 	 * Seeks in the midi stream. The value of offset is in Midi ticks.
+	 * Seeking to the beginning restarts at the loop point (CC111).
+	 * Other positions restore the controller state of that position from
+	 * the index of the sequencer without replaying the notes.
 	 *
 	 * @param offset Offset to seek to
 	 * @param origin Position to seek from
@@ -159,8 +162,6 @@ public:
 	std::vector<uint8_t> file_buffer;
 	size_t file_buffer_pos = 0;
 private:
-	static constexpr int midi_default_tempo = 500000;
-
 	int FillBuffer(uint8_t* buffer, int length) override;
 
 	void SendMessageToAllChannels(uint32_t midi_msg);
@@ -170,7 +171,9 @@ private:
 	void sysex_message(int, const void* data, std::size_t size) override;
 	void meta_event(int, const void*, std::size_t) override;
 	void reset() override;
-	void reset_tempos_after_loop();
+
+	/** @return samples of the non-message decoder at the time */
+	int GetSamples(std::chrono::microseconds time) const;
 
 	std::chrono::microseconds mtime = std::chrono::microseconds(0);
 	float pitch = 1.0f;
@@ -189,27 +192,9 @@ private:
 
 	std::array<uint8_t, 16> channel_volumes;
 
-	struct MidiTempoData {
-		MidiTempoData(const AudioDecoderMidi* midi, uint32_t cur_tempo, const MidiTempoData* prev = nullptr);
-
-		uint32_t tempo = midi_default_tempo;
-		double ticks_per_us;
-		std::chrono::microseconds mtime = std::chrono::microseconds(0);
-		int ticks = 0;
-		int samples_per_tick = 0;
-		int samples = 0;
-
-		int GetTicks(std::chrono::microseconds cur_mtime) const;
-		int GetSamples(std::chrono::microseconds cur_mtime) const;
-	};
-
 	std::unique_ptr<midisequencer::sequencer> seq;
 
 	std::unique_ptr<MidiDecoder> mididec;
-
-	// Contains one entry per tempo change (latest on top)
-	// When looping all entries after the loop point are dropped
-	std::vector<MidiTempoData> tempo;
 };
 
 #endif
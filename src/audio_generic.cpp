@@ -17,12 +17,77 @@
 
 #include "system.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <cassert>
 #include <memory>
+#include <new>
 #include "audio_generic.h"
+#include "audio_mixer.h"
 #include "output.h"
 
+// PLAYER_AUDIO_ALLOC_TRIPWIRE counts the heap allocations and frees of the audio callback.
+// thread_local is only reliable on the platforms with std::thread.
+#if defined(AUDIO_ALLOC_TRIPWIRE) && !(defined(__GNUC__) && defined(USE_AUDIO_WORKER_THREAD))
+#  undef AUDIO_ALLOC_TRIPWIRE
+#endif
+
+namespace {
+#ifdef AUDIO_ALLOC_TRIPWIRE
+	thread_local bool tripwire_armed = false;
+	std::atomic<unsigned> tripwire_allocations{0};
+	/** Count which is logged next, doubles every time */
+	unsigned tripwire_report = 1;
+#endif
+
+	/** Arms or disarms the allocation tripwire for the current thread */
+	class TripwireScope {
+	public:
+#ifdef AUDIO_ALLOC_TRIPWIRE
+		explicit TripwireScope(bool armed) : previous(tripwire_armed) {
+			tripwire_armed = armed;
+		}
+		~TripwireScope() {
+			tripwire_armed = previous;
+		}
+	private:
+		bool previous;
+#else
+		explicit TripwireScope(bool) {}
+#endif
+	};
+}
+
+#ifdef AUDIO_ALLOC_TRIPWIRE
+// Weak, programs which replace operator new themselves (benchmarks, tests) keep theirs
+__attribute__((weak)) void* operator new(std::size_t size) {
+	if (tripwire_armed) {
+		++tripwire_allocations;
+	}
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+#ifdef __cpp_exceptions
+	throw std::bad_alloc();
+#else
+	std::abort();
+#endif
+}
+
+__attribute__((weak)) void operator delete(void* p) noexcept {
+	if (p && tripwire_armed) {
+		++tripwire_allocations;
+	}
+	std::free(p);
+}
+
+__attribute__((weak)) void operator delete(void* p, std::size_t) noexcept {
+	operator delete(p);
+}
+#endif
+
 GenericAudio::GenericAudio(const Game_ConfigAudio& cfg) : AudioInterface(cfg) {
 	int i = 0;
 	for (auto& BGM_Channel : BGM_Channels) {
@@ -36,7 +101,6 @@ GenericAudio::GenericAudio(const Game_ConfigAudio& cfg) : AudioInterface(cfg) {
 		SE_Channel.decoder.reset();
 		SE_Channel.instance = this;
 	}
-	BGM_PlayedOnceIndicator = false;
 	midi_thread.reset();
 
 	// Initialize to some arbitrary (low-quality) format to prevent crashes
@@ -44,131 +108,192 @@ GenericAudio::GenericAudio(const Game_ConfigAudio& cfg) : AudioInterface(cfg) {
 	SetFormat(12345, AudioDecoder::Format::S8, 1);
 }
 
+GenericAudio::~GenericAudio() {
+#ifdef USE_AUDIO_WORKER_THREAD
+	if (bgm_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(bgm_mutex);
+			bgm_thread_stop = true;
+		}
+		bgm_cv.notify_one();
+		bgm_thread.join();
+	}
+#endif
+}
+
 void GenericAudio::BGM_Play(Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein) {
 	if (!stream) {
 		Output::Warning("Couldn't play BGM {}: File not readable", stream.GetName());
 		return;
 	}
 
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.stopped = true; //Stop all running background music
-		if (!BGM_Channel.IsUsed()) {
-			// If there is an unused bgm channel
-			LockMutex();
-			BGM_PlayedOnceIndicator = false;
-			UnlockMutex();
-			PlayOnChannel(BGM_Channel, std::move(stream), volume, pitch, fadein);
-			return;
+	auto load = std::make_unique<BgmLoad>();
+	load->name = ToString(stream.GetName());
+	load->stream = std::move(stream);
+	load->volume = volume;
+	load->pitch = pitch;
+	load->fadein = fadein;
+	// The worker thread only opens the decoder
+	CreateBgmDecoder(*load);
+
+	if (cfg.bgm_crossfade.Get() <= 0) {
+		// Stop all running background music, otherwise it plays until the new one starts
+		StopBgm();
+	} else {
+		// The previous BGM does not report its state anymore
+		++bgm_serial;
+	}
+
+	bgm_pending = {};
+	bgm_pending.active = true;
+
+#ifdef USE_AUDIO_WORKER_THREAD
+	{
+		std::lock_guard<std::mutex> lock(bgm_mutex);
+		load->generation = ++bgm_generation;
+		// A request which was not picked up yet is replaced
+		bgm_request = std::move(load);
+		bgm_ready.reset();
+		if (!bgm_thread.joinable()) {
+			bgm_thread = std::thread(&GenericAudio::BgmThreadFunction, this);
 		}
 	}
+	bgm_cv.notify_one();
+#else
+	LoadBgm(*load);
+	StartBgm(std::move(load));
+#endif
 }
 
 void GenericAudio::BGM_Pause() {
-	for (auto& BGM_Channel : BGM_Channels) {
-		if (BGM_Channel.IsUsed()) {
-			BGM_Channel.SetPaused(true);
-		}
+	bgm_pending.paused = true;
+	if (midi_out_used) {
+		midi_thread->GetMidiOut().Pause();
 	}
+	Command cmd;
+	cmd.type = Command::Type::BgmPause;
+	SendCommand(std::move(cmd));
 }
 
 void GenericAudio::BGM_Resume() {
-	for (auto& BGM_Channel : BGM_Channels) {
-		if (BGM_Channel.IsUsed()) {
-			BGM_Channel.SetPaused(false);
-		}
+	bgm_pending.paused = false;
+	if (midi_out_used) {
+		midi_thread->GetMidiOut().Resume();
 	}
+	Command cmd;
+	cmd.type = Command::Type::BgmResume;
+	SendCommand(std::move(cmd));
 }
 
 void GenericAudio::BGM_Stop() {
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.Stop();
+#ifdef USE_AUDIO_WORKER_THREAD
+	{
+		std::lock_guard<std::mutex> lock(bgm_mutex);
+		++bgm_generation;
+		bgm_request.reset();
+		bgm_ready.reset();
 	}
-	BGM_PlayedOnceIndicator = false;
-	UnlockMutex();
+#endif
+	bgm_pending = {};
+
+	StopBgm();
 }
 
 bool GenericAudio::BGM_PlayedOnce() const {
-	if (BGM_PlayedOnceIndicator) {
-		return BGM_PlayedOnceIndicator;
+	if (bgm_pending.active) {
+		return false;
 	}
 
-	LockMutex();
-	// Audio Decoders set this in the Decoding thread
-	for (auto& BGM_Channel : BGM_Channels) {
-		if (BGM_Channel.midi_out_used) {
-			BGM_PlayedOnceIndicator = midi_thread->GetMidiOut().GetLoopCount() > 0;
-		}
+	if (midi_out_used) {
+		return midi_thread->GetMidiOut().GetLoopCount() > 0;
 	}
-	UnlockMutex();
 
-	return BGM_PlayedOnceIndicator;
+	// Set by Decode, a state of the previous BGM is ignored
+	unsigned status = bgm_status.load(std::memory_order_acquire);
+	return IsCurrentBgmStatus(status) && (status & BgmStatusPlayedOnce);
 }
 
 bool GenericAudio::BGM_IsPlaying() const {
-	for (auto& BGM_Channel : BGM_Channels) {
-		if (!BGM_Channel.stopped) {
-			return true;
-		};
+	if (bgm_pending.active) {
+		return true;
+	}
+
+	if (!bgm_playing || midi_out_used) {
+		return bgm_playing;
 	}
-	return false;
+
+	// Decode stops faulty channels, until it started the BGM it counts as playing
+	unsigned status = bgm_status.load(std::memory_order_acquire);
+	return !IsCurrentBgmStatus(status) || (status & BgmStatusPlaying);
 }
 
 int GenericAudio::BGM_GetTicks() const {
-	unsigned ticks = 0;
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		int cur_ticks = BGM_Channel.GetTicks();
-		if (cur_ticks >= 0) {
-			ticks = static_cast<unsigned>(cur_ticks);
-		}
+	if (bgm_pending.active) {
+		return 0;
 	}
-	UnlockMutex();
-	return ticks;
+
+	if (midi_out_used) {
+		return midi_thread->GetMidiOut().GetTicks();
+	}
+
+	unsigned status = bgm_status.load(std::memory_order_acquire);
+	if (!IsCurrentBgmStatus(status)) {
+		return 0;
+	}
+	return bgm_ticks.load(std::memory_order_relaxed);
 }
 
 void GenericAudio::BGM_Fade(int fade) {
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.SetFade(fade);
+	if (bgm_pending.active) {
+		bgm_pending.fade = fade;
 	}
-	UnlockMutex();
+
+	if (midi_out_used) {
+		midi_thread->GetMidiOut().SetFade(0, std::chrono::milliseconds(fade));
+	}
+	Command cmd;
+	cmd.type = Command::Type::BgmFade;
+	cmd.value = fade;
+	SendCommand(std::move(cmd));
 }
 
 void GenericAudio::BGM_Volume(int volume) {
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.SetVolume(volume);
+	if (bgm_pending.active) {
+		bgm_pending.volume = volume;
 	}
-	UnlockMutex();
+
+	if (midi_out_used) {
+		midi_thread->GetMidiOut().SetVolume(volume);
+	}
+	Command cmd;
+	cmd.type = Command::Type::BgmVolume;
+	cmd.value = volume;
+	SendCommand(std::move(cmd));
 }
 
 void GenericAudio::BGM_Pitch(int pitch) {
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.SetPitch(pitch);
+	if (bgm_pending.active) {
+		bgm_pending.pitch = pitch;
 	}
-	UnlockMutex();
+
+	if (midi_out_used) {
+		midi_thread->GetMidiOut().SetPitch(pitch);
+	}
+	Command cmd;
+	cmd.type = Command::Type::BgmPitch;
+	cmd.value = pitch;
+	SendCommand(std::move(cmd));
 }
 
 std::string GenericAudio::BGM_GetType() const {
-	std::string type;
-
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		if (BGM_Channel.IsUsed()) {
-			if (BGM_Channel.midi_out_used) {
-				type = "midi";
-				break;
-			} else {
-				type = BGM_Channel.decoder->GetType();
-				break;
-			}
-		}
+	if (bgm_pending.active) {
+		return {};
 	}
-	UnlockMutex();
 
-	return type;
+	if (midi_out_used) {
+		return "midi";
+	}
+	return bgm_type;
 }
 
 void GenericAudio::SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pitch) {
@@ -177,25 +302,107 @@ void GenericAudio::SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pit
 		return;
 	}
 
-	for (auto& SE_Channel : SE_Channels) {
-		if (!SE_Channel.decoder) {
-			//If there is an unused se channel
-			PlayOnChannel(SE_Channel, std::move(se), volume, pitch);
-			return;
+	// Prepared here, the audio callback only starts playing it
+	auto decoder = se->CreateSeDecoder(pitch);
+	decoder->SetPitch(pitch);
+	decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
+	decoder->SetVolume(volume);
+
+	Command cmd;
+	cmd.type = Command::Type::SePlay;
+	cmd.decoder = std::move(decoder);
+	cmd.name = ToString(se->GetName());
+	SendCommand(std::move(cmd));
+}
+
+void GenericAudio::SE_Stop() {
+	Command cmd;
+	cmd.type = Command::Type::SeStop;
+	SendCommand(std::move(cmd));
+}
+
+void GenericAudio::Update() {
+	// The audio is handled by the Decode function called through a thread
+
+	// Decoders which finished are freed here, never in the audio callback
+	Garbage item;
+	while (garbage.Pop(item)) {
+		if (item.se_dropped) {
+			// FIXME Not displaying as warning because multiple games exhaust free channels available, see #1356
+			Output::Debug("Couldn't play {} SE. No free channel available", item.name);
 		}
+		item = {};
 	}
-	// FIXME Not displaying as warning because multiple games exhaust free channels available, see #1356
-	Output::Debug("Couldn't play {} SE. No free channel available", se->GetName());
+
+#ifdef AUDIO_ALLOC_TRIPWIRE
+	unsigned allocations = tripwire_allocations;
+	if (allocations >= tripwire_report) {
+		Output::Debug("Audio: {} heap allocations or frees in the audio callback", allocations);
+		tripwire_report = allocations * 2;
+	}
+#endif
+
+#ifdef USE_AUDIO_WORKER_THREAD
+	std::unique_ptr<BgmLoad> load;
+	{
+		std::lock_guard<std::mutex> lock(bgm_mutex);
+		load = std::move(bgm_ready);
+	}
+	if (load) {
+		StartBgm(std::move(load));
+	}
+#endif
 }
 
-void GenericAudio::SE_Stop() {
-	for (auto& SE_Channel : SE_Channels) {
-		SE_Channel.stopped = true; //Stop all running sound effects
+GenericAudio::StallStatistics GenericAudio::GetStallStatistics() const {
+	return stall_statistics;
+}
+
+void GenericAudio::SendCommand(Command&& cmd) {
+	++stall_statistics.commands;
+	if (commands.Push(std::move(cmd))) {
+		return;
+	}
+
+	// The audio thread is behind or not running: Empty the queue here
+	auto start = std::chrono::steady_clock::now();
+	LockMutex();
+	ProcessCommands();
+	PublishBgmState();
+	bool pushed = commands.Push(std::move(cmd));
+	UnlockMutex();
+	assert(pushed);
+	(void)pushed;
+
+	auto stall = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	++stall_statistics.stalls;
+	stall_statistics.total_stall += stall;
+	stall_statistics.max_stall = std::max(stall_statistics.max_stall, stall);
+	if (stall_statistics.stalls >= stall_report) {
+		Output::Debug("Audio: The command queue was full {} times, longest wait {} us",
+			stall_statistics.stalls, stall_statistics.max_stall.count());
+		stall_report = stall_statistics.stalls * 2;
 	}
 }
 
-void GenericAudio::Update() {
-	// no-op, handled by the Decode function called through a thread
+void GenericAudio::StopBgm() {
+	++bgm_serial;
+	StopMidiOut();
+	bgm_playing = false;
+	bgm_type.clear();
+
+	Command cmd;
+	cmd.type = Command::Type::BgmStop;
+	cmd.serial = bgm_serial;
+	SendCommand(std::move(cmd));
+}
+
+void GenericAudio::StopMidiOut() {
+	if (midi_out_used) {
+		midi_out_used = false;
+		midi_thread->GetMidiOut().Reset();
+		midi_thread->GetMidiOut().Pause();
+	}
 }
 
 GenericAudioMidiOut* GenericAudio::CreateAndGetMidiOut() {
@@ -215,79 +422,304 @@ void GenericAudio::SetFormat(int frequency, AudioDecoder::Format format, int cha
 	output_format.frequency = frequency;
 	output_format.format = format;
 	output_format.channels = channels;
+
+	AudioSeCache::SetOutputFrequency(frequency);
 }
 
-bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStream filestream, int volume, int pitch, int fadein) {
-	chan.paused = true; // Pause channel so the audio thread doesn't work on it
-	chan.stopped = false; // Unstop channel so the audio thread doesn't delete it
+void GenericAudio::CreateBgmDecoder(BgmLoad& load) const {
+	// Midiout is only used when Fluidsynth and WildMidi are not available
+	// Order is Fluidsynth, WildMidi, Native, FmMidi
+	if (load.native_midi && Audio().GetNativeMidiEnabled() && GenericAudioMidiOut::IsSupported(load.stream)) {
+		bool fluidsynth = Audio().GetFluidsynthEnabled() && MidiDecoder::CreateFluidsynth(true);
+		bool wildmidi = Audio().GetWildMidiEnabled() && MidiDecoder::CreateWildMidi(true);
+		if (!fluidsynth && !wildmidi) {
+			load.midi_out = true;
+			return;
+		}
+	}
 
-	if (!filestream) {
-		Output::Warning("BGM file not readable: {}", filestream.GetName());
-		return false;
+	load.decoder = AudioDecoder::Create(load.stream);
+	if (!load.decoder) {
+		load.error = "Format not supported";
 	}
+}
 
-	// Midiout is only supported on channel 0 because this is an exclusive resource
-	if (chan.id == 0 && GenericAudioMidiOut::IsSupported(filestream)) {
-		chan.decoder.reset();
+void GenericAudio::LoadBgm(BgmLoad& load) const {
+	if (!load.decoder) {
+		return;
+	}
 
-		// Order is Fluidsynth, WildMidi, Native, FmMidi
-		bool fluidsynth = Audio().GetFluidsynthEnabled() && MidiDecoder::CreateFluidsynth(true);
-		bool wildmidi = Audio().GetWildMidiEnabled() && MidiDecoder::CreateWildMidi(true);
+	auto& decoder = load.decoder;
+	if (!decoder->Open(std::move(load.stream))) {
+		load.error = "Format not supported";
+		decoder.reset();
+		return;
+	}
 
-		if (!fluidsynth && !wildmidi && Audio().GetNativeMidiEnabled()) {
-			CreateAndGetMidiOut();
-
-			if (midi_thread) {
-				midi_thread->LockMutex();
-				auto &midi_out = midi_thread->GetMidiOut();
-				if (midi_out.Open(std::move(filestream))) {
-					midi_out.SetPitch(pitch);
-					midi_out.SetVolume(0);
-					midi_out.SetFade(volume, std::chrono::milliseconds(fadein));
-					midi_out.SetLooping(true);
-					midi_out.Resume();
-					chan.paused = false;
-					chan.midi_out_used = true;
-					midi_thread->UnlockMutex();
-					return true;
-				}
-				midi_thread->UnlockMutex();
+	decoder->SetPitch(load.pitch);
+	decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
+	decoder->SetVolume(0);
+	decoder->SetFade(load.volume, std::chrono::milliseconds(load.fadein));
+	decoder->SetLooping(true);
+
+	// Decode 100 ms ahead, the first audio callbacks do not wait for the file then
+	int frequency;
+	AudioDecoder::Format format;
+	int channels;
+	decoder->GetFormat(frequency, format, channels);
+	int size = frequency / 10 * AudioDecoder::GetSamplesizeForFormat(format) * channels;
+	load.preroll.resize(size);
+	int read = decoder->Decode(load.preroll.data(), size);
+	load.preroll.resize(std::max(read, 0));
+}
+
+void GenericAudio::StartBgm(std::unique_ptr<BgmLoad> load) {
+	PendingBgm pending = bgm_pending;
+	bgm_pending = {};
+
+	// Native MIDI can't be prepared on the worker, it uses the MIDI thread
+	if (load->midi_out) {
+		CreateAndGetMidiOut();
+		if (!midi_thread) {
+			load->midi_out = false;
+			load->native_midi = false;
+			CreateBgmDecoder(*load);
+			LoadBgm(*load);
+		}
+	}
+
+	if (!load->error.empty()) {
+		Output::Warning("Couldn't play BGM {}. {}", load->name, load->error);
+	}
+
+	StopMidiOut();
+	bgm_type.clear();
+
+	// Midiout is played by the MIDI thread, the channels only fade out the previous BGM
+	if (load->midi_out) {
+		midi_thread->LockMutex();
+		auto& midi_out = midi_thread->GetMidiOut();
+		if (midi_out.Open(std::move(load->stream))) {
+			midi_out.SetPitch(pending.pitch >= 0 ? pending.pitch : load->pitch);
+			midi_out.SetVolume(0);
+			midi_out.SetFade(load->volume, std::chrono::milliseconds(load->fadein));
+			midi_out.SetLooping(true);
+			if (pending.volume >= 0) {
+				midi_out.SetVolume(pending.volume);
+			}
+			if (pending.fade >= 0) {
+				midi_out.SetFade(0, std::chrono::milliseconds(pending.fade));
 			}
+			if (!pending.paused) {
+				midi_out.Resume();
+			}
+			midi_out_used = true;
+		} else {
+			Output::Warning("Couldn't play BGM {}. Format not supported", load->name);
 		}
+		midi_thread->UnlockMutex();
+	} else if (load->decoder) {
+		auto& decoder = load->decoder;
+		if (pending.pitch >= 0) {
+			decoder->SetPitch(pending.pitch);
+		}
+		if (pending.volume >= 0) {
+			decoder->SetVolume(pending.volume);
+		}
+		if (pending.fade >= 0) {
+			decoder->SetFade(0, std::chrono::milliseconds(pending.fade));
+		}
+		bgm_type = decoder->GetType();
 	}
 
-	if (midi_thread) {
-		midi_thread->GetMidiOut().Reset();
+	bgm_playing = midi_out_used || load->decoder;
+
+	Command cmd;
+	cmd.type = Command::Type::BgmStart;
+	cmd.value = bgm_playing ? cfg.bgm_crossfade.Get() : 0;
+	cmd.serial = bgm_serial;
+	cmd.paused = pending.paused;
+	cmd.decoder = std::move(load->decoder);
+	cmd.preroll = std::move(load->preroll);
+	SendCommand(std::move(cmd));
+}
+
+#ifdef USE_AUDIO_WORKER_THREAD
+void GenericAudio::BgmThreadFunction() {
+	std::unique_lock<std::mutex> lock(bgm_mutex);
+	for (;;) {
+		bgm_cv.wait(lock, [this]() { return bgm_thread_stop || bgm_request; });
+		if (bgm_thread_stop) {
+			return;
+		}
+
+		auto load = std::move(bgm_request);
+		lock.unlock();
+		LoadBgm(*load);
+		lock.lock();
+
+		// Discarded when BGM_Play or BGM_Stop were called meanwhile
+		if (load->generation == bgm_generation) {
+			bgm_ready = std::move(load);
+		} else {
+			lock.unlock();
+			load.reset();
+			lock.lock();
+		}
 	}
+}
+#endif
 
-	chan.decoder = AudioDecoder::Create(filestream);
-	chan.midi_out_used = false;
-	if (chan.decoder && chan.decoder->Open(std::move(filestream))) {
-		chan.decoder->SetPitch(pitch);
-		chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
-		chan.decoder->SetVolume(0);
-		chan.decoder->SetFade(volume, std::chrono::milliseconds(fadein));
-		chan.decoder->SetLooping(true);
-		chan.paused = false; // Unpause channel -> Play it.
+void GenericAudio::Retire(Garbage&& item) {
+	if (!garbage.Push(std::move(item))) {
+		// Update did not run for a long time, freed here as a last resort
+		item = {};
+	}
+}
 
-		return true;
-	} else {
-		Output::Warning("Couldn't play BGM {}. Format not supported", filestream.GetName());
+void GenericAudio::RetireSe(SeChannel& chan) {
+	Garbage item;
+	item.decoder = std::move(chan.decoder);
+	item.name = std::move(chan.name);
+	Retire(std::move(item));
+}
+
+void GenericAudio::ProcessCommands() {
+	Command cmd;
+	while (commands.Pop(cmd)) {
+		ProcessCommand(cmd);
 	}
+}
+
+void GenericAudio::ProcessCommand(Command& cmd) {
+	switch (cmd.type) {
+		case Command::Type::None:
+			break;
+		case Command::Type::BgmStart: {
+			// Fade out the previous BGM on its channel. The channel of an older crossfade is reused.
+			for (auto& BGM_Channel : BGM_Channels) {
+				if (BGM_Channel.fading_out || !BGM_Channel.decoder) {
+					continue;
+				}
+				if (cmd.value > 0 && !BGM_Channel.paused) {
+					BGM_Channel.fading_out = true;
+					BGM_Channel.fade_out_time = std::chrono::milliseconds(cmd.value);
+					BGM_Channel.decoder->SetFade(0, std::chrono::milliseconds(cmd.value));
+				} else {
+					BGM_Channel.Stop();
+				}
+			}
 
-	return false;
+			audio_bgm_serial = cmd.serial;
+			audio_bgm_played_once = false;
+			if (!cmd.decoder) {
+				break;
+			}
+
+			BgmChannel* chan = nullptr;
+			for (auto& BGM_Channel : BGM_Channels) {
+				if (!BGM_Channel.decoder) {
+					chan = &BGM_Channel;
+					break;
+				}
+			}
+			if (!chan) {
+				// Both channels fade out, the quieter one is replaced
+				chan = &BGM_Channels[0];
+				if (BGM_Channels[1].fade_out_time < chan->fade_out_time) {
+					chan = &BGM_Channels[1];
+				}
+			}
+			chan->Stop();
+			chan->stopped = false;
+			chan->paused = cmd.paused;
+			chan->decoder = std::move(cmd.decoder);
+			chan->preroll = std::move(cmd.preroll);
+			chan->preroll_pos = 0;
+			break;
+		}
+		case Command::Type::BgmStop:
+			for (auto& BGM_Channel : BGM_Channels) {
+				BGM_Channel.Stop();
+			}
+			audio_bgm_serial = cmd.serial;
+			audio_bgm_played_once = false;
+			break;
+		case Command::Type::BgmPause:
+		case Command::Type::BgmResume:
+			for (auto& BGM_Channel : BGM_Channels) {
+				if (BGM_Channel.decoder) {
+					BGM_Channel.paused = cmd.type == Command::Type::BgmPause;
+				}
+			}
+			break;
+		case Command::Type::BgmFade:
+		case Command::Type::BgmVolume:
+		case Command::Type::BgmPitch:
+			for (auto& BGM_Channel : BGM_Channels) {
+				if (!BGM_Channel.decoder || BGM_Channel.fading_out) {
+					continue;
+				}
+				if (cmd.type == Command::Type::BgmFade) {
+					BGM_Channel.decoder->SetFade(0, std::chrono::milliseconds(cmd.value));
+				} else if (cmd.type == Command::Type::BgmVolume) {
+					BGM_Channel.decoder->SetVolume(cmd.value);
+				} else {
+					BGM_Channel.decoder->SetPitch(cmd.value);
+				}
+			}
+			break;
+		case Command::Type::SePlay:
+			for (auto& SE_Channel : SE_Channels) {
+				if (!SE_Channel.decoder) {
+					//If there is an unused se channel
+					SE_Channel.decoder = std::move(cmd.decoder);
+					SE_Channel.name = std::move(cmd.name);
+					SE_Channel.paused = false;
+					SE_Channel.stopped = false;
+					break;
+				}
+			}
+			if (cmd.decoder) {
+				// Update reports it, the name is freed there too
+				Garbage item;
+				item.decoder = std::move(cmd.decoder);
+				item.name = std::move(cmd.name);
+				item.se_dropped = true;
+				Retire(std::move(item));
+			}
+			break;
+		case Command::Type::SeStop:
+			for (auto& SE_Channel : SE_Channels) {
+				SE_Channel.stopped = true; //Stop all running sound effects
+			}
+			break;
+	}
 }
 
-bool GenericAudio::PlayOnChannel(SeChannel& chan, std::unique_ptr<AudioSeCache> se, int volume, int pitch) {
-	chan.paused = true; // Pause channel so the audio thread doesn't work on it
-	chan.stopped = false; // Unstop channel so the audio thread doesn't delete it
+bool GenericAudio::IsCurrentBgmStatus(unsigned status) const {
+	return (status >> BgmStatusSerialShift) == (bgm_serial & (UINT_MAX >> BgmStatusSerialShift));
+}
 
-	chan.decoder = se->CreateSeDecoder();
-	chan.decoder->SetPitch(pitch);
-	chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
-	chan.decoder->SetVolume(volume);
-	chan.paused = false; // Unpause channel -> Play it.
-	return true;
+void GenericAudio::PublishBgmState() {
+	int ticks = 0;
+	bool playing = false;
+	for (auto& BGM_Channel : BGM_Channels) {
+		if (BGM_Channel.decoder && !BGM_Channel.fading_out) {
+			ticks = std::max(BGM_Channel.decoder->GetTicks(), 0);
+			playing = true;
+		}
+	}
+	bgm_ticks.store(ticks, std::memory_order_relaxed);
+
+	unsigned status = audio_bgm_serial << BgmStatusSerialShift;
+	if (playing) {
+		status |= BgmStatusPlaying;
+	}
+	if (audio_bgm_played_once) {
+		status |= BgmStatusPlayedOnce;
+	}
+	bgm_status.store(status, std::memory_order_release);
 }
 
 void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
@@ -297,17 +729,19 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 
 	assert(buffer_length > 0);
 
-	if (sample_buffer.size() != (size_t)buffer_length) {
-		sample_buffer.resize(buffer_length);
-	}
-	if (mixer_buffer.size() != (size_t)buffer_length) {
-		mixer_buffer.resize(buffer_length);
-	}
+	TripwireScope tripwire(true);
+
+	ProcessCommands();
+
 	scrap_buffer_size = samples_per_frame * output_format.channels * sizeof(uint32_t);
-	if (scrap_buffer.size() != scrap_buffer_size) {
-		scrap_buffer.resize(scrap_buffer_size);
+	if (sample_buffer.size() < (size_t)buffer_length || scrap_buffer.size() < scrap_buffer_size) {
+		// The buffers only grow, this is the warm-up and the only allowed allocation
+		TripwireScope warmup(false);
+		sample_buffer.resize(std::max<size_t>(sample_buffer.size(), buffer_length));
+		mixer_buffer.resize(sample_buffer.size());
+		scrap_buffer.resize(std::max<size_t>(scrap_buffer.size(), scrap_buffer_size));
 	}
-	std::fill(mixer_buffer.begin(), mixer_buffer.end(), '\0');
+	std::fill(mixer_buffer.begin(), mixer_buffer.begin() + buffer_length, 0.0f);
 
 	for (unsigned i = 0; i < nr_of_bgm_channels + nr_of_se_channels; i++) {
 		int read_bytes = 0;
@@ -327,9 +761,20 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 
 			if (currently_mixed_channel.decoder && !currently_mixed_channel.paused) {
 				if (currently_mixed_channel.stopped) {
-					currently_mixed_channel.decoder.reset();
+					currently_mixed_channel.Stop();
 				} else {
-					currently_mixed_channel.decoder->Update(std::chrono::microseconds(1000 * 1000 / 60));
+					const auto update_delta = std::chrono::microseconds(1000 * 1000 / 60);
+					currently_mixed_channel.decoder->Update(update_delta);
+
+					if (currently_mixed_channel.fading_out) {
+						// The crossfade is measured like the decoder fades
+						currently_mixed_channel.fade_out_time -= update_delta;
+						if (currently_mixed_channel.fade_out_time <= std::chrono::microseconds(0)) {
+							currently_mixed_channel.Stop();
+							continue;
+						}
+					}
+
 					volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
 					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
 					samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
@@ -340,16 +785,16 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 					unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
 					bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
 
-					read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
+					read_bytes = currently_mixed_channel.Read(scrap_buffer.data(), bytes_to_read);
 
 					if (read_bytes <= 0) {
 						// An error occured when reading - the channel is faulty - discard
-						currently_mixed_channel.decoder.reset();
+						currently_mixed_channel.Stop();
 						continue; // skip this loop run - there is nothing to mix
 					}
 
-					if (!currently_mixed_channel.stopped) {
-						BGM_PlayedOnceIndicator = currently_mixed_channel.decoder->GetLoopCount() > 0;
+					if (!currently_mixed_channel.fading_out && currently_mixed_channel.decoder->GetLoopCount() > 0) {
+						audio_bgm_played_once = true;
 					}
 
 					channel_used = true;
@@ -361,7 +806,7 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 
 			if (currently_mixed_channel.decoder && !currently_mixed_channel.paused) {
 				if (currently_mixed_channel.stopped) {
-					currently_mixed_channel.decoder.reset();
+					RetireSe(currently_mixed_channel);
 				} else {
 					volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
 					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
@@ -377,14 +822,14 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 
 					if (read_bytes <= 0) {
 						// An error occured when reading - the channel is faulty - discard
-						currently_mixed_channel.decoder.reset();
+						RetireSe(currently_mixed_channel);
 						continue; // skip this loop run - there is nothing to mix
 					}
 
 					// Now decide what to do when a channel has reached its end
 					if (currently_mixed_channel.decoder->IsFinished()) {
 						// SE are only played once so free the se if finished
-						currently_mixed_channel.decoder.reset();
+						RetireSe(currently_mixed_channel);
 					}
 
 					channel_used = true;
@@ -393,151 +838,53 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 		}
 
 		//--------------------------------------------------------------------------------------------------------------------//
-		// From here downwards the currently_mixed_channel decoder may already be freed - so don't use it below this comment. //
+		// From here downwards the currently_mixed_channel decoder may already be moved - so don't use it below this comment. //
 		//--------------------------------------------------------------------------------------------------------------------//
 
 		if (channel_used) {
-			for (unsigned ii = 0; ii < (unsigned)(read_bytes / (samplesize * channels)); ii++) {
-
-				float vall = volume;
-				float valr = vall;
-
-				// Convert to floating point
-				switch (sampleformat) {
-					case AudioDecoder::Format::S8:
-						vall *= (((int8_t *) scrap_buffer.data())[ii * channels] / 128.0);
-						valr *= (((int8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0);
-						break;
-					case AudioDecoder::Format::U8:
-						vall *= (((uint8_t *) scrap_buffer.data())[ii * channels] / 128.0 - 1.0);
-						valr *= (((uint8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S16:
-						vall *= (((int16_t *) scrap_buffer.data())[ii * channels] / 32768.0);
-						valr *= (((int16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0);
-						break;
-					case AudioDecoder::Format::U16:
-						vall *= (((uint16_t *) scrap_buffer.data())[ii * channels] / 32768.0 - 1.0);
-						valr *= (((uint16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S32:
-						vall *= (((int32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0);
-						valr *= (((int32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0);
-						break;
-					case AudioDecoder::Format::U32:
-						vall *= (((uint32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0 - 1.0);
-						valr *= (((uint32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0 - 1.0);
-						break;
-					case AudioDecoder::Format::F32:
-						vall *= (((float *) scrap_buffer.data())[ii * channels]);
-						valr *= (((float *) scrap_buffer.data())[ii * channels + 1]);
-						break;
-				}
-
-				if (!channel_active) {
-					// first channel
-					mixer_buffer[ii * output_format.channels] = vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] = valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
-					}
-				} else {
-					mixer_buffer[ii * output_format.channels] += vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] += valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
-					}
-				}
-
-			}
+			int frames = read_bytes / (samplesize * channels);
+			AudioMixer::Accumulate(mixer_buffer.data(), scrap_buffer.data(), sampleformat, channels, frames, volume);
 			channel_active = true;
 		}
 	}
 
 	if (channel_active) {
-		if (total_volume > 1.0) {
-			float threshold = 0.8;
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				float sample = mixer_buffer[i];
-				float sign = (sample < 0) ? -1.0 : 1.0;
-				sample /= sign;
-				//dynamic range compression
-				if (sample > threshold) {
-					sample_buffer[i] = sign * 32768.0 * (threshold + (1.0 - threshold) * (sample - threshold) / (total_volume - threshold));
-				} else {
-					sample_buffer[i] = sign * sample * 32768.0;
-				}
-			}
-		} else {
-			//No dynamic range compression necessary
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				sample_buffer[i] = mixer_buffer[i] * 32768.0;
-			}
-		}
-
+		AudioMixer::Limit(sample_buffer.data(), mixer_buffer.data(), samples_per_frame * 2, total_volume);
 		memcpy(output_buffer, sample_buffer.data(), buffer_length);
 	} else {
 		memset(output_buffer, '\0', buffer_length);
 	}
+
+	PublishBgmState();
 }
 
 void GenericAudio::BgmChannel::Stop() {
 	stopped = true;
-	if (midi_out_used) {
-		midi_out_used = false;
-		instance->midi_thread->GetMidiOut().Reset();
-		instance->midi_thread->GetMidiOut().Pause();
-	} else if (decoder) {
-		decoder.reset();
-	}
+	fading_out = false;
+	if (decoder || preroll.capacity() > 0) {
+		Garbage item;
+		item.decoder = std::move(decoder);
+		item.preroll = std::move(preroll);
+		instance->Retire(std::move(item));
+		preroll.clear();
+	}
+	preroll_pos = 0;
 }
 
-void GenericAudio::BgmChannel::SetPaused(bool newPaused) {
-	paused = newPaused;
-	if (midi_out_used) {
-		if (newPaused) {
-			instance->midi_thread->GetMidiOut().Pause();
-		} else {
-			instance->midi_thread->GetMidiOut().Resume();
+int GenericAudio::BgmChannel::Read(uint8_t* buffer, int size) {
+	int read = 0;
+	if (preroll_pos < preroll.size()) {
+		read = std::min(size, static_cast<int>(preroll.size() - preroll_pos));
+		memcpy(buffer, preroll.data() + preroll_pos, read);
+		preroll_pos += read;
+		if (read == size) {
+			return read;
 		}
 	}
-}
 
-int GenericAudio::BgmChannel::GetTicks() const {
-	if (midi_out_used) {
-		return instance->midi_thread->GetMidiOut().GetTicks();
-	} else if (decoder) {
-		return decoder->GetTicks();
+	int res = decoder->Decode(buffer + read, size - read);
+	if (res <= 0) {
+		return read > 0 ? read : res;
 	}
-	return -1;
-}
-
-void GenericAudio::BgmChannel::SetFade(int fade) {
-	if (midi_out_used) {
-		instance->midi_thread->GetMidiOut().SetFade(0, std::chrono::milliseconds(fade));
-	} else if (decoder) {
-		decoder->SetFade(0, std::chrono::milliseconds(fade));
-	}
-}
-
-void GenericAudio::BgmChannel::SetVolume(int volume) {
-	if (midi_out_used) {
-		instance->midi_thread->GetMidiOut().SetVolume(volume);
-	} else if (decoder) {
-		decoder->SetVolume(volume);
-	}
-}
-
-void GenericAudio::BgmChannel::SetPitch(int pitch) {
-	if (midi_out_used) {
-		instance->midi_thread->GetMidiOut().SetPitch(pitch);
-	} else if (decoder) {
-		decoder->SetPitch(pitch);
-	}
-}
-
-bool GenericAudio::BgmChannel::IsUsed() const {
-	return decoder || midi_out_used;
+	return read + res;
 }
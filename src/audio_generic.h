@@ -22,7 +22,17 @@
 #include "audio_secache.h"
 #include "audio_decoder_base.h"
 #include "audio_generic_midiout.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <string>
+#include <vector>
+#ifdef USE_AUDIO_WORKER_THREAD
+#  include <condition_variable>
+#  include <mutex>
+#  include <thread>
+#endif
 
 /**
  * A software implementation for handling EasyRPG Audio utilizing the
@@ -36,12 +46,28 @@
  * 3. Initialize the "output_format" (must match the format of the hardware)
  * 4. Implement LockMutex and UnlockMutex. Locking and Unlocking when
  *    calling Decode must be done manually.
- * 5. Implement update function (optional)
+ * 5. Call GenericAudio::Update when overriding the update function
+ *
+ * A new BGM is opened and decoded ahead on a worker thread (when the platform
+ * supports threads) and starts playing in the first Update afterwards. With
+ * the BGM crossfade option the previous BGM is faded out meanwhile on the
+ * second BGM channel.
+ *
+ * The BGM_* and SE_* functions do not lock the audio thread. They send
+ * commands through a lock-free queue which Decode processes before mixing,
+ * Decode publishes the BGM state through atomics. Only when the queue is
+ * full (the audio thread stalls or does not run) the commands are processed
+ * under the mutex, see GetStallStatistics.
+ *
+ * Decode does not allocate or free heap memory once its buffers reached the
+ * size of the audio callback: Decoders are prepared by the caller and
+ * finished decoders are handed back to Update to be freed. Debug builds
+ * log heap allocations of the callback.
  */
 class GenericAudio : public AudioInterface {
 public:
 	GenericAudio(const Game_ConfigAudio& cfg);
-	virtual ~GenericAudio() = default;
+	virtual ~GenericAudio();
 
 	void BGM_Play(Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein) override;
 	void BGM_Pause() override;
@@ -70,28 +96,44 @@ public:
 
 	void Decode(uint8_t* output_buffer, int buffer_length);
 
+	/** How often the game thread had to wait for the audio thread */
+	struct StallStatistics {
+		/** Commands sent to the audio thread */
+		unsigned commands = 0;
+		/** Commands which found the queue full and waited for the mutex */
+		unsigned stalls = 0;
+		std::chrono::microseconds total_stall = {};
+		std::chrono::microseconds max_stall = {};
+	};
+
+	/** @return wait statistics of the game thread since the start */
+	StallStatistics GetStallStatistics() const;
+
 private:
+	/** Channel state, only accessed by the audio thread (Decode) */
 	struct BgmChannel {
 		int id;
 		std::unique_ptr<AudioDecoderBase> decoder;
 		GenericAudio* instance = nullptr;
-		bool paused;
-		bool stopped;
-		bool midi_out_used = false;
+		bool paused = false;
+		bool stopped = true;
+		/** The previous BGM of a crossfade, is stopped after fade_out_time */
+		bool fading_out = false;
+		std::chrono::microseconds fade_out_time = {};
+		/** Samples decoded ahead by the loader, played before the decoder output */
+		std::vector<uint8_t> preroll;
+		size_t preroll_pos = 0;
+		/** Hands the decoder to the main thread and stops the channel */
 		void Stop();
-		void SetPaused(bool newPaused);
-		int GetTicks() const;
-		void SetFade(int fade);
-		void SetVolume(int volume);
-		void SetPitch(int pitch);
-		bool IsUsed() const;
+		int Read(uint8_t* buffer, int size);
 	};
 	struct SeChannel {
 		int id;
 		std::unique_ptr<AudioDecoderBase> decoder;
+		std::string name;
 		GenericAudio* instance = nullptr;
-		bool paused;
-		bool stopped;
+		bool paused = false;
+		bool stopped = true;
 	};
 	struct Format {
 		int frequency;
@@ -100,15 +142,111 @@ private:
 	};
 	Format output_format = {};
 
-	bool PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein);
-	bool PlayOnChannel(SeChannel& chan, std::unique_ptr<AudioSeCache> se, int volume, int pitch);
+	/** A BGM which is opened before it replaces the current BGM */
+	struct BgmLoad {
+		Filesystem_Stream::InputStream stream;
+		std::string name;
+		int volume = 0;
+		int pitch = 0;
+		int fadein = 0;
+		unsigned generation = 0;
+		/** The native MIDI output may be used */
+		bool native_midi = true;
+		/** The stream shall be played through the native MIDI output */
+		bool midi_out = false;
+		std::unique_ptr<AudioDecoderBase> decoder;
+		std::vector<uint8_t> preroll;
+		/** Logged by StartBgm when the BGM can't be played */
+		std::string error;
+	};
+	/** Changes of the BGM requested while it is loading, applied when it starts */
+	struct PendingBgm {
+		bool active = false;
+		bool paused = false;
+		int volume = -1;
+		int pitch = -1;
+		int fade = -1;
+	};
+
+	/** Sent from the game thread to Decode */
+	struct Command {
+		enum class Type {
+			None,
+			/** Replaces the BGM by decoder (or silence), value: crossfade in ms */
+			BgmStart,
+			BgmStop,
+			BgmPause,
+			BgmResume,
+			BgmFade,
+			BgmVolume,
+			BgmPitch,
+			SePlay,
+			SeStop
+		};
+		Type type = Type::None;
+		int value = 0;
+		/** BgmStart, BgmStop: BGM the published state belongs to */
+		unsigned serial = 0;
+		bool paused = false;
+		std::unique_ptr<AudioDecoderBase> decoder;
+		std::vector<uint8_t> preroll;
+		/** SePlay: name of the SE */
+		std::string name;
+	};
+	/** Sent from Decode to Update, freed on the game thread */
+	struct Garbage {
+		std::unique_ptr<AudioDecoderBase> decoder;
+		std::vector<uint8_t> preroll;
+		std::string name;
+		/** The SE was not played, all channels were in use */
+		bool se_dropped = false;
+	};
+
+	/**
+	 * Chooses between the native MIDI output and a decoder and creates the
+	 * decoder. Runs on the main thread, the MIDI decoders share global state.
+	 */
+	void CreateBgmDecoder(BgmLoad& load) const;
+	/**
+	 * Opens the decoder of the BGM and decodes the beginning.
+	 * Runs on the worker thread, only touches the load.
+	 */
+	void LoadBgm(BgmLoad& load) const;
+	/** Replaces the current BGM by the loaded one, runs on the main thread */
+	void StartBgm(std::unique_ptr<BgmLoad> load);
+#ifdef USE_AUDIO_WORKER_THREAD
+	void BgmThreadFunction();
+#endif
+
+	/** Sends a command to Decode, processes the queue under the mutex when it is full */
+	void SendCommand(Command&& cmd);
+	/** Stops the BGM on the game thread and in Decode */
+	void StopBgm();
+	/** Resets the native MIDI output when it plays the BGM */
+	void StopMidiOut();
+
+	/** Applies the queued commands, called by Decode */
+	void ProcessCommands();
+	void ProcessCommand(Command& cmd);
+	/** Publishes the BGM state for the game thread, called by Decode */
+	void PublishBgmState();
+
+	/**
+	 * @param status value of bgm_status
+	 * @return Whether Decode published it for the BGM the game thread started last
+	 */
+	bool IsCurrentBgmStatus(unsigned status) const;
+
+	/** Hands memory over to the main thread, called by the audio thread */
+	void Retire(Garbage&& item);
+	/** Hands the decoder of the SE channel to the main thread */
+	void RetireSe(SeChannel& chan);
 
 	static constexpr unsigned nr_of_se_channels = 31;
 	static constexpr unsigned nr_of_bgm_channels = 2;
 
 	BgmChannel BGM_Channels[nr_of_bgm_channels];
 	SeChannel SE_Channels[nr_of_se_channels];
-	mutable bool BGM_PlayedOnceIndicator;
 	bool Muted;
 
 	std::vector<int16_t> sample_buffer = {};
@@ -116,7 +254,47 @@ private:
 	unsigned scrap_buffer_size = 0;
 	std::vector<float> mixer_buffer = {};
 
+	SpscQueue<Command, 128> commands;
+	SpscQueue<Garbage, 128> garbage;
+
+	/** Serial of the BGM the audio thread plays and whether it looped */
+	unsigned audio_bgm_serial = 0;
+	bool audio_bgm_played_once = false;
+
+	/** Bits of bgm_status besides the serial */
+	enum BgmStatus : unsigned {
+		/** A channel of the current BGM has a decoder */
+		BgmStatusPlaying = 1,
+		BgmStatusPlayedOnce = 2,
+		BgmStatusSerialShift = 2
+	};
+
+	/** Published by Decode: serial and BgmStatus bits, written after bgm_ticks */
+	std::atomic<unsigned> bgm_status = {0};
+	std::atomic<int> bgm_ticks = {0};
+
+	/** State of the game thread */
+	unsigned bgm_serial = 0;
+	bool bgm_playing = false;
+	std::string bgm_type;
+	bool midi_out_used = false;
+	StallStatistics stall_statistics;
+	/** Stall count which is logged next, doubles every time */
+	unsigned stall_report = 1;
+
 	std::unique_ptr<GenericAudioMidiOut> midi_thread;
+
+	PendingBgm bgm_pending;
+#ifdef USE_AUDIO_WORKER_THREAD
+	std::mutex bgm_mutex;
+	std::condition_variable bgm_cv;
+	std::thread bgm_thread;
+	bool bgm_thread_stop = false;
+	/** Incremented by every BGM_Play and BGM_Stop, outdated loads are discarded */
+	unsigned bgm_generation = 0;
+	std::unique_ptr<BgmLoad> bgm_request;
+	std::unique_ptr<BgmLoad> bgm_ready;
+#endif
 };
 
 #endif
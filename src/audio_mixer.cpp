@@ -0,0 +1,285 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "audio_mixer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define EP_AUDIO_MIXER_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define EP_AUDIO_MIXER_NEON
+#  include <arm_neon.h>
+#endif
+
+#if defined(EP_AUDIO_MIXER_SSE2) || defined(EP_AUDIO_MIXER_NEON)
+#  define EP_AUDIO_MIXER_SIMD
+#endif
+
+using Format = AudioDecoderBase::Format;
+
+namespace {
+	/** Samples above this level are compressed when the mix is too loud */
+	constexpr float limiter_threshold = 0.8f;
+
+	constexpr float scale_8 = 1.0f / 128.0f;
+	constexpr float scale_16 = 1.0f / 32768.0f;
+	constexpr float scale_32 = 1.0f / 2147483648.0f;
+
+	template <typename T>
+	inline T Read(const void* src, int i) {
+		return static_cast<const T*>(src)[i];
+	}
+
+	/** Scalar conversion of one sample to float in [-1.0, 1.0) */
+	inline float SampleToFloat(const void* src, Format format, int i) {
+		switch (format) {
+			case Format::S8:
+				return Read<int8_t>(src, i) * scale_8;
+			case Format::U8:
+				return Read<uint8_t>(src, i) * scale_8 - 1.0f;
+			case Format::S16:
+				return Read<int16_t>(src, i) * scale_16;
+			case Format::U16:
+				return Read<uint16_t>(src, i) * scale_16 - 1.0f;
+			case Format::S32:
+				return Read<int32_t>(src, i) * scale_32;
+			case Format::U32:
+				return static_cast<float>(Read<uint32_t>(src, i) * static_cast<double>(scale_32) - 1.0);
+			case Format::F32:
+				return Read<float>(src, i);
+		}
+		return 0.0f;
+	}
+
+	void AccumulateScalar(float* mix, const void* src, Format format, int channels, int first, int frames, float volume) {
+		for (int i = first; i < frames; ++i) {
+			const float l = SampleToFloat(src, format, i * channels) * volume;
+			const float r = channels > 1 ? SampleToFloat(src, format, i * channels + 1) * volume : l;
+			mix[i * 2] += l;
+			mix[i * 2 + 1] += r;
+		}
+	}
+
+	inline int16_t LimitScalar(float sample, float knee, float slope) {
+		float level = std::fabs(sample);
+		if (level > knee) {
+			level = knee + (level - knee) * slope;
+		}
+		float v = std::copysign(level, sample) * 32768.0f;
+		v = std::min(std::max(v, -32768.0f), 32767.0f);
+		return static_cast<int16_t>(v);
+	}
+
+#ifdef EP_AUDIO_MIXER_SSE2
+	using Vec = __m128;
+
+	inline Vec VecSet(float v) { return _mm_set1_ps(v); }
+	inline Vec VecLoad(const float* p) { return _mm_loadu_ps(p); }
+	inline void VecStore(float* p, Vec v) { _mm_storeu_ps(p, v); }
+	inline Vec VecAdd(Vec a, Vec b) { return _mm_add_ps(a, b); }
+	inline Vec VecMul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+	inline Vec VecDupLow(Vec v) { return _mm_unpacklo_ps(v, v); }
+	inline Vec VecDupHigh(Vec v) { return _mm_unpackhi_ps(v, v); }
+
+	/** Loads 4 samples starting at i as float, without scaling */
+	template <Format F>
+	inline Vec VecLoadSamples(const void* src, int i);
+
+	template <>
+	inline Vec VecLoadSamples<Format::S16>(const void* src, int i) {
+		__m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(static_cast<const int16_t*>(src) + i));
+		return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+	}
+
+	template <>
+	inline Vec VecLoadSamples<Format::U16>(const void* src, int i) {
+		__m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(static_cast<const uint16_t*>(src) + i));
+		v = _mm_xor_si128(v, _mm_set1_epi16(static_cast<int16_t>(0x8000)));
+		return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+	}
+
+	template <>
+	inline Vec VecLoadSamples<Format::S32>(const void* src, int i) {
+		return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(static_cast<const int32_t*>(src) + i)));
+	}
+
+	template <>
+	inline Vec VecLoadSamples<Format::F32>(const void* src, int i) {
+		return _mm_loadu_ps(static_cast<const float*>(src) + i);
+	}
+
+	/** Limits 8 samples and stores them as 16 bit */
+	inline void VecLimit8(int16_t* dst, const float* mix, Vec knee, Vec slope) {
+		const __m128 sign_mask = _mm_set1_ps(-0.0f);
+		const __m128 scale = _mm_set1_ps(32768.0f);
+		const __m128 lo = _mm_set1_ps(-32768.0f);
+		const __m128 hi = _mm_set1_ps(32767.0f);
+
+		__m128i res[2];
+		for (int k = 0; k < 2; ++k) {
+			__m128 s = _mm_loadu_ps(mix + k * 4);
+			__m128 sign = _mm_and_ps(s, sign_mask);
+			__m128 level = _mm_andnot_ps(sign_mask, s);
+			__m128 compressed = _mm_add_ps(knee, _mm_mul_ps(_mm_sub_ps(level, knee), slope));
+			__m128 over = _mm_cmpgt_ps(level, knee);
+			level = _mm_or_ps(_mm_and_ps(over, compressed), _mm_andnot_ps(over, level));
+			__m128 v = _mm_mul_ps(_mm_or_ps(level, sign), scale);
+			v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+			res[k] = _mm_cvttps_epi32(v);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packs_epi32(res[0], res[1]));
+	}
+#elif defined(EP_AUDIO_MIXER_NEON)
+	using Vec = float32x4_t;
+
+	inline Vec VecSet(float v) { return vdupq_n_f32(v); }
+	inline Vec VecLoad(const float* p) { return vld1q_f32(p); }
+	inline void VecStore(float* p, Vec v) { vst1q_f32(p, v); }
+	inline Vec VecAdd(Vec a, Vec b) { return vaddq_f32(a, b); }
+	inline Vec VecMul(Vec a, Vec b) { return vmulq_f32(a, b); }
+	inline Vec VecDupLow(Vec v) { return vzipq_f32(v, v).val[0]; }
+	inline Vec VecDupHigh(Vec v) { return vzipq_f32(v, v).val[1]; }
+
+	template <Format F>
+	inline Vec VecLoadSamples(const void* src, int i);
+
+	template <>
+	inline Vec VecLoadSamples<Format::S16>(const void* src, int i) {
+		return vcvtq_f32_s32(vmovl_s16(vld1_s16(static_cast<const int16_t*>(src) + i)));
+	}
+
+	template <>
+	inline Vec VecLoadSamples<Format::U16>(const void* src, int i) {
+		uint16x4_t v = veor_u16(vld1_u16(static_cast<const uint16_t*>(src) + i), vdup_n_u16(0x8000));
+		return vcvtq_f32_s32(vmovl_s16(vreinterpret_s16_u16(v)));
+	}
+
+	template <>
+	inline Vec VecLoadSamples<Format::S32>(const void* src, int i) {
+		return vcvtq_f32_s32(vld1q_s32(static_cast<const int32_t*>(src) + i));
+	}
+
+	template <>
+	inline Vec VecLoadSamples<Format::F32>(const void* src, int i) {
+		return vld1q_f32(static_cast<const float*>(src) + i);
+	}
+
+	inline void VecLimit8(int16_t* dst, const float* mix, Vec knee, Vec slope) {
+		const uint32x4_t sign_mask = vdupq_n_u32(0x80000000u);
+		const float32x4_t scale = vdupq_n_f32(32768.0f);
+		const float32x4_t lo = vdupq_n_f32(-32768.0f);
+		const float32x4_t hi = vdupq_n_f32(32767.0f);
+
+		int32x4_t res[2];
+		for (int k = 0; k < 2; ++k) {
+			float32x4_t s = vld1q_f32(mix + k * 4);
+			float32x4_t level = vabsq_f32(s);
+			float32x4_t compressed = vaddq_f32(knee, vmulq_f32(vsubq_f32(level, knee), slope));
+			level = vbslq_f32(vcgtq_f32(level, knee), compressed, level);
+			float32x4_t v = vmulq_f32(vbslq_f32(sign_mask, s, level), scale);
+			v = vminq_f32(vmaxq_f32(v, lo), hi);
+			res[k] = vcvtq_s32_f32(v);
+		}
+		vst1q_s16(dst, vcombine_s16(vqmovn_s32(res[0]), vqmovn_s32(res[1])));
+	}
+#endif
+
+#ifdef EP_AUDIO_MIXER_SIMD
+	/** @return number of frames mixed, the rest is left to the scalar code */
+	template <Format F>
+	int AccumulateVec(float* mix, const void* src, int channels, int frames, float volume) {
+		const Vec vol = VecSet(volume);
+
+		if (channels == 2) {
+			const int count = frames * 2;
+			int i = 0;
+			for (; i + 4 <= count; i += 4) {
+				Vec v = VecMul(VecLoadSamples<F>(src, i), vol);
+				VecStore(mix + i, VecAdd(VecLoad(mix + i), v));
+			}
+			return i / 2;
+		}
+
+		// Mono, duplicate every sample into both channels
+		int i = 0;
+		for (; i + 4 <= frames; i += 4) {
+			Vec v = VecMul(VecLoadSamples<F>(src, i), vol);
+			float* out = mix + i * 2;
+			VecStore(out, VecAdd(VecLoad(out), VecDupLow(v)));
+			VecStore(out + 4, VecAdd(VecLoad(out + 4), VecDupHigh(v)));
+		}
+		return i;
+	}
+#endif
+}
+
+void AudioMixer::Accumulate(float* mix, const void* src, Format format, int channels, int frames, float volume) {
+	if (frames <= 0 || channels <= 0) {
+		return;
+	}
+
+	int done = 0;
+#ifdef EP_AUDIO_MIXER_SIMD
+	if (channels <= 2) {
+		switch (format) {
+			case Format::S16:
+				done = AccumulateVec<Format::S16>(mix, src, channels, frames, volume * scale_16);
+				break;
+			case Format::U16:
+				done = AccumulateVec<Format::U16>(mix, src, channels, frames, volume * scale_16);
+				break;
+			case Format::S32:
+				done = AccumulateVec<Format::S32>(mix, src, channels, frames, volume * scale_32);
+				break;
+			case Format::F32:
+				done = AccumulateVec<Format::F32>(mix, src, channels, frames, volume);
+				break;
+			default:
+				break;
+		}
+	}
+#endif
+
+	AccumulateScalar(mix, src, format, channels, done, frames, volume);
+}
+
+void AudioMixer::Limit(int16_t* dst, const float* mix, int count, float total_volume) {
+	float knee = std::numeric_limits<float>::max();
+	float slope = 1.0f;
+	if (total_volume > 1.0f) {
+		// Map the range above the threshold up to total_volume into the headroom
+		knee = limiter_threshold;
+		slope = (1.0f - limiter_threshold) / (total_volume - limiter_threshold);
+	}
+
+	int i = 0;
+#ifdef EP_AUDIO_MIXER_SIMD
+	const Vec knee_v = VecSet(knee);
+	const Vec slope_v = VecSet(slope);
+	for (; i + 8 <= count; i += 8) {
+		VecLimit8(dst + i, mix + i, knee_v, slope_v);
+	}
+#endif
+
+	for (; i < count; ++i) {
+		dst[i] = LimitScalar(mix[i], knee, slope);
+	}
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_AUDIO_MIXER_H
+#define EP_AUDIO_MIXER_H
+
+// Headers
+#include <cstdint>
+#include "audio_decoder_base.h"
+
+/**
+ * Sample mixing of the software audio output.
+ *
+ * The channels are accumulated into an interleaved stereo float buffer
+ * which is converted to 16 bit at the end. The common sample formats
+ * are converted with SSE2 or NEON when available.
+ */
+namespace AudioMixer {
+	/**
+	 * Converts decoded samples to float, scales them by the volume and adds
+	 * them to the mix. Mono samples are added to both channels, further
+	 * channels beyond stereo are ignored.
+	 *
+	 * @param mix interleaved stereo buffer of frames * 2 values
+	 * @param src decoded samples
+	 * @param format sample format of src
+	 * @param channels number of channels of src
+	 * @param frames number of frames to mix
+	 * @param volume volume factor, 1.0 is full volume
+	 */
+	void Accumulate(float* mix, const void* src, AudioDecoderBase::Format format, int channels, int frames, float volume);
+
+	/**
+	 * Converts the mix to signed 16 bit.
+	 * When the volume of all mixed channels exceeds 1.0 the samples above
+	 * the limiter threshold are compressed into the remaining headroom.
+	 * The result is clipped to the 16 bit range.
+	 *
+	 * @param dst output samples
+	 * @param mix mixed samples
+	 * @param count number of samples
+	 * @param total_volume sum of the volumes of the mixed channels
+	 */
+	void Limit(int16_t* dst, const float* mix, int count, float total_volume);
+}
+
+#endif
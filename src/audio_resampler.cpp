@@ -19,6 +19,7 @@
 
 #ifdef USE_AUDIO_RESAMPLER
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include "audio_resampler.h"
@@ -215,6 +216,18 @@ AudioResampler::AudioResampler(std::unique_ptr<AudioDecoderBase> wrapped, AudioR
 				sampling_quality = SRC_SINC_BEST_QUALITY;
 				break;
 		}
+	#else
+		switch (quality) {
+			case Quality::Low:
+				sampling_quality = static_cast<int>(AudioSincResampler::Quality::Low);
+				break;
+			case Quality::Medium:
+				sampling_quality = static_cast<int>(AudioSincResampler::Quality::Medium);
+				break;
+			case Quality::High:
+				sampling_quality = static_cast<int>(AudioSincResampler::Quality::High);
+				break;
+		}
 	#endif
 
 	finished = false;
@@ -260,11 +273,16 @@ bool AudioResampler::Open(Filesystem_Stream::InputStream stream) {
 			speex_resampler_skip_zeros(conversion_state);
 		#elif defined(HAVE_LIBSAMPLERATE)
 			conversion_state = src_new(sampling_quality, nr_of_channels, &lasterror);
+		#else
+			conversion_state = std::make_unique<AudioSincResampler>(nr_of_channels, static_cast<AudioSincResampler::Quality>(sampling_quality));
+			input_finished = false;
 		#endif
 
-		//Init the conversion data structure
-		conversion_data.input_frames = 0;
-		conversion_data.input_frames_used = 0;
+		#if defined(HAVE_LIBSPEEXDSP) || defined(HAVE_LIBSAMPLERATE)
+			//Init the conversion data structure
+			conversion_data.input_frames = 0;
+			conversion_data.input_frames_used = 0;
+		#endif
 		finished = false;
 
 		if (conversion_state)
@@ -297,14 +315,19 @@ void AudioResampler::SetFade(int end, std::chrono::milliseconds duration) {
 
 bool AudioResampler::Seek(std::streamoff offset, std::ios_base::seekdir origin) {
 	if (wrapped_decoder->Seek(offset, origin)) {
-		//reset conversion data
-		conversion_data.input_frames = 0;
-		conversion_data.input_frames_used = 0;
 		finished = wrapped_decoder->IsFinished();
+		#if defined(HAVE_LIBSPEEXDSP) || defined(HAVE_LIBSAMPLERATE)
+			//reset conversion data
+			conversion_data.input_frames = 0;
+			conversion_data.input_frames_used = 0;
+		#endif
 		#if defined(HAVE_LIBSPEEXDSP)
 			speex_resampler_reset_mem(conversion_state);
 		#elif defined(HAVE_LIBSAMPLERATE)
 			src_reset(conversion_state);
+		#else
+			conversion_state->Reset();
+			input_finished = false;
 		#endif
 		return true;
 	}
@@ -363,6 +386,13 @@ bool AudioResampler::SetFormat(int freq, AudioDecoder::Format fmt, int channels)
 	wrapped_decoder->GetFormat(input_rate, input_format, nr_of_channels);
 	output_rate = freq;
 
+	#if !defined(HAVE_LIBSPEEXDSP) && !defined(HAVE_LIBSAMPLERATE)
+		if (conversion_state && conversion_state->GetChannels() != nr_of_channels) {
+			conversion_state = std::make_unique<AudioSincResampler>(nr_of_channels, static_cast<AudioSincResampler::Quality>(sampling_quality));
+			input_finished = false;
+		}
+	#endif
+
 	mono_to_stereo_resample = false;
 	if (channels == 2 && nr_of_channels == 1) {
 		mono_to_stereo_resample = true;
@@ -410,11 +440,13 @@ int AudioResampler::FillBuffer(uint8_t* buffer, int length) {
 	int sample_size = AudioDecoder::GetSamplesizeForFormat(output_format);
 
 	// Duplicate data from the back, allows writing to the buffer directly
-	for (int i = amount_filled - sample_size; i > 0; i -= sample_size) {
-		// left channel
-		memcpy(&buffer[i * 2], &buffer[i], sample_size);
+	for (int i = amount_filled - sample_size; i >= 0; i -= sample_size) {
 		// right channel
 		memcpy(&buffer[i * 2 + sample_size], &buffer[i], sample_size);
+		// left channel (is already in place for the first frame)
+		if (i > 0) {
+			memcpy(&buffer[i * 2], &buffer[i], sample_size);
+		}
 	}
 
 	return amount_filled * 2;
@@ -495,6 +527,56 @@ int AudioResampler::FillBufferSameRate(uint8_t* buffer, int length) {
 	}
 }
 
+#if !defined(HAVE_LIBSPEEXDSP) && !defined(HAVE_LIBSAMPLERATE)
+int AudioResampler::FillBufferDifferentRate(uint8_t* buffer, int length) {
+	const int input_samplesize = AudioDecoder::GetSamplesizeForFormat(input_format);
+	const int output_samplesize = AudioDecoder::GetSamplesizeForFormat(output_format);
+	const int frame_size = output_samplesize * nr_of_channels;
+	//The converted input must fit in the internal buffer in both formats
+	const int max_frames = sizeof(internal_buffer) / std::max(input_samplesize, output_samplesize) / nr_of_channels;
+
+	double ratio = (input_rate * 1.0) / output_rate;
+	if (!pitch_handled_by_decoder) {
+		ratio = ratio * pitch / STANDARD_PITCH;
+	}
+	//Only a changed cutoff rebuilds the filter, pitch changes are cheap
+	conversion_state->SetRatio(ratio);
+
+	int total_output_frames = length / frame_size;
+	float* output = reinterpret_cast<float*>(buffer);
+
+	while (total_output_frames > 0) {
+		int generated = conversion_state->Read(output, total_output_frames);
+		total_output_frames -= generated;
+		output += generated * nr_of_channels;
+
+		if (generated > 0) {
+			continue;
+		}
+
+		//The filter needs more input
+		if (input_finished) {
+			finished = true;
+			break;
+		}
+
+		int amount_of_samples_read = DecodeAndConvertFloat(wrapped_decoder.get(), internal_buffer, max_frames * nr_of_channels, input_samplesize, input_format);
+		if (amount_of_samples_read < 0) {
+			error_message = wrapped_decoder->GetError();
+			return amount_of_samples_read; //error occured
+		}
+
+		if (amount_of_samples_read == 0) {
+			input_finished = true;
+			conversion_state->Finish();
+		} else {
+			conversion_state->Write(reinterpret_cast<float*>(internal_buffer), amount_of_samples_read / nr_of_channels);
+		}
+	}
+
+	return length - total_output_frames * frame_size;
+}
+#else
 int AudioResampler::FillBufferDifferentRate(uint8_t* buffer, int length) {
 	const int input_samplesize = AudioDecoder::GetSamplesizeForFormat(input_format);
 	const int output_samplesize = AudioDecoder::GetSamplesizeForFormat(output_format);
@@ -617,5 +699,6 @@ int AudioResampler::FillBufferDifferentRate(uint8_t* buffer, int length) {
 	}
 	return length;
 }
+#endif
 
 #endif
@@ -29,10 +29,13 @@
 #include <speex/speex_resampler.h>
 #elif defined(HAVE_LIBSAMPLERATE)
 #include <samplerate.h>
+#else
+#include "audio_sinc_resampler.h"
 #endif
 
 /**
  * Audio resampler powered by Libspeexdsp or Libsamplerate
+ * Without them the built-in AudioSincResampler is used.
  * Wraps another decoder and provides resampling.
  */
 class AudioResampler : public AudioDecoderBase {
@@ -184,7 +187,7 @@ public:
 	 * Requests a certain frame format from the resampler.
 	 * Supported formats are:
 	 *  * float,int16_t for libspeexdsp
-	 *  * float for libsamplerate
+	 *  * float for libsamplerate and the built-in resampler
 	 * The channel setting is redirected to the wrapped decoder.
 	 * The frequency setting controls the resampler.
 	 *
@@ -256,6 +259,10 @@ private:
 	#elif defined(HAVE_LIBSAMPLERATE)
 		SRC_DATA conversion_data;
 		SRC_STATE * conversion_state = nullptr;
+	#else
+		std::unique_ptr<AudioSincResampler> conversion_state;
+		/** Whether the wrapped decoder has no more input for the filter */
+		bool input_finished = false;
 	#endif
 
 	/**
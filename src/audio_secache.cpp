@@ -16,8 +16,10 @@
  */
 
 // Headers
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <list>
 #include <map>
 #include <memory>
 #include <set>
@@ -27,29 +29,47 @@
 #include "filefinder.h"
 #include "output.h"
 
-using namespace std::chrono_literals;
-
 namespace {
-	typedef std::map<std::string, AudioSeRef> cache_type;
+	/** Cache entry names, the least recently used first */
+	typedef std::list<std::string> lru_type;
+
+	struct CacheEntry {
+		AudioSeRef se;
+		lru_type::iterator lru;
+	};
+
+	typedef std::map<std::string, CacheEntry> cache_type;
 
 	cache_type cache;
+	lru_type lru_list;
 
-	constexpr int cache_limit = 3 * 1024 * 1024;
-	int cache_size = 0;
+	size_t cache_limit = 8 * 1024 * 1024;
+	size_t cache_size = 0;
 
-	void FreeCacheMemory() {
-		auto cur_time = Game_Clock::GetFrameTime();
+	int output_frequency = 0;
 
-		for (auto it = cache.begin(); it != cache.end(); ) {
-			if (it->second.use_count() > 1) {
-				// SE is currently playing
-				++it;
-				continue;
-			}
+	size_t GetMemorySize(const AudioSeData& se) {
+		return se.buffer.size() + (se.converted ? se.converted->buffer.size() : 0);
+	}
+
+	bool IsPlaying(const AudioSeRef& se) {
+		return se.use_count() > 1 || (se->converted && se->converted.use_count() > 1);
+	}
 
-			if (cache_size <= cache_limit && cur_time - it->second->last_access < 3s) {
-				// Below memory limit and last access < 3s
-				++it;
+	/** Marks the entry as the most recently used one */
+	void Touch(CacheEntry& entry) {
+		lru_list.splice(lru_list.end(), lru_list, entry.lru);
+		entry.se->last_access = Game_Clock::GetFrameTime();
+	}
+
+	void FreeCacheMemory() {
+		// Flush the least recently used samples which are not playing
+		for (auto lru = lru_list.begin(); cache_size > cache_limit && lru != lru_list.end(); ) {
+			auto it = cache.find(*lru);
+			assert(it != cache.end());
+
+			if (IsPlaying(it->second.se)) {
+				++lru;
 				continue;
 			}
 
@@ -57,13 +77,54 @@ namespace {
 			Output::Debug("SE: Freeing memory of {}", it->first);
 #endif
 
-			cache_size -= it->second->buffer.size();
-
-			it = cache.erase(it);
+			cache_size -= GetMemorySize(*it->second.se);
+			cache.erase(it);
+			lru = lru_list.erase(lru);
 		}
 
 #ifdef CACHE_DEBUG
 		Output::Debug("SE cache size: {}", cache_size / 1024.0 / 1024);
+#endif
+	}
+
+	/**
+	 * Converts the sample to the output frequency as signed 16 bit.
+	 *
+	 * @return converted sample or null on failure
+	 */
+	AudioSeRef Convert(const AudioSeRef& se) {
+#ifdef USE_AUDIO_RESAMPLER
+		std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
+		dec = std::make_unique<AudioResampler>(std::move(dec));
+		Filesystem_Stream::InputStream is;
+		dec->Open(std::move(is));
+		dec->SetFormat(output_frequency, AudioDecoder::Format::F32, se->channels);
+
+		auto out = std::make_shared<AudioSeData>();
+		dec->GetFormat(out->frequency, out->format, out->channels);
+		if (out->frequency != output_frequency || out->format != AudioDecoder::Format::F32 ||
+				out->channels != se->channels) {
+			return {};
+		}
+
+		// Float is supported by every resampler, convert it afterwards
+		std::vector<uint8_t> data = dec->DecodeAll();
+		size_t samples = data.size() / sizeof(float);
+		out->buffer.resize(samples * sizeof(int16_t));
+		out->format = AudioDecoder::Format::S16;
+
+		auto* in_ptr = reinterpret_cast<const float*>(data.data());
+		auto* out_ptr = reinterpret_cast<int16_t*>(out->buffer.data());
+		for (size_t i = 0; i < samples; ++i) {
+			float v = std::min(std::max(in_ptr[i], -1.0f), 1.0f);
+			out_ptr[i] = static_cast<int16_t>(v * 32767.0f);
+		}
+
+		out->last_access = se->last_access;
+		return out;
+#else
+		(void)se;
+		return {};
 #endif
 	}
 }
@@ -123,9 +184,9 @@ bool AudioSeCache::GetCachedFormat(int& frequency, AudioDecoder::Format& format,
 	cache_type::const_iterator it = cache.find(name);
 
 	if (it != cache.end()) {
-		frequency = (*it).second->frequency;
-		format = (*it).second->format;
-		channels = (*it).second->channels;
+		frequency = (*it).second.se->frequency;
+		format = (*it).second.se->format;
+		channels = (*it).second.se->channels;
 
 		return true;
 	}
@@ -133,35 +194,23 @@ bool AudioSeCache::GetCachedFormat(int& frequency, AudioDecoder::Format& format,
 	return false;
 }
 
-std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
-	AudioSeRef se;
-
+AudioSeRef AudioSeCache::Decode() {
 	auto it = cache.find(name);
 	if (it != cache.end()) {
-		se = it->second;
-		se->last_access = Game_Clock::GetFrameTime();
-
-		std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
-#ifdef USE_AUDIO_RESAMPLER
-		dec = std::make_unique<AudioResampler>(std::move(dec));
-#endif
-		Filesystem_Stream::InputStream is;
-		dec->Open(std::move(is));
-		return dec;
+		Touch(it->second);
+		return it->second.se;
 	}
 
 	// Not cached yet: Decode the sample without any resampling
-
-	if (!se) {
-		se.reset(new AudioSeData());
-	}
+	AudioSeRef se = std::make_shared<AudioSeData>();
 
 	assert(audio_decoder);
 
 	audio_decoder->GetFormat(se->frequency, se->format, se->channels);
 	se->buffer = audio_decoder->DecodeAll();
+	se->last_access = Game_Clock::GetFrameTime();
 
-	cache.insert(std::make_pair(name, se));
+	cache.insert(std::make_pair(name, CacheEntry { se, lru_list.insert(lru_list.end(), name) }));
 
 	cache_size += se->buffer.size();
 
@@ -171,25 +220,74 @@ std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
 
 	FreeCacheMemory();
 
-	std::unique_ptr<AudioDecoderBase> dec = std::unique_ptr<AudioDecoderBase>(new AudioSeDecoder(se));
+	return se;
+}
+
+std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
+	std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(Decode());
 #ifdef USE_AUDIO_RESAMPLER
-	dec = std::unique_ptr<AudioDecoderBase>(new AudioResampler(std::move(dec)));
+	dec = std::make_unique<AudioResampler>(std::move(dec));
 #endif
 	Filesystem_Stream::InputStream is;
 	dec->Open(std::move(is));
 	return dec;
 }
 
+std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder(int pitch) {
+	if (pitch != 100 || output_frequency <= 0) {
+		return CreateSeDecoder();
+	}
+
+	AudioSeRef se = Decode();
+
+	if (se->frequency == output_frequency && se->format == AudioDecoder::Format::S16) {
+		// Already in the output format
+		return std::make_unique<AudioSeDecoder>(se);
+	}
+
+	if (!se->converted || se->converted->frequency != output_frequency) {
+		cache_size -= GetMemorySize(*se);
+		se->converted = Convert(se);
+		cache_size += GetMemorySize(*se);
+
+		FreeCacheMemory();
+	}
+
+	if (!se->converted) {
+		return CreateSeDecoder();
+	}
+
+	return std::make_unique<AudioSeDecoder>(se->converted);
+}
+
+void AudioSeCache::Preload() {
+	CreateSeDecoder(100);
+}
+
 AudioSeRef AudioSeCache::GetSeData() const {
 	auto it = cache.find(name);
 	assert(it != cache.end());
 
-	return it->second;
+	return it->second.se;
 };
 
 void AudioSeCache::Clear() {
 	cache_size = 0;
 	cache.clear();
+	lru_list.clear();
+}
+
+void AudioSeCache::SetOutputFrequency(int frequency) {
+	output_frequency = frequency;
+}
+
+void AudioSeCache::SetMemoryLimit(size_t bytes) {
+	cache_limit = bytes;
+	FreeCacheMemory();
+}
+
+bool AudioSeCache::IsFull() {
+	return cache_size >= cache_limit;
 }
 
 StringView AudioSeCache::GetName() const {
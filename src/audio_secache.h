@@ -40,6 +40,11 @@ public:
 	int frequency;
 	AudioDecoder::Format format;
 	int channels;
+	/**
+	 * The sample converted to the output frequency as signed 16 bit.
+	 * Created on the first play at normal pitch, null when not converted yet.
+	 */
+	std::shared_ptr<AudioSeData> converted;
 };
 
 typedef std::shared_ptr<AudioSeData> AudioSeRef;
@@ -70,8 +75,10 @@ private:
  * AudioSeCache provides an interface for accessing sound effects.
  * It also provides an automatic cache management, any SE is only decoded
  * once, otherwise returned from the cache.
- * The cache is flushed from recently (>10 seconds by default) unused
- * samples when it reaches the memory limit (5 MB by default).
+ * Samples played at normal pitch are additionally cached at the output
+ * frequency, so they are mixed without any resampling.
+ * When the memory limit is reached the least recently used samples which
+ * are not playing are flushed.
  * Uses an internal AudioDecoder for handling the decoding.
  */
 class AudioSeCache {
@@ -125,6 +132,21 @@ public:
 	 */
 	std::unique_ptr<AudioDecoderBase> CreateSeDecoder();
 
+	/**
+	 * Like CreateSeDecoder but for playback at the passed pitch.
+	 * At normal pitch the returned decoder delivers the sample already
+	 * converted to the output frequency (see SetOutputFrequency).
+	 *
+	 * @param pitch Pitch the SE is played at
+	 * @return Decoded sound effect
+	 */
+	std::unique_ptr<AudioDecoderBase> CreateSeDecoder(int pitch);
+
+	/**
+	 * Decodes and converts the sample into the cache without playing it.
+	 */
+	void Preload();
+
 	/**
 	 * Returns the SE sample data handled by this SeCache.
 	 *
@@ -138,7 +160,29 @@ public:
 	StringView GetName() const;
 
 	static void Clear();
+
+	/**
+	 * Sets the frequency of the audio output. Samples played at normal
+	 * pitch are converted to it. 0 (the default) disables the conversion.
+	 *
+	 * @param frequency Output frequency
+	 */
+	static void SetOutputFrequency(int frequency);
+
+	/**
+	 * Sets the memory limit of all cached samples.
+	 *
+	 * @param bytes Limit in bytes
+	 */
+	static void SetMemoryLimit(size_t bytes);
+
+	/**
+	 * @return Whether the cached samples reached the memory limit
+	 */
+	static bool IsFull();
 private:
+	AudioSeRef Decode();
+
 	std::unique_ptr<AudioDecoderBase> audio_decoder;
 
 	std::string name;
@@ -0,0 +1,240 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "audio_sinc_resampler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define EP_AUDIO_SINC_RESAMPLER_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define EP_AUDIO_SINC_RESAMPLER_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace {
+	constexpr double pi = 3.14159265358979323846;
+
+	/** Maximum ratio, higher ratios skip most of the input anyway */
+	constexpr double max_ratio = 64.0;
+
+	/** Steps of the cutoff which trigger a rebuild of the filter */
+	constexpr double cutoff_step = 1.0 / 16.0;
+
+	/**
+	 * Input frames buffered without reallocation, more than AudioResampler
+	 * writes at once. The audio callback then never grows the history.
+	 */
+	constexpr int reserved_frames = 1024;
+
+	double Sinc(double x) {
+		if (x == 0.0) {
+			return 1.0;
+		}
+		return std::sin(pi * x) / (pi * x);
+	}
+
+	/** Blackman window, u in [-1, 1] */
+	double Window(double u) {
+		if (u <= -1.0 || u >= 1.0) {
+			return 0.0;
+		}
+		return 0.42 + 0.5 * std::cos(pi * u) + 0.08 * std::cos(2.0 * pi * u);
+	}
+
+	/**
+	 * Filters one output sample. The coefficients are interpolated between
+	 * two neighbouring phases.
+	 *
+	 * @param h0 coefficients of the lower phase
+	 * @param h1 coefficients of the upper phase
+	 * @param frac position between the phases
+	 * @param x input samples
+	 * @param taps number of taps, a multiple of 4
+	 */
+	float Dot(const float* h0, const float* h1, float frac, const float* x, int taps) {
+#if defined(EP_AUDIO_SINC_RESAMPLER_SSE2)
+		const __m128 f = _mm_set1_ps(frac);
+		__m128 acc = _mm_setzero_ps();
+		for (int k = 0; k < taps; k += 4) {
+			__m128 c0 = _mm_loadu_ps(h0 + k);
+			__m128 c = _mm_add_ps(c0, _mm_mul_ps(f, _mm_sub_ps(_mm_loadu_ps(h1 + k), c0)));
+			acc = _mm_add_ps(acc, _mm_mul_ps(c, _mm_loadu_ps(x + k)));
+		}
+		acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+		acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+		return _mm_cvtss_f32(acc);
+#elif defined(EP_AUDIO_SINC_RESAMPLER_NEON)
+		const float32x4_t f = vdupq_n_f32(frac);
+		float32x4_t acc = vdupq_n_f32(0.0f);
+		for (int k = 0; k < taps; k += 4) {
+			float32x4_t c0 = vld1q_f32(h0 + k);
+			float32x4_t c = vmlaq_f32(c0, f, vsubq_f32(vld1q_f32(h1 + k), c0));
+			acc = vmlaq_f32(acc, c, vld1q_f32(x + k));
+		}
+		float32x2_t sum = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+		return vget_lane_f32(vpadd_f32(sum, sum), 0);
+#else
+		float acc = 0.0f;
+		for (int k = 0; k < taps; ++k) {
+			acc += (h0[k] + frac * (h1[k] - h0[k])) * x[k];
+		}
+		return acc;
+#endif
+	}
+}
+
+AudioSincResampler::AudioSincResampler(int channels, Quality quality) : channels(channels) {
+	assert(channels > 0);
+
+	switch (quality) {
+		case Quality::Low:
+			taps = 8;
+			phases = 32;
+			rolloff = 0.85;
+			break;
+		case Quality::Medium:
+			taps = 16;
+			phases = 128;
+			rolloff = 0.91;
+			break;
+		case Quality::High:
+			taps = 32;
+			phases = 256;
+			rolloff = 0.95;
+			break;
+	}
+
+	history.resize(channels);
+	for (auto& row: history) {
+		row.reserve(taps + reserved_frames);
+	}
+	Reset();
+	SetRatio(1.0);
+}
+
+void AudioSincResampler::SetRatio(double new_ratio) {
+	ratio = std::min(std::max(new_ratio, 1.0 / max_ratio), max_ratio);
+
+	// Downsampling must remove the frequencies above the output Nyquist
+	double new_cutoff = rolloff * std::min(1.0, 1.0 / ratio);
+	if (filter.empty() || std::abs(new_cutoff - cutoff) > cutoff_step) {
+		BuildFilter(new_cutoff);
+	}
+}
+
+void AudioSincResampler::BuildFilter(double new_cutoff) {
+	cutoff = new_cutoff;
+
+	const int half = taps / 2;
+	filter.resize((phases + 1) * taps);
+
+	for (int p = 0; p <= phases; ++p) {
+		float* row = &filter[p * taps];
+		const double phase = static_cast<double>(p) / phases;
+
+		double sum = 0.0;
+		for (int k = 0; k < taps; ++k) {
+			// Distance of the tap from the output position in input frames
+			double x = (k - (half - 1)) - phase;
+			double v = cutoff * Sinc(cutoff * x) * Window(x / half);
+			row[k] = static_cast<float>(v);
+			sum += v;
+		}
+
+		// Unity gain for DC
+		for (int k = 0; k < taps; ++k) {
+			row[k] = static_cast<float>(row[k] / sum);
+		}
+	}
+}
+
+void AudioSincResampler::Write(const float* in, int frames) {
+	if (frames <= 0) {
+		return;
+	}
+
+	for (int c = 0; c < channels; ++c) {
+		auto& row = history[c];
+		const size_t old_size = row.size();
+		row.resize(old_size + frames);
+		for (int i = 0; i < frames; ++i) {
+			row[old_size + i] = in[i * channels + c];
+		}
+	}
+}
+
+void AudioSincResampler::Finish() {
+	if (finished) {
+		return;
+	}
+	finished = true;
+
+	// Silence after the end lets the last input frames pass the filter
+	for (auto& row: history) {
+		row.resize(row.size() + taps / 2, 0.0f);
+	}
+}
+
+int AudioSincResampler::Read(float* out, int frames) {
+	const int half = taps / 2;
+	const int size = static_cast<int>(history[0].size());
+
+	int n = 0;
+	for (; n < frames; ++n) {
+		const int i0 = static_cast<int>(position);
+		if (i0 + half >= size) {
+			break;
+		}
+
+		const double pf = (position - i0) * phases;
+		const int p = static_cast<int>(pf);
+		const float frac = static_cast<float>(pf - p);
+		const float* h0 = &filter[p * taps];
+		const float* h1 = h0 + taps;
+		const int start = i0 - half + 1;
+
+		for (int c = 0; c < channels; ++c) {
+			out[n * channels + c] = Dot(h0, h1, frac, &history[c][start], taps);
+		}
+
+		position += ratio;
+	}
+
+	// Drop the input which is not needed by later output
+	int drop = std::min(static_cast<int>(position) - (half - 1), size);
+	if (drop > 0) {
+		for (auto& row: history) {
+			row.erase(row.begin(), row.begin() + drop);
+		}
+		position -= drop;
+	}
+
+	return n;
+}
+
+void AudioSincResampler::Reset() {
+	// Silence before the start, the first output frame is the first input frame
+	for (auto& row: history) {
+		row.assign(taps / 2 - 1, 0.0f);
+	}
+	position = taps / 2 - 1;
+	finished = false;
+}
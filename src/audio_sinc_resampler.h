@@ -0,0 +1,129 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_AUDIO_SINC_RESAMPLER_H
+#define EP_AUDIO_SINC_RESAMPLER_H
+
+// Headers
+#include <vector>
+
+/**
+ * Windowed sinc polyphase resampler for interleaved float samples.
+ *
+ * Used by AudioResampler when neither libspeexdsp nor libsamplerate is
+ * available. The filter is a table of phases which are linearly
+ * interpolated, the dot products use SSE2 or NEON when available.
+ *
+ * Changing the ratio only changes the step through the input. The table
+ * is rebuilt when the anti-aliasing cutoff of a downsampling ratio moves
+ * by more than one step of 1/16.
+ */
+class AudioSincResampler {
+public:
+	/** Resampling quality */
+	enum class Quality {
+		/** 8 taps, 32 phases */
+		Low,
+		/** 16 taps, 128 phases */
+		Medium,
+		/** 32 taps, 256 phases */
+		High
+	};
+
+	/**
+	 * @param channels number of interleaved channels
+	 * @param quality filter length and phase resolution
+	 */
+	AudioSincResampler(int channels, Quality quality);
+
+	/**
+	 * Sets the conversion ratio.
+	 *
+	 * @param ratio input frames consumed per output frame, e.g. 0.5 for
+	 *  22050 Hz to 44100 Hz or 2.0 to play at double pitch
+	 */
+	void SetRatio(double ratio);
+
+	/** @return input frames consumed per output frame */
+	double GetRatio() const;
+
+	/**
+	 * Appends input samples.
+	 *
+	 * @param in interleaved samples
+	 * @param frames number of frames
+	 */
+	void Write(const float* in, int frames);
+
+	/**
+	 * Marks the end of the input. The frames still in the filter
+	 * are flushed by the following Read calls.
+	 */
+	void Finish();
+
+	/**
+	 * Produces output samples from the written input.
+	 *
+	 * @param out interleaved output, frames * channels values
+	 * @param frames maximum number of frames
+	 * @return frames written, 0 when more input is needed
+	 */
+	int Read(float* out, int frames);
+
+	/** Drops the buffered input and restarts the stream */
+	void Reset();
+
+	/** @return number of interleaved channels */
+	int GetChannels() const;
+
+	/** @return number of taps of the filter */
+	int GetTaps() const;
+
+private:
+	void BuildFilter(double cutoff);
+
+	int channels;
+	int taps = 8;
+	int phases = 32;
+	double rolloff = 0.85;
+
+	double ratio = 1.0;
+	/** Cutoff the filter table was built for, relative to the input Nyquist */
+	double cutoff = 0.0;
+	/** phases + 1 rows of taps coefficients */
+	std::vector<float> filter;
+
+	/** Buffered input, one contiguous row per channel */
+	std::vector<std::vector<float>> history;
+	/** Position of the next output frame in the history */
+	double position = 0.0;
+	bool finished = false;
+};
+
+inline double AudioSincResampler::GetRatio() const {
+	return ratio;
+}
+
+inline int AudioSincResampler::GetChannels() const {
+	return channels;
+}
+
+inline int AudioSincResampler::GetTaps() const {
+	return taps;
+}
+
+#endif
@@ -0,0 +1,344 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <fmt/format.h>
+#include <lcf/data.h>
+#include <lcf/reader_util.h>
+#include "battle_simulator.h"
+#include "autobattle.h"
+#include "enemyai.h"
+#include "game_actor.h"
+#include "game_actors.h"
+#include "game_battle.h"
+#include "game_battlealgorithm.h"
+#include "game_enemy.h"
+#include "game_enemyparty.h"
+#include "game_party.h"
+#include "game_switches.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "player.h"
+#include "rand.h"
+#include "utils.h"
+
+namespace {
+	struct Algorithms {
+		std::vector<std::unique_ptr<AutoBattle::AlgorithmBase>> autobattle;
+		std::vector<std::unique_ptr<EnemyAi::AlgorithmBase>> enemyai;
+		int default_autobattle = 0;
+		int default_enemyai = 0;
+	};
+
+	/** Same algorithm selection as Scene_Battle */
+	Algorithms CreateAlgorithms() {
+		Algorithms algos;
+		algos.autobattle.push_back(AutoBattle::CreateAlgorithm(AutoBattle::RpgRtCompat::name));
+		algos.autobattle.push_back(AutoBattle::CreateAlgorithm(AutoBattle::RpgRtImproved::name));
+		algos.autobattle.push_back(AutoBattle::CreateAlgorithm(AutoBattle::AttackOnly::name));
+		algos.enemyai.push_back(EnemyAi::CreateAlgorithm(EnemyAi::RpgRtCompat::name));
+		algos.enemyai.push_back(EnemyAi::CreateAlgorithm(EnemyAi::RpgRtImproved::name));
+
+		if (lcf::Data::system.easyrpg_default_actorai == -1) {
+			algos.default_autobattle = AutoBattle::CreateAlgorithm(Player::player_config.autobattle_algo.Get())->GetId();
+		} else {
+			algos.default_autobattle = lcf::Data::system.easyrpg_default_actorai;
+		}
+		if (lcf::Data::system.easyrpg_default_enemyai == -1) {
+			algos.default_enemyai = EnemyAi::CreateAlgorithm(Player::player_config.enemyai_algo.Get())->GetId();
+		} else {
+			algos.default_enemyai = lcf::Data::system.easyrpg_default_enemyai;
+		}
+		return algos;
+	}
+
+	template <typename T>
+	T& SelectAlgorithm(std::vector<std::unique_ptr<T>>& algos, int id, int default_id) {
+		if (id < 0 || id >= static_cast<int>(algos.size())) {
+			id = Utils::Clamp(default_id, 0, static_cast<int>(algos.size()) - 1);
+		}
+		return *algos[id];
+	}
+
+	Game_Battler* GetRestrictedTarget(Game_Battler& battler) {
+		const bool ally = battler.GetType() == Game_Battler::Type_Ally;
+		switch (battler.GetSignificantRestriction()) {
+			case lcf::rpg::State::Restriction_attack_ally:
+				return ally ? Main_Data::game_party->GetRandomActiveBattler() : Main_Data::game_enemyparty->GetRandomActiveBattler();
+			case lcf::rpg::State::Restriction_attack_enemy:
+				return ally ? Main_Data::game_enemyparty->GetRandomActiveBattler() : Main_Data::game_party->GetRandomActiveBattler();
+			default:
+				break;
+		}
+		return nullptr;
+	}
+
+	/** Actor and enemy action selection of Scene_Battle_Rpg2k */
+	void CreateActions(Algorithms& algos, std::vector<Game_Battler*>& actions) {
+		for (auto* actor : Main_Data::game_party->GetActors()) {
+			if (!actor->CanAct()) {
+				actor->SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::None>(actor));
+			} else if (auto* target = GetRestrictedTarget(*actor)) {
+				actor->SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::Normal>(actor, target));
+			} else {
+				SelectAlgorithm(algos.autobattle, actor->GetActorAi(), algos.default_autobattle).SetAutoBattleAction(*actor);
+			}
+			actions.push_back(actor);
+		}
+
+		for (auto* enemy : Main_Data::game_enemyparty->GetEnemies()) {
+			if (enemy->IsHidden()) {
+				continue;
+			}
+			if (!EnemyAi::SetStateRestrictedAction(*enemy)) {
+				SelectAlgorithm(algos.enemyai, enemy->GetEnemyAi(), algos.default_enemyai).SetEnemyAiAction(*enemy);
+			}
+			actions.push_back(enemy);
+		}
+
+		for (auto* battler : actions) {
+			int battle_order = battler->GetAgi() + Rand::GetRandomNumber(0, battler->GetAgi() / 4 + 3);
+			if (battler->GetBattleAlgorithm()->GetType() == Game_BattleAlgorithm::Type::Normal && battler->HasPreemptiveAttack()) {
+				battle_order += 9999;
+			}
+			battler->SetBattleOrderAgi(battle_order);
+		}
+		std::stable_sort(actions.begin(), actions.end(), [](Game_Battler* l, Game_Battler* r) {
+			return l->GetBattleOrderAgi() > r->GetBattleOrderAgi();
+		});
+	}
+
+	/** Same checks as Scene_Battle::PrepareBattleAction */
+	void PrepareAction(Game_Battler& battler) {
+		if (!battler.CanAct()) {
+			battler.SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::None>(&battler));
+			return;
+		}
+
+		if (auto* target = GetRestrictedTarget(battler)) {
+			battler.SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::Normal>(&battler, target));
+			return;
+		}
+
+		if (!battler.GetBattleAlgorithm()->ActionIsPossible()) {
+			battler.SetBattleAlgorithm(std::make_shared<Game_BattleAlgorithm::None>(&battler));
+		}
+	}
+
+	struct BattleDamage {
+		int party_taken = 0;
+		int troop_taken = 0;
+	};
+
+	void ProcessAction(Game_BattleAlgorithm::AlgorithmBase& action, BattleSimulator::Result& result, BattleDamage& damage) {
+		auto* src = action.GetSource();
+		src->NextBattleTurn();
+		src->BattleStateHeal();
+		src->ApplyConditions();
+
+		if (action.GetType() == Game_BattleAlgorithm::Type::None) {
+			return;
+		}
+
+		action.Start();
+		action.ReflectTargets();
+
+		const bool by_party = src->GetType() == Game_Battler::Type_Ally;
+		do {
+			action.Execute();
+			action.ApplyCustomEffect();
+			action.ApplySwitchEffect();
+
+			auto* target = action.GetTarget();
+			if (!action.IsSuccess() || !target) {
+				continue;
+			}
+
+			const int hp = action.ApplyHpEffect();
+			if (hp < 0) {
+				(by_party ? result.party_hit_damage : result.troop_hit_damage).Add(-hp);
+				(target->GetType() == Game_Battler::Type_Ally ? damage.party_taken : damage.troop_taken) -= hp;
+			}
+			action.ApplySpEffect();
+			action.ApplyAtkEffect();
+			action.ApplyDefEffect();
+			action.ApplySpiEffect();
+			action.ApplyAgiEffect();
+			action.ApplyStateEffects();
+			action.ApplyAttributeShiftEffects();
+		} while (action.RepeatNext(true) || action.TargetNext());
+
+		action.ProcessPostActionSwitches();
+	}
+
+	void RunBattle(const BattleSimulator::Config& config, Algorithms& algos, BattleSimulator::Result& result) {
+		Main_Data::game_party->ResetTurns();
+		Main_Data::game_enemyparty->ResetBattle(config.troop_id);
+		Main_Data::game_actors->ResetBattle();
+		for (auto* actor : Main_Data::game_party->GetActors()) {
+			actor->ResetEquipmentStates(true);
+		}
+
+		BattleDamage damage;
+		std::vector<Game_Battler*> actions;
+
+		auto is_over = []() {
+			return Game_Battle::CheckWin() || Game_Battle::CheckLose();
+		};
+
+		int turn = 0;
+		while (!is_over() && turn < config.max_turns) {
+			++turn;
+			Main_Data::game_party->IncTurns();
+
+			actions.clear();
+			CreateActions(algos, actions);
+
+			for (auto* battler : actions) {
+				if (is_over()) {
+					break;
+				}
+				if (battler->Exists()) {
+					PrepareAction(*battler);
+					auto action = battler->GetBattleAlgorithm();
+					ProcessAction(*action, result, damage);
+				}
+			}
+			for (auto* battler : actions) {
+				battler->SetBattleAlgorithm(nullptr);
+			}
+		}
+
+		++result.battles;
+		if (Game_Battle::CheckWin()) {
+			++result.victories;
+		} else if (Game_Battle::CheckLose()) {
+			++result.defeats;
+		} else {
+			++result.draws;
+		}
+		result.turns.Add(turn);
+		result.party_damage_taken.Add(damage.party_taken);
+		result.troop_damage_taken.Add(damage.troop_taken);
+	}
+
+	std::string FormatDistribution(const char* name, const BattleSimulator::Distribution& d) {
+		return fmt::format("{:<20} min {:>6} mean {:>9.1f} p50 {:>6} p90 {:>6} max {:>6}",
+				name, d.GetMin(), d.GetMean(), d.GetPercentile(50), d.GetPercentile(90), d.GetMax());
+	}
+}
+
+void BattleSimulator::Distribution::Add(int value) {
+	if (!samples.empty() && value < samples.back()) {
+		sorted = false;
+	}
+	samples.push_back(value);
+	sum += value;
+}
+
+int BattleSimulator::Distribution::GetCount() const {
+	return static_cast<int>(samples.size());
+}
+
+int BattleSimulator::Distribution::GetMin() const {
+	return samples.empty() ? 0 : *std::min_element(samples.begin(), samples.end());
+}
+
+int BattleSimulator::Distribution::GetMax() const {
+	return samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+}
+
+double BattleSimulator::Distribution::GetMean() const {
+	return samples.empty() ? 0.0 : static_cast<double>(sum) / samples.size();
+}
+
+int BattleSimulator::Distribution::GetPercentile(int p) const {
+	if (samples.empty()) {
+		return 0;
+	}
+	if (!sorted) {
+		// Only the order changes, the statistics stay the same
+		std::sort(samples.begin(), samples.end());
+		sorted = true;
+	}
+	const auto n = samples.size();
+	const auto rank = (Utils::Clamp(p, 0, 100) * n + 99) / 100;
+	return samples[std::max<size_t>(rank, 1) - 1];
+}
+
+BattleSimulator::Result BattleSimulator::Run(const Config& config) {
+	Result result;
+
+	if (lcf::ReaderUtil::GetElement(lcf::Data::troops, config.troop_id) == nullptr || Main_Data::game_party->GetBattlerCount() == 0) {
+		return result;
+	}
+
+	// Every battle starts from this state
+	const auto rng = Rand::GetRNG();
+	const auto switches = Main_Data::game_switches->GetData();
+	const auto variables = Main_Data::game_variables->GetData();
+	std::vector<lcf::rpg::SaveActor> actors;
+	for (auto* actor : Main_Data::game_party->GetActors()) {
+		actors.push_back(actor->GetSaveData());
+	}
+
+	auto algos = CreateAlgorithms();
+	const bool was_running = Game_Battle::battle_running;
+	Game_Battle::battle_running = true;
+
+	Rand::SeedRandomNumberGenerator(static_cast<int32_t>(config.seed));
+
+	for (int i = 0; i < config.battles; ++i) {
+		RunBattle(config, algos, result);
+
+		Main_Data::game_switches->SetData(switches);
+		Main_Data::game_variables->SetData(variables);
+		auto party = Main_Data::game_party->GetActors();
+		for (size_t j = 0; j < party.size(); ++j) {
+			party[j]->SetSaveData(actors[j]);
+		}
+	}
+
+	Game_Battle::battle_running = was_running;
+	Main_Data::game_actors->ResetBattle();
+	Main_Data::game_enemyparty->ResetBattle(0);
+	Rand::GetRNG() = rng;
+
+	return result;
+}
+
+std::vector<std::string> BattleSimulator::FormatReport(const Result& result) {
+	auto percent = [&](int n) {
+		return result.battles > 0 ? 100.0 * n / result.battles : 0.0;
+	};
+
+	std::vector<std::string> lines;
+	lines.push_back(fmt::format("Battles: {}", result.battles));
+	lines.push_back(fmt::format("Victory: {} ({:.1f}%) Defeat: {} ({:.1f}%) Draw: {} ({:.1f}%)",
+			result.victories, percent(result.victories),
+			result.defeats, percent(result.defeats),
+			result.draws, percent(result.draws)));
+	lines.push_back(FormatDistribution("Turns", result.turns));
+	lines.push_back(FormatDistribution("Party hit damage", result.party_hit_damage));
+	lines.push_back(FormatDistribution("Troop hit damage", result.troop_hit_damage));
+	lines.push_back(FormatDistribution("Party damage taken", result.party_damage_taken));
+	lines.push_back(FormatDistribution("Troop damage taken", result.troop_damage_taken));
+	return lines;
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_BATTLE_SIMULATOR_H
+#define EP_BATTLE_SIMULATOR_H
+
+// Headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Headless battle simulation for balancing.
+ *
+ * Runs battles of a troop against the current party with autobattle on
+ * both sides. The actions are processed with Game_BattleAlgorithm like in
+ * the RPG2k battle system, but without scene, windows, animations and
+ * waits. Battle events of the troop are not executed and escaping is
+ * not possible.
+ *
+ * The party, the switches and the variables are restored after every
+ * battle, so all battles start from the same state.
+ * The game state is process global, so the battles run one after another
+ * on the calling thread.
+ */
+namespace BattleSimulator {
+	struct Config {
+		/** Monster party to fight against */
+		int troop_id = 1;
+		/** Number of battles */
+		int battles = 1000;
+		/** Seed of the random number generator, the result only depends on it */
+		uint32_t seed = 0;
+		/** Battles lasting longer are counted as draw */
+		int max_turns = 100;
+	};
+
+	/** Samples of a value with summary statistics */
+	class Distribution {
+	public:
+		void Add(int value);
+
+		int GetCount() const;
+		int GetMin() const;
+		int GetMax() const;
+		double GetMean() const;
+
+		/**
+		 * @param p percentile in [0, 100]
+		 * @return nearest rank percentile, 0 when empty
+		 */
+		int GetPercentile(int p) const;
+
+	private:
+		mutable std::vector<int> samples;
+		int64_t sum = 0;
+		mutable bool sorted = true;
+	};
+
+	struct Result {
+		int battles = 0;
+		int victories = 0;
+		int defeats = 0;
+		/** Battles reaching the turn limit */
+		int draws = 0;
+
+		/** Turns per battle */
+		Distribution turns;
+		/** Damage of every hit by the party */
+		Distribution party_hit_damage;
+		/** Damage of every hit by the troop */
+		Distribution troop_hit_damage;
+		/** Total damage taken by the party per battle */
+		Distribution party_damage_taken;
+		/** Total damage taken by the troop per battle */
+		Distribution troop_damage_taken;
+	};
+
+	/**
+	 * Simulates battles against the current party.
+	 * The RNG state is restored afterwards.
+	 *
+	 * @param config simulation parameters
+	 * @return aggregated result of all battles
+	 */
+	Result Run(const Config& config);
+
+	/**
+	 * Formats a result as human readable report.
+	 *
+	 * @param result simulation result
+	 * @return report lines
+	 */
+	std::vector<std::string> FormatReport(const Result& result);
+}
+
+#endif
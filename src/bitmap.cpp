@@ -38,6 +38,7 @@
 #include "output.h"
 #include "util_macro.h"
 #include "bitmap_hslrgb.h"
+#include "bitmap_blit.h"
 #include <iostream>
 
 BitmapRef Bitmap::Create(int width, int height, const Color& color) {
@@ -318,15 +319,34 @@ void Bitmap::HueChangeBlit(int x, int y, Bitmap const& src, Rect const& src_rect
 	Bitmap bmp(reinterpret_cast<void*>(&pixels.front()), src_rect.width, src_rect.height, src_rect.width * 4, format);
 	bmp.Blit(0, 0, src, src_rect, Opacity::Opaque());
 
-	for (std::vector<uint32_t>::iterator p = pixels.begin(); p != pixels.end(); ++p) {
-		uint32_t pixel = *p;
-		uint8_t r = (pixel>>24) & 0xFF;
-		uint8_t g = (pixel>>16) & 0xFF;
-		uint8_t b = (pixel>> 8) & 0xFF;
-		uint8_t a = pixel & 0xFF;
-		if (a > 0)
+	// Graphics use few distinct colors. The converted colors are remembered
+	// in a small direct mapped table, the conversion itself is unchanged so
+	// the result is identical to converting every pixel.
+	constexpr int hue_cache_bits = 10;
+	struct HueCacheEntry {
+		// The low byte (alpha) is never part of a key, so 1 is an invalid key
+		uint32_t rgb = 1;
+		uint32_t result = 0;
+	};
+	std::vector<HueCacheEntry> hue_cache(1 << hue_cache_bits);
+
+	for (auto& pixel: pixels) {
+		uint32_t a = pixel & 0xFF;
+		uint32_t rgb = pixel & 0xFFFFFF00;
+		if (a == 0) {
+			continue;
+		}
+
+		auto& entry = hue_cache[((rgb >> 8) * 2654435761u) >> (32 - hue_cache_bits)];
+		if (entry.rgb != rgb) {
+			uint8_t r = (pixel>>24) & 0xFF;
+			uint8_t g = (pixel>>16) & 0xFF;
+			uint8_t b = (pixel>> 8) & 0xFF;
 			RGB_adjust_HSL(r, g, b, hue);
-		*p = ((uint32_t) r << 24) | ((uint32_t) g << 16) | ((uint32_t) b << 8) | (uint32_t) a;
+			entry.rgb = rgb;
+			entry.result = ((uint32_t) r << 24) | ((uint32_t) g << 16) | ((uint32_t) b << 8);
+		}
+		pixel = entry.result | a;
 	}
 
 	Blit(dst_rect.x, dst_rect.y, bmp, bmp.GetRect(), Opacity::Opaque());
@@ -605,11 +625,80 @@ namespace {
 	}
 } // anonymous namespace
 
+bool Bitmap::BlitKernel(int x, int y, Bitmap const& src, Rect const& src_rect, bool flip_x, bool flip_y, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	if (!BitmapBlit::IsEnabled() || &src == this || opacity.IsSplit()) {
+		return false;
+	}
+
+	if (src.pixman_format != pixman_format || !BitmapBlit::IsFormatSupported(format)) {
+		return false;
+	}
+
+	// pixman treats pixels outside of the source as transparent, not supported here
+	if (src_rect.x < 0 || src_rect.y < 0 || src_rect.x + src_rect.width > src.width() || src_rect.y + src_rect.height > src.height()) {
+		return false;
+	}
+
+	const bool masked = !opacity.IsOpaque();
+
+	// Same decision as GetOperator
+	bool over;
+	switch (blend_mode) {
+		case BlendMode::Default:
+			over = masked || (src.GetTransparent() && src.GetImageOpacity() != ImageOpacity::Opaque);
+			break;
+		case BlendMode::Normal:
+			over = true;
+			break;
+		case BlendMode::NormalWithoutAlpha:
+			if (masked) {
+				return false;
+			}
+			over = false;
+			break;
+		default:
+			return false;
+	}
+
+	Rect dst_rect(x, y, src_rect.width, src_rect.height);
+	dst_rect.Adjust(GetRect());
+	if (dst_rect.IsEmpty()) {
+		return true;
+	}
+
+	const int ox = dst_rect.x - x;
+	const int oy = dst_rect.y - y;
+	const int src_x = flip_x ? src_rect.x + src_rect.width - 1 - ox : src_rect.x + ox;
+	const int opacity_value = masked ? opacity.Value() : 255;
+
+	auto* dst_pixels = static_cast<uint8_t*>(pixels());
+	auto* src_pixels = static_cast<const uint8_t*>(src.pixels());
+
+	for (int i = 0; i < dst_rect.height; ++i) {
+		const int src_y = flip_y ? src_rect.y + src_rect.height - 1 - (oy + i) : src_rect.y + oy + i;
+
+		auto* dst_row = reinterpret_cast<uint32_t*>(dst_pixels + (dst_rect.y + i) * pitch()) + dst_rect.x;
+		auto* src_row = reinterpret_cast<const uint32_t*>(src_pixels + src_y * src.pitch()) + src_x;
+
+		if (over) {
+			BitmapBlit::OverRow(dst_row, src_row, dst_rect.width, opacity_value, format.a.shift, flip_x);
+		} else {
+			BitmapBlit::CopyRow(dst_row, src_row, dst_rect.width, flip_x);
+		}
+	}
+
+	return true;
+}
+
 void Bitmap::Blit(int x, int y, Bitmap const& src, Rect const& src_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
+	if (BlitKernel(x, y, src, src_rect, false, false, opacity, blend_mode)) {
+		return;
+	}
+
 	auto mask = CreateMask(opacity, src_rect);
 
 	pixman_image_composite32(src.GetOperator(mask.get(), blend_mode),
@@ -626,6 +715,10 @@ void Bitmap::BlitFast(int x, int y, Bitmap const & src, Rect const & src_rect, O
 		return;
 	}
 
+	if (BlitKernel(x, y, src, src_rect, false, false, Opacity::Opaque(), BlendMode::NormalWithoutAlpha)) {
+		return;
+	}
+
 	pixman_image_composite32(PIXMAN_OP_SRC,
 		src.bitmap.get(),
 		nullptr, bitmap.get(),
@@ -1016,7 +1109,7 @@ void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, co
 		return;
 	}
 
-	if (&src != this)
+	if (&src != this && !BlitKernel(x, y, src, src_rect, false, false, Opacity::Opaque(), BlendMode::Default))
 		pixman_image_composite32(src.GetOperator(),
 								 src.bitmap.get(), nullptr, bitmap.get(),
 								 src_rect.x, src_rect.y,
@@ -1025,6 +1118,32 @@ void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, co
 								 src_rect.width, src_rect.height);
 
 	pixman_color_t tcolor = PixmanColor(color);
+
+	if (BitmapBlit::IsEnabled() && &src != this && src.pixman_format == pixman_format && BitmapBlit::IsFormatSupported(format)
+		&& src_rect.x >= 0 && src_rect.y >= 0 && src_rect.x + src_rect.width <= src.width() && src_rect.y + src_rect.height <= src.height()) {
+		// Same conversion as pixman does for solid fills
+		uint32_t pcolor = format.r.pack(tcolor.red >> 8) | format.g.pack(tcolor.green >> 8)
+			| format.b.pack(tcolor.blue >> 8) | format.a.pack(tcolor.alpha >> 8);
+
+		Rect dst_rect(x, y, src_rect.width, src_rect.height);
+		dst_rect.Adjust(GetRect());
+		if (dst_rect.IsEmpty()) {
+			return;
+		}
+
+		auto* dst_pixels = static_cast<uint8_t*>(pixels());
+		auto* src_pixels = static_cast<const uint8_t*>(src.pixels());
+
+		for (int i = 0; i < dst_rect.height; ++i) {
+			auto* dst_row = reinterpret_cast<uint32_t*>(dst_pixels + (dst_rect.y + i) * pitch()) + dst_rect.x;
+			auto* mask_row = reinterpret_cast<const uint32_t*>(src_pixels + (src_rect.y + dst_rect.y - y + i) * src.pitch())
+				+ src_rect.x + dst_rect.x - x;
+
+			BitmapBlit::OverColorRow(dst_row, mask_row, dst_rect.width, pcolor, format.a.shift);
+		}
+		return;
+	}
+
 	auto timage = PixmanImagePtr{ pixman_image_create_solid_fill(&tcolor) };
 
 	pixman_image_composite32(PIXMAN_OP_OVER,
@@ -1040,6 +1159,10 @@ void Bitmap::FlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect, boo
 		return;
 	}
 
+	if (BlitKernel(x, y, src, src_rect, horizontal, vertical, opacity, blend_mode)) {
+		return;
+	}
+
 	bool has_xform = (horizontal || vertical);
 	const auto img_w = src.GetWidth();
 	const auto img_h = src.GetHeight();
@@ -1056,7 +1179,16 @@ void Bitmap::FlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect, boo
 		rect = Rect{ src_x, src_y, src_rect.width, src_rect.height };
 	}
 
-	Blit(x, y, src, rect, opacity, blend_mode);
+	// Not Blit: The kernels do not know about the transformation
+	auto mask = CreateMask(opacity, rect);
+
+	pixman_image_composite32(src.GetOperator(mask.get(), blend_mode),
+							 src.bitmap.get(),
+							 mask.get(), bitmap.get(),
+							 rect.x, rect.y,
+							 0, 0,
+							 x, y,
+							 rect.width, rect.height);
 
 	if (has_xform) {
 		pixman_image_set_transform(src.bitmap.get(), nullptr);
@@ -621,6 +621,22 @@ protected:
 	void ConvertImage(int& width, int& height, void*& pixels, bool transparent);
 
 	static PixmanImagePtr GetSubimage(Bitmap const& src, const Rect& src_rect);
+
+	/**
+	 * Blits with the BitmapBlit kernels when the operation is supported by them.
+	 *
+	 * @param x x position.
+	 * @param y y position.
+	 * @param src source bitmap.
+	 * @param src_rect source bitmap rect.
+	 * @param flip_x flip horizontally.
+	 * @param flip_y flip vertically.
+	 * @param opacity opacity for blending with bitmap.
+	 * @param blend_mode Blend mode to use.
+	 * @return true when the blit was done, false when pixman must be used
+	 */
+	bool BlitKernel(int x, int y, Bitmap const& src, Rect const& src_rect, bool flip_x, bool flip_y,
+		Opacity const& opacity, BlendMode blend_mode);
 	static inline void MultiplyAlpha(uint8_t &r, uint8_t &g, uint8_t &b, const uint8_t &a) {
 		r = (uint8_t)((int)r * a / 0xFF);
 		g = (uint8_t)((int)g * a / 0xFF);
@@ -0,0 +1,211 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <cstring>
+#include "bitmap_blit.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define EP_BITMAP_BLIT_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace {
+	bool enabled = true;
+
+	// Same rounding as the pixman combiners: x * a / 255
+	inline uint32_t MulUn8(uint32_t x, uint32_t a) {
+		uint32_t t = x * a + 0x80;
+		return (t + (t >> 8)) >> 8;
+	}
+
+	inline uint32_t MulPixel(uint32_t pix, uint32_t a) {
+		return MulUn8(pix & 0xFF, a)
+			| (MulUn8((pix >> 8) & 0xFF, a) << 8)
+			| (MulUn8((pix >> 16) & 0xFF, a) << 16)
+			| (MulUn8(pix >> 24, a) << 24);
+	}
+
+	inline uint32_t AddSaturate(uint32_t x, uint32_t y) {
+		uint32_t res = 0;
+		for (int shift = 0; shift < 32; shift += 8) {
+			uint32_t c = ((x >> shift) & 0xFF) + ((y >> shift) & 0xFF);
+			res |= (c > 0xFF ? 0xFF : c) << shift;
+		}
+		return res;
+	}
+
+	template <int AS>
+	inline uint32_t Over(uint32_t src, uint32_t dst) {
+		uint32_t ia = 0xFF - ((src >> AS) & 0xFF);
+		return AddSaturate(src, MulPixel(dst, ia));
+	}
+
+#ifdef EP_BITMAP_BLIT_SSE2
+	/** Broadcasts the alpha of both pixels in a 16 bit lane register */
+	template <int AS>
+	inline __m128i AlphaLanes(__m128i pix16) {
+		constexpr int lane = AS / 8;
+		pix16 = _mm_shufflelo_epi16(pix16, _MM_SHUFFLE(lane, lane, lane, lane));
+		return _mm_shufflehi_epi16(pix16, _MM_SHUFFLE(lane, lane, lane, lane));
+	}
+
+	inline __m128i Mul16(__m128i x, __m128i a) {
+		__m128i t = _mm_add_epi16(_mm_mullo_epi16(x, a), _mm_set1_epi16(0x80));
+		return _mm_mulhi_epu16(t, _mm_set1_epi16(0x101));
+	}
+
+	/** OVER of two pixels unpacked to 16 bit lanes, returns the new destination */
+	template <int AS>
+	inline __m128i Over16(__m128i src16, __m128i dst16) {
+		__m128i ia = _mm_xor_si128(AlphaLanes<AS>(src16), _mm_set1_epi16(0xFF));
+		return Mul16(dst16, ia);
+	}
+
+	template <bool reverse>
+	inline __m128i Load4(const uint32_t* src, int i) {
+		if (reverse) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src - i - 3));
+			return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+		}
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+	}
+#endif
+
+	template <bool reverse>
+	inline uint32_t Load(const uint32_t* src, int i) {
+		return reverse ? src[-i] : src[i];
+	}
+
+	template <int AS, bool reverse>
+	void OverRowT(uint32_t* dst, const uint32_t* src, int n, int opacity) {
+		int i = 0;
+#ifdef EP_BITMAP_BLIT_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i op16 = _mm_set1_epi16(static_cast<short>(opacity));
+
+		for (; i + 4 <= n; i += 4) {
+			__m128i s = Load4<reverse>(src, i);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xFFFF) {
+				// Fully transparent
+				continue;
+			}
+
+			__m128i slo = _mm_unpacklo_epi8(s, zero);
+			__m128i shi = _mm_unpackhi_epi8(s, zero);
+			if (opacity < 255) {
+				slo = Mul16(slo, op16);
+				shi = Mul16(shi, op16);
+			}
+
+			__m128i* d = reinterpret_cast<__m128i*>(dst + i);
+			__m128i dv = _mm_loadu_si128(d);
+			__m128i dlo = Over16<AS>(slo, _mm_unpacklo_epi8(dv, zero));
+			__m128i dhi = Over16<AS>(shi, _mm_unpackhi_epi8(dv, zero));
+
+			_mm_storeu_si128(d, _mm_adds_epu8(_mm_packus_epi16(slo, shi), _mm_packus_epi16(dlo, dhi)));
+		}
+#endif
+		for (; i < n; ++i) {
+			uint32_t s = Load<reverse>(src, i);
+			if (s == 0) {
+				continue;
+			}
+			if (opacity < 255) {
+				s = MulPixel(s, opacity);
+			}
+			dst[i] = Over<AS>(s, dst[i]);
+		}
+	}
+
+	template <int AS>
+	void OverColorRowT(uint32_t* dst, const uint32_t* mask, int n, uint32_t color) {
+		int i = 0;
+#ifdef EP_BITMAP_BLIT_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+
+		for (; i + 4 <= n; i += 4) {
+			__m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+			__m128i slo = Mul16(color16, AlphaLanes<AS>(_mm_unpacklo_epi8(m, zero)));
+			__m128i shi = Mul16(color16, AlphaLanes<AS>(_mm_unpackhi_epi8(m, zero)));
+
+			__m128i* d = reinterpret_cast<__m128i*>(dst + i);
+			__m128i dv = _mm_loadu_si128(d);
+			__m128i dlo = Over16<AS>(slo, _mm_unpacklo_epi8(dv, zero));
+			__m128i dhi = Over16<AS>(shi, _mm_unpackhi_epi8(dv, zero));
+
+			_mm_storeu_si128(d, _mm_adds_epu8(_mm_packus_epi16(slo, shi), _mm_packus_epi16(dlo, dhi)));
+		}
+#endif
+		for (; i < n; ++i) {
+			uint32_t a = (mask[i] >> AS) & 0xFF;
+			if (a == 0) {
+				continue;
+			}
+			dst[i] = Over<AS>(MulPixel(color, a), dst[i]);
+		}
+	}
+} // anonymous namespace
+
+bool BitmapBlit::IsEnabled() {
+	return enabled;
+}
+
+void BitmapBlit::SetEnabled(bool nenabled) {
+	enabled = nenabled;
+}
+
+bool BitmapBlit::IsFormatSupported(const DynamicFormat& format) {
+	return format.bits == 32
+		&& format.alpha_type == PF::Alpha
+		&& format.r.bits == 8 && format.g.bits == 8 && format.b.bits == 8 && format.a.bits == 8
+		&& (format.a.shift == 0 || format.a.shift == 24);
+}
+
+void BitmapBlit::CopyRow(uint32_t* dst, const uint32_t* src, int n, bool reverse) {
+	if (!reverse) {
+		memcpy(dst, src, n * sizeof(uint32_t));
+		return;
+	}
+
+	int i = 0;
+#ifdef EP_BITMAP_BLIT_SSE2
+	for (; i + 4 <= n; i += 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Load4<true>(src, i));
+	}
+#endif
+	for (; i < n; ++i) {
+		dst[i] = src[-i];
+	}
+}
+
+void BitmapBlit::OverRow(uint32_t* dst, const uint32_t* src, int n, int opacity, int alpha_shift, bool reverse) {
+	if (alpha_shift == 24) {
+		reverse ? OverRowT<24, true>(dst, src, n, opacity) : OverRowT<24, false>(dst, src, n, opacity);
+	} else {
+		reverse ? OverRowT<0, true>(dst, src, n, opacity) : OverRowT<0, false>(dst, src, n, opacity);
+	}
+}
+
+void BitmapBlit::OverColorRow(uint32_t* dst, const uint32_t* mask, int n, uint32_t color, int alpha_shift) {
+	if (alpha_shift == 24) {
+		OverColorRowT<24>(dst, mask, n, color);
+	} else {
+		OverColorRowT<0>(dst, mask, n, color);
+	}
+}
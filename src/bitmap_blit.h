@@ -0,0 +1,86 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_BITMAP_BLIT_H
+#define EP_BITMAP_BLIT_H
+
+// Headers
+#include <cstdint>
+#include "pixel_format.h"
+
+/**
+ * Blit kernels for 32 bit premultiplied pixels with an 8 bit alpha channel.
+ *
+ * Bitmap uses them instead of pixman for the most common blits: Copying
+ * and OVER with a constant opacity between bitmaps of the same format.
+ * The rounding matches the pixman combiners, the output is identical.
+ * When SSE2 is available four pixels are processed at once.
+ */
+namespace BitmapBlit {
+	/** @return Whether the kernels are used by Bitmap */
+	bool IsEnabled();
+
+	/**
+	 * Enables or disables the kernels. When disabled all blits use pixman.
+	 * Used by the benchmarks to compare both implementations.
+	 *
+	 * @param enabled new state
+	 */
+	void SetEnabled(bool enabled);
+
+	/**
+	 * @param format pixel format
+	 * @return Whether the kernels can operate on the format
+	 */
+	bool IsFormatSupported(const DynamicFormat& format);
+
+	/**
+	 * Copies a row of pixels (PIXMAN_OP_SRC).
+	 *
+	 * @param dst destination pixels
+	 * @param src source pixels. When reverse is set the last pixel to read.
+	 * @param n number of pixels
+	 * @param reverse read the source from right to left (horizontal flip)
+	 */
+	void CopyRow(uint32_t* dst, const uint32_t* src, int n, bool reverse);
+
+	/**
+	 * Composites a row of pixels with a constant opacity (PIXMAN_OP_OVER).
+	 *
+	 * @param dst destination pixels
+	 * @param src source pixels. When reverse is set the last pixel to read.
+	 * @param n number of pixels
+	 * @param opacity opacity between 0 and 255
+	 * @param alpha_shift shift of the alpha channel, 0 or 24
+	 * @param reverse read the source from right to left (horizontal flip)
+	 */
+	void OverRow(uint32_t* dst, const uint32_t* src, int n, int opacity, int alpha_shift, bool reverse);
+
+	/**
+	 * Composites a solid color through the alpha channel of a mask row
+	 * (PIXMAN_OP_OVER with solid source).
+	 *
+	 * @param dst destination pixels
+	 * @param mask mask pixels, only the alpha channel is used
+	 * @param n number of pixels
+	 * @param color premultiplied color in the pixel format
+	 * @param alpha_shift shift of the alpha channel, 0 or 24
+	 */
+	void OverColorRow(uint32_t* dst, const uint32_t* mask, int n, uint32_t color, int alpha_shift);
+}
+
+#endif
@@ -20,8 +20,10 @@
 #  pragma warning(disable: 4003)
 #endif
 
+#include <algorithm>
 #include <map>
 #include <tuple>
+#include <functional>
 #include <chrono>
 #include <cassert>
 
@@ -81,9 +83,45 @@ namespace {
 	using tile_key_type = std::string;
 	std::unordered_map<tile_key_type, std::weak_ptr<Bitmap>> cache_tiles;
 
-	// rect, flip_x, flip_y, tone, blend
+	// bitmap, rect, flip_x, flip_y, tone, blend
 	using effect_key_type = std::tuple<Bitmap*, Rect, bool, bool, Tone, Color>;
-	std::map<effect_key_type, std::weak_ptr<Bitmap>> cache_effects;
+
+	struct EffectKeyHash {
+		size_t operator()(const effect_key_type& key) const {
+			const auto& rect = std::get<1>(key);
+			const auto& tone = std::get<4>(key);
+			const auto& blend = std::get<5>(key);
+
+			size_t h = std::hash<Bitmap*>()(std::get<0>(key));
+			auto combine = [&h](uint32_t v) {
+				h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);
+			};
+			combine(static_cast<uint32_t>(rect.x) ^ (static_cast<uint32_t>(rect.y) << 16));
+			combine(static_cast<uint32_t>(rect.width) ^ (static_cast<uint32_t>(rect.height) << 16));
+			combine(std::get<2>(key) | (std::get<3>(key) << 1));
+			combine(static_cast<uint32_t>(tone.red) ^ (static_cast<uint32_t>(tone.green) << 8)
+				^ (static_cast<uint32_t>(tone.blue) << 16) ^ (static_cast<uint32_t>(tone.gray) << 24));
+			combine(blend.red | (blend.green << 8) | (blend.blue << 16) | (static_cast<uint32_t>(blend.alpha) << 24));
+			return h;
+		}
+	};
+
+	struct EffectItem {
+		/** Source bitmap, detects when the pointer in the key was reused by a different bitmap */
+		std::weak_ptr<Bitmap> src;
+		BitmapRef bitmap;
+		Game_Clock::time_point last_access;
+	};
+
+	std::unordered_map<effect_key_type, EffectItem, EffectKeyHash> cache_effects;
+
+	constexpr int effect_cache_limit = 4 * 1024 * 1024;
+	size_t effect_cache_size = 0;
+	/** Size after the last full sweep, the next one waits until an eighth of the limit was added */
+	size_t effect_cache_swept_size = 0;
+	size_t effect_cache_bucket = 0;
+	uint64_t effect_cache_hits = 0;
+	uint64_t effect_cache_misses = 0;
 
 	std::string system_name;
 
@@ -129,6 +167,80 @@ namespace {
 #endif
 	}
 
+	bool IsEffectUnused(const EffectItem& item, Game_Clock::time_point cur_ticks, bool cache_exhausted) {
+		if (item.src.expired()) {
+			return true;
+		}
+
+		if (item.bitmap.use_count() != 1) {
+			// Bitmap is referenced by a sprite
+			return false;
+		}
+
+		// Same limits as the bitmap cache
+		auto last_access = cur_ticks - item.last_access;
+		return cache_exhausted ? last_access > 50ms : last_access > 3s;
+	}
+
+	void EraseEffect(decltype(cache_effects)::const_iterator it) {
+		effect_cache_size -= it->second.bitmap->GetSize();
+		cache_effects.erase(it);
+	}
+
+	/** Checks the next bucket of the effect cache for unused entries */
+	void FreeEffectMemoryIncremental() {
+		if (cache_effects.bucket_count() == 0) {
+			return;
+		}
+
+		effect_cache_bucket = (effect_cache_bucket + 1) % cache_effects.bucket_count();
+
+		auto cur_ticks = Game_Clock::GetFrameTime();
+		bool cache_exhausted = effect_cache_size > effect_cache_limit;
+
+		std::vector<effect_key_type> unused;
+		for (auto it = cache_effects.begin(effect_cache_bucket); it != cache_effects.end(effect_cache_bucket); ++it) {
+			if (IsEffectUnused(it->second, cur_ticks, cache_exhausted)) {
+				unused.push_back(it->first);
+			}
+		}
+
+		for (auto& key: unused) {
+			EraseEffect(cache_effects.find(key));
+		}
+	}
+
+	/** Sweeps the whole effect cache when it exceeds the memory limit */
+	void FreeEffectMemory() {
+		// Entries freed since then count against the next sweep
+		effect_cache_swept_size = std::min(effect_cache_swept_size, effect_cache_size);
+
+		if (effect_cache_size <= effect_cache_limit ||
+				effect_cache_size < effect_cache_swept_size + effect_cache_limit / 8) {
+			// Below the limit or the last sweep could not free enough memory
+			return;
+		}
+
+		auto cur_ticks = Game_Clock::GetFrameTime();
+
+		for (auto it = cache_effects.begin(); it != cache_effects.end();) {
+			if (IsEffectUnused(it->second, cur_ticks, true)) {
+				effect_cache_size -= it->second.bitmap->GetSize();
+				it = cache_effects.erase(it);
+			} else {
+				++it;
+			}
+		}
+
+		effect_cache_swept_size = effect_cache_size;
+
+#ifdef CACHE_DEBUG
+		auto stats = Cache::GetSpriteEffectStats();
+		Output::Debug("Effect cache: {} entries, {} KiB, {} hits, {} misses",
+				stats.entries, stats.size / 1024, stats.hits, stats.misses);
+#endif
+	}
+
 	BitmapRef AddToCache(const std::string& key, BitmapRef bmp) {
 		if (bmp) {
 			cache_size += bmp->GetSize();
@@ -462,48 +574,74 @@ BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, boo
 		blend
 	};
 
-	const auto it = cache_effects.find(key);
+	auto it = cache_effects.find(key);
 
-	if (it == cache_effects.end() || it->second.expired()) {
-		BitmapRef bitmap_effects;
+	if (it != cache_effects.end()) {
+		auto& item = it->second;
+		if (!item.src.owner_before(src_bitmap) && !src_bitmap.owner_before(item.src)) {
+			++effect_cache_hits;
+			item.last_access = Game_Clock::GetFrameTime();
+			return item.bitmap;
+		}
 
-		auto create = [&rect] () -> BitmapRef {
-			return Bitmap::Create(rect.width, rect.height, true);
-		};
+		// The source bitmap was freed and its address reused
+		EraseEffect(it);
+	}
+
+	++effect_cache_misses;
+
+	BitmapRef bitmap_effects;
+
+	auto create = [&rect] () -> BitmapRef {
+		return Bitmap::Create(rect.width, rect.height, true);
+	};
 
-		if (tone != Tone()) {
+	if (tone != Tone()) {
+		bitmap_effects = create();
+		bitmap_effects->ToneBlit(0, 0, *src_bitmap, rect, tone, Opacity::Opaque());
+	}
+
+	if (blend != Color()) {
+		if (bitmap_effects) {
+			// Tone blit was applied
+			bitmap_effects->BlendBlit(0, 0, *bitmap_effects, bitmap_effects->GetRect(), blend, Opacity::Opaque());
+		} else {
 			bitmap_effects = create();
-			bitmap_effects->ToneBlit(0, 0, *src_bitmap, rect, tone, Opacity::Opaque());
+			bitmap_effects->BlendBlit(0, 0, *src_bitmap, rect, blend, Opacity::Opaque());
 		}
+	}
 
-		if (blend != Color()) {
-			if (bitmap_effects) {
-				// Tone blit was applied
-				bitmap_effects->BlendBlit(0, 0, *bitmap_effects, bitmap_effects->GetRect(), blend, Opacity::Opaque());
-			} else {
-				bitmap_effects = create();
-				bitmap_effects->BlendBlit(0, 0, *src_bitmap, rect, blend, Opacity::Opaque());
-			}
+	if (flip_x || flip_y) {
+		if (bitmap_effects) {
+			// Tone or blend blit was applied
+			bitmap_effects->Flip(flip_x, flip_y);
+		} else {
+			bitmap_effects = create();
+			bitmap_effects->FlipBlit(0, 0, *src_bitmap, rect, flip_x, flip_y, Opacity::Opaque());
 		}
+	}
 
-		if (flip_x || flip_y) {
-			if (bitmap_effects) {
-				// Tone or blend blit was applied
-				bitmap_effects->Flip(flip_x, flip_y);
-			} else {
-				bitmap_effects = create();
-				bitmap_effects->FlipBlit(0, 0, *src_bitmap, rect, flip_x, flip_y, Opacity::Opaque());
-			}
-		}
+	assert(bitmap_effects && "Effect cache used but no effect applied!");
 
-		assert(bitmap_effects && "Effect cache used but no effect applied!");
+	FreeEffectMemoryIncremental();
 
-		return(cache_effects[key] = bitmap_effects).lock();
-	} else { return it->second.lock(); }
+	effect_cache_size += bitmap_effects->GetSize();
+	FreeEffectMemory();
+
+	cache_effects[key] = { src_bitmap, bitmap_effects, Game_Clock::GetFrameTime() };
+	return bitmap_effects;
+}
+
+Cache::SpriteEffectStats Cache::GetSpriteEffectStats() {
+	return { cache_effects.size(), effect_cache_size, effect_cache_hits, effect_cache_misses };
 }
 
 void Cache::Clear() {
 	cache_effects.clear();
+	effect_cache_size = 0;
+	effect_cache_swept_size = 0;
+	effect_cache_hits = 0;
+	effect_cache_misses = 0;
 	cache.clear();
 	cache_size = 0;
 
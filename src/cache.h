@@ -58,6 +58,21 @@ namespace Cache {
 	BitmapRef Tile(StringView filename, int tile_id);
 	BitmapRef SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend);
 
+	/** Usage statistics of the sprite effect cache */
+	struct SpriteEffectStats {
+		/** Number of cached effect bitmaps */
+		size_t entries = 0;
+		/** Memory used by the cached effect bitmaps in bytes */
+		size_t size = 0;
+		/** Lookups that returned a cached bitmap */
+		uint64_t hits = 0;
+		/** Lookups that created a new bitmap */
+		uint64_t misses = 0;
+	};
+
+	/** @return usage statistics of the sprite effect cache since the last Clear */
+	SpriteEffectStats GetSpriteEffectStats();
+
 	void Clear();
 	void ClearAll();
 
@@ -22,6 +22,7 @@
 // Headers
 #include <cstdio>
 #include <cassert>
+#include "audio.h"
 #include "audio_decoder.h"
 #include "output.h"
 #include "decoder_fmmidi.h"
@@ -29,6 +30,7 @@
 FmMidiDecoder::FmMidiDecoder() {
 	note_factory.reset(new midisynth::fm_note_factory());
 	synth.reset(new midisynth::synthesizer(note_factory.get()));
+	synth->set_render_threads(Audio().GetFmMidiThreads());
 
 	load_programs();
 }
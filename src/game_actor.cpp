@@ -135,6 +135,7 @@ void Game_Actor::SetSaveData(lcf::rpg::SaveActor save) {
 	}
 
 	data = std::move(save);
+	InvalidateStatCache();
 
 	if (Player::IsRPG2k()) {
 		data.two_weapon = dbActor->two_weapon;
@@ -1343,6 +1344,7 @@ void Game_Actor::RemoveInvalidData() {
 	if (GetStates().size() > lcf::Data::states.size()) {
 		Output::Warning("Actor {}: State array contains invalid states ({} > {})", GetId(), GetStates().size(), lcf::Data::states.size());
 		GetStates().resize(lcf::Data::states.size());
+		InvalidateStatCache();
 	}
 
 	// Remove invalid levels
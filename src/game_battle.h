@@ -179,6 +179,8 @@ namespace Game_Battle {
 		int terrain_id = 0;
 		lcf::rpg::System::BattleFormation formation = lcf::rpg::System::BattleFormation_terrain;
 		lcf::rpg::System::BattleCondition condition = lcf::rpg::System::BattleCondition_none;
+		/** When > 0 the battles are simulated headless, see BattleSimulator */
+		int simulate_battles = 0;
 	};
 
 	extern struct BattleTest battle_test;
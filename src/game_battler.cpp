@@ -331,6 +331,7 @@ bool Game_Battler::AddState(int state_id, bool allow_battle_states) {
 	if (!was_added) {
 		return was_added;
 	}
+	InvalidateStatCache();
 
 	if (state_id == lcf::rpg::State::kDeathID) {
 		SetAtbGauge(0);
@@ -399,12 +400,14 @@ bool RemoveStates(Game_Battler& battler, F&& f) {
 
 void Game_Battler::RemoveBattleStates() {
 	RemoveStates(*this, [&]() {
+		InvalidateStatCache();
 		return State::RemoveAllBattle(GetStates(), GetPermanentStates());
 	});
 }
 
 void Game_Battler::RemoveAllStates() {
 	RemoveStates(*this, [&]() {
+		InvalidateStatCache();
 		return State::RemoveAll(GetStates(), GetPermanentStates());
 	});
 }
@@ -418,6 +421,7 @@ bool Game_Battler::RemoveState(int state_id, bool always_remove_battle_states) {
 			ps = GetPermanentStates();
 		}
 
+		InvalidateStatCache();
 		return State::Remove(state_id, GetStates(), ps);
 	});
 }
@@ -552,20 +556,62 @@ int Game_Battler::CalcValueAfterAgiStates(int value) const {
 	return AdjustParam(value, 0, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_agility);
 }
 
+uint32_t Game_Battler::stat_cache_revision = 1;
+bool Game_Battler::stat_cache_verify = false;
+int Game_Battler::stat_cache_mismatches = 0;
+
+void Game_Battler::InvalidateAllStatCaches() {
+	++stat_cache_revision;
+}
+
+void Game_Battler::SetStatCacheVerify(bool verify) {
+	stat_cache_verify = verify;
+	stat_cache_mismatches = 0;
+}
+
+int Game_Battler::GetStatCacheMismatches() {
+	return stat_cache_mismatches;
+}
+
+int Game_Battler::GetBattleStat(StatCacheIndex stat, Weapon weapon, int base, int mod, bool lcf::rpg::State::*adj) const {
+	const int index = GetStatCacheIndex(stat, weapon);
+	const int maxval = MaxStatBattleValue();
+
+	SyncStatCache();
+
+	auto& c = stat_cache;
+	const uint32_t bit = 1u << index;
+	if ((c.valid & bit) && c.base[index] == base && c.mod[index] == mod && c.max[index] == maxval) {
+		if (stat_cache_verify) {
+			const int value = AdjustParam(base, mod, maxval, GetInflictedStates(), adj);
+			stat_cache_mismatches += (value != c.value[index]);
+			return value;
+		}
+		return c.value[index];
+	}
+
+	c.value[index] = AdjustParam(base, mod, maxval, GetInflictedStates(), adj);
+	c.base[index] = base;
+	c.mod[index] = mod;
+	c.max[index] = maxval;
+	c.valid |= bit;
+	return c.value[index];
+}
+
 int Game_Battler::GetAtk(Weapon weapon) const {
-	return AdjustParam(GetBaseAtk(weapon), atk_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_attack);
+	return GetBattleStat(eStatAtk, weapon, GetBaseAtk(weapon), atk_modifier, &lcf::rpg::State::affect_attack);
 }
 
 int Game_Battler::GetDef(Weapon weapon) const {
-	return AdjustParam(GetBaseDef(weapon), def_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_defense);
+	return GetBattleStat(eStatDef, weapon, GetBaseDef(weapon), def_modifier, &lcf::rpg::State::affect_defense);
 }
 
 int Game_Battler::GetSpi(Weapon weapon) const {
-	return AdjustParam(GetBaseSpi(weapon), spi_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_spirit);
+	return GetBattleStat(eStatSpi, weapon, GetBaseSpi(weapon), spi_modifier, &lcf::rpg::State::affect_spirit);
 }
 
 int Game_Battler::GetAgi(Weapon weapon) const {
-	return AdjustParam(GetBaseAgi(weapon), agi_modifier, MaxStatBattleValue(), GetInflictedStates(), &lcf::rpg::State::affect_agility);
+	return GetBattleStat(eStatAgi, weapon, GetBaseAgi(weapon), agi_modifier, &lcf::rpg::State::affect_agility);
 }
 
 int Game_Battler::GetDisplayX() const {
@@ -19,6 +19,8 @@
 #define EP_GAME_BATTLER_H
 
 // Headers
+#include <array>
+#include <cassert>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -428,6 +430,23 @@ public:
 	 */
 	virtual int GetBaseAgi(Weapon weapon = WeaponAll) const = 0;
 
+	/**
+	 * Drops the cached stats of all battlers.
+	 * Must be called when the state database changes.
+	 */
+	static void InvalidateAllStatCaches();
+
+	/**
+	 * Recompute every cached stat on access and compare it with the cached
+	 * value. The recomputed value is returned. Used by the unit tests.
+	 *
+	 * @param verify whether to verify
+	 */
+	static void SetStatCacheVerify(bool verify);
+
+	/** @return number of outdated cached stats found by the verification */
+	static int GetStatCacheMismatches();
+
 	/** @return whether the battler is facing the opposite it's normal direction */
 	bool IsDirectionFlipped() const;
 
@@ -928,6 +947,25 @@ public:
 	const std::vector<lcf::rpg::State*> GetInflictedStatesOrderedByPriority() const;
 
 protected:
+	enum StatCacheIndex {
+		/** The stats have one entry per Weapon value */
+		eStatAtk,
+		eStatDef = eStatAtk + 4,
+		eStatSpi = eStatDef + 4,
+		eStatAgi = eStatSpi + 4,
+		eStatCount = eStatAgi + 4
+	};
+
+	/**
+	 * @param stat weapon stat
+	 * @param weapon weapon
+	 * @return cache index of the stat for the weapon
+	 */
+	static int GetStatCacheIndex(StatCacheIndex stat, Weapon weapon);
+
+	/** Drops the cached stats of this battler, must be called when the inflicted states change */
+	void InvalidateStatCache() const;
+
 	/** Gauge for RPG2k3 Battle */
 	int gauge = 0;
 
@@ -970,8 +1008,50 @@ protected:
 		double current_level = 0.0;
 	};
 	FlashData flash;
+
+	/**
+	 * Stats are requested many times per frame by windows, damage formulas
+	 * and the interpreter. Applying the inflicted states is cached.
+	 * An entry is only used while base, modifier and limit are unchanged,
+	 * so level, equipment and database changes of the base stat need no
+	 * invalidation, only state changes do.
+	 */
+	struct StatCache {
+		/** Global revision the entries belong to */
+		uint32_t revision = 0;
+		/** Valid entries, one bit per index */
+		uint32_t valid = 0;
+		std::array<int, eStatCount> value = {};
+		std::array<int, eStatCount> base = {};
+		std::array<int, eStatCount> mod = {};
+		std::array<int, eStatCount> max = {};
+	};
+	mutable StatCache stat_cache;
+
+	static uint32_t stat_cache_revision;
+	static bool stat_cache_verify;
+	static int stat_cache_mismatches;
+
+	int GetBattleStat(StatCacheIndex stat, Weapon weapon, int base, int mod, bool lcf::rpg::State::*adj) const;
+	void SyncStatCache() const;
 };
 
+inline int Game_Battler::GetStatCacheIndex(StatCacheIndex stat, Weapon weapon) {
+	assert(weapon >= WeaponAll && weapon <= WeaponSecondary);
+	return stat + (weapon - WeaponAll);
+}
+
+inline void Game_Battler::SyncStatCache() const {
+	if (stat_cache.revision != stat_cache_revision) {
+		stat_cache.revision = stat_cache_revision;
+		stat_cache.valid = 0;
+	}
+}
+
+inline void Game_Battler::InvalidateStatCache() const {
+	stat_cache.valid = 0;
+}
+
 inline Color Game_Battler::GetFlashColor() const {
 	return Flash::MakeColor(flash.red, flash.green, flash.blue, flash.current_level);
 }
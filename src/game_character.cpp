@@ -138,10 +138,7 @@ void Game_Character::Update() {
 	UpdateFlash();
 
 	if (IsStopping()) {
-		if (GetStopCount() == 0 || IsMoveRouteOverwritten() ||
-				((Main_Data::game_system->GetMessageContinueEvents() || !Game_Map::GetInterpreter().IsRunning()) && !IsPaused())) {
-			SetStopCount(GetStopCount() + 1);
-		}
+		UpdateStopCount();
 	} else if (IsJumping()) {
 		static const int jump_speed[] = {8, 12, 16, 24, 32, 64};
 		auto amount = jump_speed[GetMoveSpeed() -1 ];
@@ -154,6 +151,13 @@ void Game_Character::Update() {
 	this->UpdateAnimation();
 }
 
+void Game_Character::UpdateStopCount() {
+	if (GetStopCount() == 0 || IsMoveRouteOverwritten() ||
+			((Main_Data::game_system->GetMessageContinueEvents() || !Game_Map::GetInterpreter().IsRunning()) && !IsPaused())) {
+		SetStopCount(GetStopCount() + 1);
+	}
+}
+
 void Game_Character::UpdateMovement(int amount) {
 	SetRemainingStep(GetRemainingStep() - amount);
 	if (GetRemainingStep() <= 0) {
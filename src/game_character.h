@@ -888,6 +888,7 @@ protected:
 	/** Check for and fix incorrect move route data after loading save game */
 	void SanitizeMoveRoute(StringView name, const lcf::rpg::MoveRoute& mr, int32_t& idx, StringView chunk_name);
 	void Update();
+	void UpdateStopCount();
 	virtual void UpdateAnimation();
 	virtual void UpdateNextMovementAction() = 0;
 	virtual void UpdateMovement(int amount);
@@ -0,0 +1,149 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cassert>
+#include "game_character_batch.h"
+#include "game_event.h"
+#include "flash.h"
+#include "utils.h"
+
+bool Game_CharacterBatch::CanUpdate(const Game_Event& ev) {
+	if (!ev.IsActive() || ev.IsProcessed() || ev.GetActivePage() == nullptr) {
+		return false;
+	}
+
+	// Parallel processes run the interpreter in Update
+	if (ev.GetTrigger() == lcf::rpg::EventPage::Trigger_parallel) {
+		return false;
+	}
+
+	// Only walking, jumping uses other step and animation rules
+	if (ev.IsStopping() || ev.IsJumping()) {
+		return false;
+	}
+
+	// The end of the last step of a forced move route finishes the route
+	const int amount = 1 << (1 + ev.GetMoveSpeed());
+	return !ev.IsMoveRouteOverwritten() || ev.GetRemainingStep() > amount;
+}
+
+void Game_CharacterBatch::Add(Game_Event& ev) {
+	assert(CanUpdate(ev));
+
+	ev.SetProcessed(true);
+
+	const auto idx = static_cast<uint32_t>(events.size());
+	events.push_back(&ev);
+
+	remaining_step.push_back(ev.GetRemainingStep());
+	step_amount.push_back(1 << (1 + ev.GetMoveSpeed()));
+
+	const auto speed = Utils::Clamp(ev.GetMoveSpeed(), 1, 6);
+	if (ev.IsSpinning()) {
+		anim_mode.push_back(eAnimSpin);
+		anim_limit.push_back(Game_Character::GetSpinAnimFrames(speed));
+	} else if (ev.IsAnimPaused()) {
+		anim_mode.push_back(ev.GetAnimationType() != lcf::rpg::EventPage::AnimType_fixed_graphic ? eAnimResetFrame : eAnimReset);
+		anim_limit.push_back(0);
+	} else if (!ev.IsAnimated()) {
+		anim_mode.push_back(eAnimStatic);
+		anim_limit.push_back(0);
+	} else {
+		// The stop count is 0 while walking, so the frame advances at the lower limit
+		anim_mode.push_back(eAnimStep);
+		anim_limit.push_back(std::min(Game_Character::GetStationaryAnimFrames(speed), Game_Character::GetContinuousAnimFrames(speed)));
+	}
+	anim_count.push_back(ev.GetAnimCount());
+	anim_frame.push_back(ev.GetAnimFrame());
+	facing.push_back(ev.GetFacing());
+
+	if (ev.GetFlashLevel() > 0) {
+		flashing.push_back(idx);
+		flash_level.push_back(ev.GetFlashLevel());
+		flash_time_left.push_back(ev.GetFlashTimeLeft());
+	}
+}
+
+void Game_CharacterBatch::Update() {
+	const size_t n = events.size();
+	if (n == 0) {
+		return;
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		remaining_step[i] = std::max(remaining_step[i] - step_amount[i], 0);
+	}
+
+	for (size_t k = 0; k < flashing.size(); ++k) {
+		Flash::Update(flash_level[k], flash_time_left[k]);
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		switch (anim_mode[i]) {
+			case eAnimStep:
+				if (++anim_count[i] >= anim_limit[i]) {
+					anim_frame[i] = (anim_frame[i] + 1) % 4;
+					anim_count[i] = 0;
+				}
+				break;
+			case eAnimSpin:
+				if (++anim_count[i] >= anim_limit[i]) {
+					facing[i] = (facing[i] + 1) % 4;
+					anim_count[i] = 0;
+				}
+				break;
+			case eAnimResetFrame:
+				anim_frame[i] = lcf::rpg::EventPage::Frame_middle;
+				anim_count[i] = 0;
+				break;
+			case eAnimReset:
+				anim_count[i] = 0;
+				break;
+			default:
+				break;
+		}
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		auto& ev = *events[i];
+		ev.SetRemainingStep(remaining_step[i]);
+		ev.SetStopCount(0);
+		ev.SetAnimCount(anim_count[i]);
+		ev.SetAnimFrame(anim_frame[i]);
+		ev.SetFacing(facing[i]);
+	}
+
+	for (size_t k = 0; k < flashing.size(); ++k) {
+		auto& ev = *events[flashing[k]];
+		ev.SetFlashLevel(flash_level[k]);
+		ev.SetFlashTimeLeft(flash_time_left[k]);
+	}
+
+	events.clear();
+	remaining_step.clear();
+	step_amount.clear();
+	anim_mode.clear();
+	anim_count.clear();
+	anim_limit.clear();
+	anim_frame.clear();
+	facing.clear();
+	flashing.clear();
+	flash_level.clear();
+	flash_time_left.clear();
+}
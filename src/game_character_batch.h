@@ -0,0 +1,86 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_GAME_CHARACTER_BATCH_H
+#define EP_GAME_CHARACTER_BATCH_H
+
+// Headers
+#include <cstdint>
+#include <vector>
+
+class Game_Event;
+
+/**
+ * Batch update of map events in the middle of a step.
+ *
+ * For such events Game_Character::Update only advances the step, the
+ * flash and the step animation. The batch gathers this state into
+ * contiguous arrays, advances all events in tight loops and writes the
+ * results back. The events of a batch do not interact with each other,
+ * the result is identical to updating them one by one.
+ */
+class Game_CharacterBatch {
+public:
+	/**
+	 * @param ev event to test
+	 * @return Whether the next Update of the event can run in a batch
+	 */
+	static bool CanUpdate(const Game_Event& ev);
+
+	/**
+	 * Adds an event to the batch.
+	 *
+	 * @param ev event, CanUpdate must be true
+	 */
+	void Add(Game_Event& ev);
+
+	/** Updates all added events and clears the batch */
+	void Update();
+
+	/** @return Whether no events are added */
+	bool IsEmpty() const;
+
+private:
+	enum AnimMode : uint8_t {
+		eAnimStatic,
+		eAnimStep,
+		eAnimSpin,
+		eAnimReset,
+		eAnimResetFrame
+	};
+
+	std::vector<Game_Event*> events;
+
+	std::vector<int32_t> remaining_step;
+	std::vector<int32_t> step_amount;
+
+	std::vector<uint8_t> anim_mode;
+	std::vector<int32_t> anim_count;
+	std::vector<int32_t> anim_limit;
+	std::vector<int32_t> anim_frame;
+	std::vector<int32_t> facing;
+
+	std::vector<uint32_t> flashing;
+	std::vector<double> flash_level;
+	std::vector<int32_t> flash_time_left;
+};
+
+inline bool Game_CharacterBatch::IsEmpty() const {
+	return events.empty();
+}
+
+#endif
@@ -448,10 +448,13 @@ void Game_Config::LoadFromStream(Filesystem_Stream::InputStream& is) {
 	/** AUDIO SECTION */
 	audio.music_volume.FromIni(ini);
 	audio.sound_volume.FromIni(ini);
+	audio.bgm_crossfade.FromIni(ini);
 	audio.fluidsynth_midi.FromIni(ini);
 	audio.wildmidi_midi.FromIni(ini);
 	audio.native_midi.FromIni(ini);
 	audio.soundfont.FromIni(ini);
+	audio.fmmidi_threads.FromIni(ini);
+	audio.se_cache_size.FromIni(ini);
 
 	/** INPUT SECTION */
 	input.buttons = Input::GetDefaultButtonMappings();
@@ -542,10 +545,13 @@ void Game_Config::WriteToStream(Filesystem_Stream::OutputStream& os) const {
 
 	audio.music_volume.ToIni(os);
 	audio.sound_volume.ToIni(os);
+	audio.bgm_crossfade.ToIni(os);
 	audio.fluidsynth_midi.ToIni(os);
 	audio.wildmidi_midi.ToIni(os);
 	audio.native_midi.ToIni(os);
 	audio.soundfont.ToIni(os);
+	audio.fmmidi_threads.ToIni(os);
+	audio.se_cache_size.ToIni(os);
 
 	os << "\n";
 
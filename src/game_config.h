@@ -128,11 +128,14 @@ struct Game_ConfigVideo {
 struct Game_ConfigAudio {
 	RangeConfigParam<int> music_volume{ "BGM Volume", "Volume of the background music", "Audio", "MusicVolume", 100, 0, 100 };
 	RangeConfigParam<int> sound_volume{ "SFX Volume", "Volume of the sound effects", "Audio", "SoundVolume", 100, 0, 100 };
+	RangeConfigParam<int> bgm_crossfade{ "BGM Crossfade", "Fade out the previous music while new music starts (ms)", "Audio", "BgmCrossfade", 0, 0, 5000 };
 	BoolConfigParam fluidsynth_midi { EP_FLUID_NAME " (SF2)", "Play MIDI using SF2 soundfonts", "Audio", "Fluidsynth", true };
 	BoolConfigParam wildmidi_midi { "WildMidi (GUS)", "Play MIDI using GUS patches", "Audio", "WildMidi", true };
 	BoolConfigParam native_midi { "Native MIDI", "Play MIDI through the operating system ", "Audio", "NativeMidi", true };
 	LockedConfigParam<std::string> fmmidi_midi { "FmMidi", "Play MIDI using the built-in MIDI synthesizer", "[Always ON]" };
 	PathConfigParam soundfont { "Soundfont", "Soundfont to use for " EP_FLUID_NAME, "Audio", "Soundfont", "" };
+	RangeConfigParam<int> fmmidi_threads{ "FmMidi Threads", "Threads rendering the channels of the built-in MIDI synthesizer", "Audio", "FmMidiThreads", 1, 1, 8 };
+	RangeConfigParam<int> se_cache_size{ "SE Cache Size", "Memory for decoded sound effects (MB)", "Audio", "SeCacheSize", 8, 1, 256 };
 
 	void Hide();
 };
@@ -632,6 +632,53 @@ AsyncOp Game_Event::Update(bool resume_async) {
 	return {};
 }
 
+Game_Event::UpdateClass Game_Event::GetUpdateClass() const {
+	if (!data()->active || page == nullptr) {
+		return UpdateClass::Inactive;
+	}
+
+	const auto trigger = GetTrigger();
+	if (trigger == lcf::rpg::EventPage::Trigger_parallel) {
+		return UpdateClass::Parallel;
+	}
+	if (trigger == lcf::rpg::EventPage::Trigger_auto_start || trigger == lcf::rpg::EventPage::Trigger_collision) {
+		return UpdateClass::Triggered;
+	}
+
+	if (!IsStopping() || IsMoveRouteOverwritten() || page->move_type != lcf::rpg::EventPage::MoveType_stationary) {
+		return UpdateClass::Moving;
+	}
+
+	if (GetFlashLevel() > 0 || IsSpinning() || IsAnimPaused() || GetStopCount() == 0) {
+		return UpdateClass::Animated;
+	}
+
+	if (IsAnimated()) {
+		// The step animation settles when the character stands still in the middle frame
+		const auto speed = Utils::Clamp(GetMoveSpeed(), 1, 6);
+		const auto anim_frame = GetAnimFrame();
+		if (IsContinuous()
+				|| anim_frame == lcf::rpg::EventPage::Frame_left || anim_frame == lcf::rpg::EventPage::Frame_right
+				|| GetAnimCount() < GetStationaryAnimFrames(speed) - 1
+				|| GetAnimCount() >= GetContinuousAnimFrames(speed)) {
+			return UpdateClass::Animated;
+		}
+	}
+
+	return UpdateClass::Idle;
+}
+
+void Game_Event::UpdateIdle() {
+	assert(GetUpdateClass() == UpdateClass::Idle);
+
+	if (IsProcessed()) {
+		return;
+	}
+	SetProcessed(true);
+
+	UpdateStopCount();
+}
+
 const lcf::rpg::EventPage* Game_Event::GetPage(int page) const {
 	if (page <= 0 || page - 1 >= static_cast<int>(event->pages.size())) {
 		return nullptr;
@@ -125,6 +125,31 @@ public:
 	 */
 	AsyncOp Update(bool resume_async);
 
+	/** What an Update of the event does in the current state */
+	enum class UpdateClass {
+		/** Not active or no page, Update does nothing */
+		Inactive,
+		/** Runs a parallel process */
+		Parallel,
+		/** Starts by itself (autostart or collision trigger) */
+		Triggered,
+		/** Walks, jumps, follows a move route or has a movement type */
+		Moving,
+		/** Flashes or advances the step animation */
+		Animated,
+		/** Only the stop counter changes */
+		Idle
+	};
+
+	/** @return the classification of the next Update */
+	UpdateClass GetUpdateClass() const;
+
+	/**
+	 * Update for events classified as Idle, equivalent to Update but
+	 * only maintains the processed flag and the stop counter.
+	 */
+	void UpdateIdle();
+
 	bool AreConditionsMet(const lcf::rpg::EventPage& page);
 
 	/**
@@ -67,12 +67,64 @@
 #include "transition.h"
 #include "baseui.h"
 #include "algo.h"
+#include "pathfinder.h"
 #include "rand.h"
 
 enum BranchSubcommand {
 	eOptionBranchElse = 1
 };
 
+/** Refreshes the map events which depend on variables changed by range operations */
+static void SetNeedRefreshForChangedVariables() {
+	int first_id, last_id;
+	if (Main_Data::game_variables->TakeChangedRange(first_id, last_id)) {
+		Game_Map::SetNeedRefreshForVarChange(first_id, last_id);
+	}
+}
+
+/**
+ * Preloads the pictures of the next Show Picture commands which use a
+ * fixed file name. Names depending on variables are resolved when the
+ * command executes and are not preloaded.
+ *
+ * @param list command list of the frame
+ * @param index first command to scan
+ */
+static void PreloadUpcomingPictures(const std::vector<lcf::rpg::EventCommand>& list, int index) {
+	constexpr int scan_limit = 32;
+	constexpr int picture_limit = 4;
+
+	if (!Main_Data::game_pictures) {
+		return;
+	}
+
+	int found = 0;
+	const int end = std::min(static_cast<int>(list.size()), index + scan_limit);
+	for (int i = index; i < end && found < picture_limit; ++i) {
+		const auto& com = list[i];
+		if (com.code != static_cast<uint32_t>(Game_Interpreter::Cmd::ShowPicture) || com.parameters.size() < 8) {
+			continue;
+		}
+		++found;
+
+		// Pic pointer patch substitutes the name with a variable
+		if (com.parameters[0] >= 50000) {
+			continue;
+		}
+
+		if (com.parameters.size() > 16 && (Player::IsRPG2k3ECommands() || Player::IsPatchManiac())) {
+			if (com.parameters[19] != 0) {
+				continue;
+			}
+			if (Player::IsPatchManiac() && com.parameters.size() > 30 && ((com.parameters[17] >> 8) & 0xF) != 0) {
+				continue;
+			}
+		}
+
+		Main_Data::game_pictures->Preload(com.string, com.parameters[7] > 0);
+	}
+}
+
 constexpr int Game_Interpreter::loop_limit;
 constexpr int Game_Interpreter::call_stack_limit;
 constexpr int Game_Interpreter::subcommand_sentinel;
@@ -129,6 +181,8 @@ void Game_Interpreter::Push(
 	}
 
 	_state.stack.push_back(std::move(frame));
+
+	PreloadUpcomingPictures(_state.stack.back().commands, 0);
 }
 
 
@@ -833,6 +887,8 @@ bool Game_Interpreter::ExecuteCommand(lcf::rpg::EventCommand const& com) {
 			return CommandManiacControlStrings(com);
 		case Cmd::Maniac_CallCommand:
 			return CommandManiacCallCommand(com);
+		case static_cast<Game_Interpreter::Cmd>(2051): //Cmd::EasyRpg_SmartMoveRoute
+			return CommandEasyRpgSmartMoveRoute(com);
 		case static_cast<Game_Interpreter::Cmd>(2053): //Cmd::EasyRpg_SetInterpreterFlag
 			return CommandEasyRpgSetInterpreterFlag(com);
 		default:
@@ -1083,7 +1139,7 @@ bool Game_Interpreter::CommandControlSwitches(lcf::rpg::EventCommand const& com)
 			} else {
 				Main_Data::game_switches->FlipRange(start, end);
 			}
-			Game_Map::SetNeedRefresh(true);
+			Game_Map::SetNeedRefreshForSwitchChange(start, end);
 		}
 	}
 
@@ -1387,7 +1443,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 					Main_Data::game_variables->BitShiftRightRangeVariable(start, end, var_id);
 					break;
 			}
-			Game_Map::SetNeedRefresh(true);
+			SetNeedRefreshForChangedVariables();
 		} else if (com.parameters[4] == 2) {
 			// Multiple variables - Indirect variable lookup
 			int var_id = com.parameters[5];
@@ -1426,7 +1482,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 					Main_Data::game_variables->BitShiftRightRangeVariableIndirect(start, end, var_id);
 					break;
 			}
-			Game_Map::SetNeedRefresh(true);
+			SetNeedRefreshForChangedVariables();
 		} else if (com.parameters[4] == 3) {
 			// Multiple variables - random
 			int rmax = max(com.parameters[5], com.parameters[6]);
@@ -1466,7 +1522,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 					Main_Data::game_variables->BitShiftRightRangeRandom(start, end, rmin, rmax);
 					break;
 			}
-			Game_Map::SetNeedRefresh(true);
+			SetNeedRefreshForChangedVariables();
 		} else {
 			// Multiple variables - constant
 			switch (operation) {
@@ -1504,7 +1560,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 					Main_Data::game_variables->BitShiftRightRange(start, end, value);
 					break;
 			}
-			Game_Map::SetNeedRefresh(true);
+			SetNeedRefreshForChangedVariables();
 		}
 	}
 
@@ -1641,17 +1697,10 @@ bool Game_Interpreter::CommandChangeItems(lcf::rpg::EventCommand const& com) { /
 		}
 	}
 
-	if (com.parameters[1] == 0) {
-		// Item by const number
-		Main_Data::game_party->AddItem(com.parameters[2], value);
-	} else {
-		// Item by variable
-		Main_Data::game_party->AddItem(
-			Main_Data::game_variables->Get(com.parameters[2]),
-			value
-		);
-	}
-	Game_Map::SetNeedRefresh(true);
+	// Item by const number or by variable
+	int item_id = com.parameters[1] == 0 ? com.parameters[2] : Main_Data::game_variables->Get(com.parameters[2]);
+	Main_Data::game_party->AddItem(item_id, value);
+	Game_Map::SetNeedRefreshForItemChange(item_id);
 	// Continue
 	return true;
 }
@@ -1677,7 +1726,13 @@ bool Game_Interpreter::CommandChangePartyMember(lcf::rpg::EventCommand const& co
 	}
 
 	CheckGameOver();
-	Game_Map::SetNeedRefresh(true);
+	Game_Map::SetNeedRefreshForActorChange(id);
+	// Item conditions include the items equipped by party members
+	for (int item_id : actor->GetWholeEquipment()) {
+		if (item_id > 0) {
+			Game_Map::SetNeedRefreshForItemChange(item_id);
+		}
+	}
 
 	// Continue
 	return true;
@@ -2037,7 +2092,7 @@ bool Game_Interpreter::CommandSimulatedAttack(lcf::rpg::EventCommand const& com)
 
 		if (com.parameters[6] != 0) {
 			Main_Data::game_variables->Set(com.parameters[7], result);
-			Game_Map::SetNeedRefresh(true);
+			Game_Map::SetNeedRefreshForVarChange(com.parameters[7]);
 		}
 	}
 
@@ -2925,6 +2980,9 @@ bool Game_Interpreter::CommandShowPicture(lcf::rpg::EventCommand const& com) { /
 	// RPG_RT will crash if you ask for a picture id greater than the limit that
 	// version of the engine allows. We allow an arbitrary number of pictures in Player.
 
+	const auto& frame = GetFrame();
+	PreloadUpcomingPictures(frame.commands, frame.current_command + 1);
+
 	if (Main_Data::game_pictures->Show(pic_id, params)) {
 		if (params.origin > 0) {
 			auto& pic = Main_Data::game_pictures->GetPicture(pic_id);
@@ -4591,7 +4649,7 @@ bool Game_Interpreter::CommandManiacControlVarArray(lcf::rpg::EventCommand const
 			Output::Warning("ManiacControlVarArray: Unknown operation {}", op);
 	}
 
-	Game_Map::SetNeedRefresh(true);
+	SetNeedRefreshForChangedVariables();
 
 	return true;
 }
@@ -5145,6 +5203,77 @@ bool Game_Interpreter::CommandEasyRpgSetInterpreterFlag(lcf::rpg::EventCommand c
 	return true;
 }
 
+bool Game_Interpreter::CommandEasyRpgSmartMoveRoute(lcf::rpg::EventCommand const& com) {
+	if (!Player::HasEasyRpgExtensions()) {
+		return true;
+	}
+
+	// Param0: Event ID
+	// Param1, 2: Destination X (0: Constant, 1: Variable)
+	// Param3, 4: Destination Y (0: Constant, 1: Variable)
+	// Param5: Move frequency
+	// Param6: Flags (1: Events block the way, 2: Diagonal steps, 4: Skippable route)
+	// Param7: Search limit in tiles (0: Default)
+	// Param8: Variable receiving the number of steps or -1 when the destination is not reachable (0: None)
+	if (com.parameters.size() < 7) {
+		return true;
+	}
+
+	int event_id = com.parameters[0];
+	Game_Character* event = GetCharacter(event_id);
+	if (!event) {
+		return true;
+	}
+
+	// If the event is a vehicle in use, push the commands to the player instead
+	if (event_id >= Game_Character::CharBoat && event_id <= Game_Character::CharAirship)
+		if (static_cast<Game_Vehicle*>(event)->IsInUse())
+			event = Main_Data::game_player.get();
+
+	int x = ValueOrVariable(com.parameters[1], com.parameters[2]);
+	int y = ValueOrVariable(com.parameters[3], com.parameters[4]);
+
+	int move_freq = com.parameters[5];
+	if (move_freq <= 0 || move_freq > 8) {
+		// Invalid values
+		move_freq = 6;
+	}
+
+	int flags = com.parameters[6];
+	Pathfinder::Params params;
+	params.check_events = (flags & 1) != 0;
+	params.allow_diagonal = (flags & 2) != 0;
+	if (com.parameters.size() > 7 && com.parameters[7] > 0) {
+		params.search_limit = com.parameters[7];
+	}
+
+	std::vector<int> directions;
+	bool reached = Pathfinder::FindPath(*event, x, y, params, directions);
+
+	if (!directions.empty()) {
+		lcf::rpg::MoveRoute route;
+		route.repeat = false;
+		route.skippable = (flags & 4) != 0;
+
+		for (int dir: directions) {
+			// Move commands use the same order as the directions
+			lcf::rpg::MoveCommand cmd;
+			cmd.command_id = static_cast<int>(lcf::rpg::MoveCommand::Code::move_up) + dir;
+			route.move_commands.push_back(cmd);
+		}
+
+		event->ForceMoveRoute(route, move_freq);
+	}
+
+	if (com.parameters.size() > 8 && com.parameters[8] > 0) {
+		int var_id = com.parameters[8];
+		Main_Data::game_variables->Set(var_id, reached ? static_cast<int>(directions.size()) : -1);
+		Game_Map::SetNeedRefreshForVarChange(var_id);
+	}
+
+	return true;
+}
+
 Game_Interpreter& Game_Interpreter::GetForegroundInterpreter() {
 	return Game_Battle::IsBattleRunning()
 		? Game_Battle::GetInterpreter()
@@ -31,6 +31,7 @@
 #include "game_battle.h"
 #include "game_battler.h"
 #include "game_map.h"
+#include "game_character_batch.h"
 #include "game_interpreter_map.h"
 #include "game_switches.h"
 #include "game_player.h"
@@ -66,15 +67,36 @@ namespace {
 	lcf::rpg::SavePanorama panorama;
 
 	bool need_refresh;
+	// Events whose page depends on a changed condition, indexed by event ID, refreshed by the next Refresh
+	std::vector<bool> refresh_events;
+	bool refresh_events_pending = false;
+	int page_refresh_count = 0;
 
 	int animation_type;
 	bool animation_fast;
 	std::vector<unsigned char> passages_down;
 	std::vector<unsigned char> passages_up;
+
+	/** Passability and terrain of a map tile after tile substitution */
+	struct TilePassage {
+		/** Lower tile passage bits, autotile walls are passable in all directions */
+		uint8_t lower = 0;
+		/** Upper tile passage bits */
+		uint8_t upper = 0;
+		int16_t terrain = 1;
+	};
+	std::vector<TilePassage> tile_passages;
+	int passage_revision = 0;
+
+	bool event_scheduling = true;
+	Game_CharacterBatch motion_batch;
 	std::vector<Game_Event> events;
 	std::vector<Game_CommonEvent> common_events;
 	std::unordered_map<int, MapEventCache> events_cache_by_switch;
 	std::unordered_map<int, MapEventCache> events_cache_by_variable;
+	std::unordered_map<int, MapEventCache> events_cache_by_item;
+	std::unordered_map<int, MapEventCache> events_cache_by_actor;
+	std::unordered_map<int, MapEventCache> events_cache_by_timer;
 
 	std::unique_ptr<lcf::rpg::Map> map;
 
@@ -96,6 +118,10 @@ namespace {
 
 namespace Game_Map {
 void SetupCommon();
+void PreloadSoundEffects();
+void RebuildTilePassages();
+void RefreshTilePassage(int tile_index);
+int GetChipTerrainTag(unsigned chip_index);
 }
 
 void Game_Map::OnContinueFromBattle() {
@@ -137,6 +163,12 @@ void Game_Map::Dispose() {
 	events.clear();
 	events_cache_by_switch.clear();
 	events_cache_by_variable.clear();
+	events_cache_by_item.clear();
+	events_cache_by_actor.clear();
+	events_cache_by_timer.clear();
+	refresh_events.clear();
+	refresh_events_pending = false;
+	tile_passages.clear();
 	map.reset();
 	map_info = {};
 	panorama = {};
@@ -172,6 +204,7 @@ void Game_Map::Setup(std::unique_ptr<lcf::rpg::Map> map_in) {
 
 	std::iota(map_info.lower_tiles.begin(), map_info.lower_tiles.end(), 0);
 	std::iota(map_info.upper_tiles.begin(), map_info.upper_tiles.end(), 0);
+	RebuildTilePassages();
 
 	// Save allowed
 	const auto* current_info = &GetMapInfo();
@@ -374,6 +407,51 @@ void Game_Map::SetupCommon() {
 			if (pg.condition.flags.variable) {
 				AddEventToVariableCache(ev, pg.condition.variable_id);
 			}
+			if (pg.condition.flags.item) {
+				events_cache_by_item[pg.condition.item_id].AddEvent(ev);
+			}
+			if (pg.condition.flags.actor) {
+				events_cache_by_actor[pg.condition.actor_id].AddEvent(ev);
+			}
+			if (pg.condition.flags.timer) {
+				events_cache_by_timer[Game_Party::Timer1].AddEvent(ev);
+			}
+			if (pg.condition.flags.timer2) {
+				events_cache_by_timer[Game_Party::Timer2].AddEvent(ev);
+			}
+		}
+	}
+
+	PreloadSoundEffects();
+}
+
+void Game_Map::PreloadSoundEffects() {
+	auto& system = *Main_Data::game_system;
+
+	for (int i = 0; i < Game_System::SFX_Count; ++i) {
+		system.SePreload(system.GetSystemSE(i).name);
+	}
+
+	for (const auto& ev : map->events) {
+		for (const auto& pg : ev.pages) {
+			for (const auto& mc : pg.move_route.move_commands) {
+				if (mc.command_id == static_cast<int>(lcf::rpg::MoveCommand::Code::play_sound_effect)) {
+					system.SePreload(mc.parameter_string);
+				}
+			}
+
+			for (const auto& com : pg.event_commands) {
+				if (com.code != static_cast<int>(lcf::rpg::EventCommand::Code::PlaySound)) {
+					continue;
+				}
+
+				// Names from string variables are only known when executed
+				if (Player::IsPatchManiac() && com.parameters.size() > 4 && (com.parameters[3] & 0xF) != 0) {
+					continue;
+				}
+
+				system.SePreload(com.string);
+			}
 		}
 	}
 }
@@ -444,14 +522,38 @@ std::vector<uint8_t> Game_Map::GetTilesLayer(int layer) {
 	return layer >= 1 ? map_info.upper_tiles : map_info.lower_tiles;
 }
 
+static void ClearRefreshEvents() {
+	if (refresh_events_pending) {
+		std::fill(refresh_events.begin(), refresh_events.end(), false);
+		refresh_events_pending = false;
+	}
+}
+
 void Game_Map::Refresh() {
 	if (GetMapId() > 0) {
-		for (Game_Event& ev : events) {
-			ev.RefreshPage();
+		if (need_refresh) {
+			for (Game_Event& ev : events) {
+				ev.RefreshPage();
+			}
+			page_refresh_count += static_cast<int>(events.size());
+		} else if (refresh_events_pending) {
+			// Same order as the full refresh
+			for (Game_Event& ev : events) {
+				const int id = ev.GetId();
+				if (id < static_cast<int>(refresh_events.size()) && refresh_events[id]) {
+					ev.RefreshPage();
+					++page_refresh_count;
+				}
+			}
 		}
 	}
 
 	need_refresh = false;
+	ClearRefreshEvents();
+}
+
+int Game_Map::GetPageRefreshCount() {
+	return page_refresh_count;
 }
 
 Game_Interpreter_Map& Game_Map::GetInterpreter() {
@@ -769,14 +871,9 @@ bool Game_Map::CanLandAirship(int x, int y) {
 
 	int tile_index = x + y * GetTilesX();
 
-	if (!IsPassableLowerTile(bit, tile_index)) {
-		return false;
-	}
-
-	int tile_id = map->upper_layer[tile_index] - BLOCK_F;
-	tile_id = map_info.upper_tiles[tile_id];
+	const auto& tile = tile_passages[tile_index];
 
-	return (passages_up[tile_id] & bit) != 0;
+	return (tile.lower & bit) != 0 && (tile.upper & bit) != 0;
 }
 
 bool Game_Map::CanEmbarkShip(Game_Player& player, int x, int y) {
@@ -804,32 +901,7 @@ bool Game_Map::CanDisembarkShip(Game_Player& player, int x, int y) {
 }
 
 bool Game_Map::IsPassableLowerTile(int bit, int tile_index) {
-	int tile_raw_id = map->lower_layer[tile_index];
-	int tile_id = 0;
-
-	if (tile_raw_id >= BLOCK_E) {
-		tile_id = tile_raw_id - BLOCK_E;
-		tile_id = map_info.lower_tiles[tile_id] + BLOCK_E_INDEX;
-
-	} else if (tile_raw_id >= BLOCK_D) {
-		tile_id = (tile_raw_id - BLOCK_D) / BLOCK_D_STRIDE + BLOCK_D_INDEX;
-		int autotile_id = (tile_raw_id - BLOCK_D) % BLOCK_D_STRIDE;
-
-		if (((passages_down[tile_id] & Passable::Wall) != 0) && (
-				(autotile_id >= 20 && autotile_id <= 23) ||
-				(autotile_id >= 33 && autotile_id <= 37) ||
-				autotile_id == 42 || autotile_id == 43 ||
-				autotile_id == 45 || autotile_id == 46))
-			return true;
-
-	} else if (tile_raw_id >= BLOCK_C) {
-		tile_id = (tile_raw_id - BLOCK_C) / BLOCK_C_STRIDE + BLOCK_C_INDEX;
-
-	} else if (map->lower_layer[tile_index] < BLOCK_C) {
-		tile_id = tile_raw_id / BLOCK_B_STRIDE;
-	}
-
-	return (passages_down[tile_id] & bit) != 0;
+	return (tile_passages[tile_index].lower & bit) != 0;
 }
 
 bool Game_Map::IsPassableTile(
@@ -899,23 +971,21 @@ bool Game_Map::IsPassableTile(
 	}
 
 	if (check_map_geometry) {
-		int tile_index = x + y * GetTilesX();
-		int tile_id = map->upper_layer[tile_index] - BLOCK_F;
-		tile_id = map_info.upper_tiles[tile_id];
+		const auto& tile = tile_passages[x + y * GetTilesX()];
 
 		if (vehicle_type == Game_Vehicle::Boat || vehicle_type == Game_Vehicle::Ship) {
-			if ((passages_up[tile_id] & Passable::Above) == 0)
+			if ((tile.upper & Passable::Above) == 0)
 				return false;
 			return true;
 		}
 
-		if ((passages_up[tile_id] & bit) == 0)
+		if ((tile.upper & bit) == 0)
 			return false;
 
-		if ((passages_up[tile_id] & Passable::Above) == 0)
+		if ((tile.upper & Passable::Above) == 0)
 			return true;
 
-		return IsPassableLowerTile(bit, tile_index);
+		return (tile.lower & bit) != 0;
 	} else {
 		return true;
 	}
@@ -935,13 +1005,28 @@ int Game_Map::GetBushDepth(int x, int y) {
 bool Game_Map::IsCounter(int x, int y) {
 	if (!Game_Map::IsValid(x, y)) return false;
 
-	int const tile_id = map->upper_layer[x + y * GetTilesX()];
-	if (tile_id < BLOCK_F) return false;
-	int const index = map_info.upper_tiles[tile_id - BLOCK_F];
-	return !!(passages_up[index] & Passable::Counter);
+	return !!(tile_passages[x + y * GetTilesX()].upper & Passable::Counter);
 }
 
 int Game_Map::GetTerrainTag(int x, int y) {
+	// Terrain tag wraps on looping maps
+	if (Game_Map::LoopHorizontal()) {
+		x = RoundX(x);
+	}
+	if (Game_Map::LoopVertical()) {
+		y = RoundY(y);
+	}
+
+	if (Game_Map::IsValid(x, y)) {
+		return tile_passages[x + y * GetTilesX()].terrain;
+	}
+
+	// RPG_RT always uses the terrain of the first lower tile
+	// for out of bounds coordinates.
+	return GetChipTerrainTag(0);
+}
+
+int Game_Map::GetChipTerrainTag(unsigned chip_index) {
 	if (!chipset) {
 		// FIXME: Is this ever possible?
 		return 1;
@@ -954,31 +1039,72 @@ int Game_Map::GetTerrainTag(int x, int y) {
 		return 1;
 	}
 
-	// Terrain tag wraps on looping maps
-	if (Game_Map::LoopHorizontal()) {
-		x = RoundX(x);
+	assert(chip_index < terrain_data.size());
+
+	return terrain_data[chip_index];
+}
+
+void Game_Map::RebuildTilePassages() {
+	++passage_revision;
+
+	if (!map) {
+		tile_passages.clear();
+		return;
 	}
-	if (Game_Map::LoopVertical()) {
-		y = RoundY(y);
+
+	tile_passages.resize(map->lower_layer.size());
+	for (size_t i = 0; i < tile_passages.size(); ++i) {
+		RefreshTilePassage(static_cast<int>(i));
 	}
+}
 
-	// RPG_RT always uses the terrain of the first lower tile
-	// for out of bounds coordinates.
-	unsigned chip_index = 0;
+void Game_Map::RefreshTilePassage(int tile_index) {
+	auto& tile = tile_passages[tile_index];
 
-	if (Game_Map::IsValid(x, y)) {
-		const auto chip_id = map->lower_layer[x + y * GetTilesX()];
-		chip_index = ChipIdToIndex(chip_id);
+	// Lower layer
+	int tile_raw_id = map->lower_layer[tile_index];
+	int tile_id = 0;
+	tile.lower = 0;
 
-		// Apply tile substitution
-		if (chip_index >= BLOCK_E_INDEX && chip_index < NUM_LOWER_TILES) {
-			chip_index = map_info.lower_tiles[chip_index - BLOCK_E_INDEX] + BLOCK_E_INDEX;
-		}
+	if (tile_raw_id >= BLOCK_E) {
+		tile_id = tile_raw_id - BLOCK_E;
+		tile_id = map_info.lower_tiles[tile_id] + BLOCK_E_INDEX;
+
+	} else if (tile_raw_id >= BLOCK_D) {
+		tile_id = (tile_raw_id - BLOCK_D) / BLOCK_D_STRIDE + BLOCK_D_INDEX;
+		int autotile_id = (tile_raw_id - BLOCK_D) % BLOCK_D_STRIDE;
+
+		if (((passages_down[tile_id] & Passable::Wall) != 0) && (
+				(autotile_id >= 20 && autotile_id <= 23) ||
+				(autotile_id >= 33 && autotile_id <= 37) ||
+				autotile_id == 42 || autotile_id == 43 ||
+				autotile_id == 45 || autotile_id == 46))
+			tile.lower = Passable::Down | Passable::Left | Passable::Right | Passable::Up;
+
+	} else if (tile_raw_id >= BLOCK_C) {
+		tile_id = (tile_raw_id - BLOCK_C) / BLOCK_C_STRIDE + BLOCK_C_INDEX;
+
+	} else if (map->lower_layer[tile_index] < BLOCK_C) {
+		tile_id = tile_raw_id / BLOCK_B_STRIDE;
 	}
 
-	assert(chip_index < terrain_data.size());
+	tile.lower |= passages_down[tile_id];
 
-	return terrain_data[chip_index];
+	// Upper layer
+	int upper_raw_id = map->upper_layer[tile_index];
+	if (upper_raw_id >= BLOCK_F) {
+		tile.upper = passages_up[map_info.upper_tiles[upper_raw_id - BLOCK_F]];
+	} else {
+		// No upper tile, only the lower tile is relevant
+		tile.upper = Passable::Down | Passable::Left | Passable::Right | Passable::Up | Passable::Above;
+	}
+
+	// Terrain of the lower tile
+	unsigned chip_index = ChipIdToIndex(tile_raw_id);
+	if (chip_index >= BLOCK_E_INDEX && chip_index < NUM_LOWER_TILES) {
+		chip_index = map_info.lower_tiles[chip_index - BLOCK_E_INDEX] + BLOCK_E_INDEX;
+	}
+	tile.terrain = static_cast<int16_t>(GetChipTerrainTag(chip_index));
 }
 
 void Game_Map::GetEventsXY(std::vector<Game_Event*>& events, int x, int y) {
@@ -1059,6 +1185,10 @@ int Game_Map::CheckEvent(int x, int y) {
 }
 
 void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
+	if (!actx.IsActive()) {
+		page_refresh_count = 0;
+	}
+
 	if (GetNeedRefresh()) {
 		Refresh();
 	}
@@ -1108,6 +1238,7 @@ void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
 		Main_Data::game_party->UpdateTimers();
 		Main_Data::game_screen->Update();
 		Main_Data::game_pictures->Update(false);
+		Main_Data::game_system->UpdateSePreloads();
 	}
 
 	if (!actx.IsActive() || actx.IsForegroundEvent()) {
@@ -1179,6 +1310,25 @@ bool Game_Map::UpdateMapEvents(MapUpdateAsyncContext& actx) {
 			}
 		}
 
+		if (event_scheduling && !resume_async) {
+			// Skip the no-op parts of the update
+			auto update_class = ev.GetUpdateClass();
+			if (update_class == Game_Event::UpdateClass::Inactive) {
+				continue;
+			}
+			if (update_class == Game_Event::UpdateClass::Idle) {
+				ev.UpdateIdle();
+				continue;
+			}
+			if (Game_CharacterBatch::CanUpdate(ev)) {
+				motion_batch.Add(ev);
+				continue;
+			}
+		}
+
+		// Events with side effects see the batched events updated
+		motion_batch.Update();
+
 		auto aop = ev.Update(resume_async);
 		if (aop.IsActive()) {
 			// Suspend due to this event ..
@@ -1187,10 +1337,20 @@ bool Game_Map::UpdateMapEvents(MapUpdateAsyncContext& actx) {
 		}
 	}
 
+	motion_batch.Update();
+
 	actx = {};
 	return true;
 }
 
+bool Game_Map::IsEventSchedulingEnabled() {
+	return event_scheduling;
+}
+
+void Game_Map::SetEventSchedulingEnabled(bool enabled) {
+	event_scheduling = enabled;
+}
+
 bool Game_Map::UpdateMessage(MapUpdateAsyncContext& actx) {
 	// Message system does not support suspend and resume internally. So if the last frame the message
 	// produced an async event, the message loop finished completely. Therefore this frame we should
@@ -1542,11 +1702,14 @@ bool Game_Map::GetNeedRefresh() {
 		return false;
 	}
 
-	return need_refresh;
+	return need_refresh || refresh_events_pending;
 }
 
 void Game_Map::SetNeedRefresh(bool refresh) {
 	need_refresh = refresh;
+	if (!refresh) {
+		ClearRefreshEvents();
+	}
 }
 
 void MapEventCache::AddEvent(lcf::rpg::Event& ev) {
@@ -1557,18 +1720,65 @@ void MapEventCache::AddEvent(lcf::rpg::Event& ev) {
 	}
 }
 
-void Game_Map::SetNeedRefreshForSwitchChange(int switch_id) {
+const std::vector<int>& MapEventCache::GetEventIds() const {
+	return event_ids;
+}
+
+static void MarkRefreshEvents(const std::vector<int>& ids) {
+	for (int id : ids) {
+		if (id >= static_cast<int>(refresh_events.size())) {
+			refresh_events.resize(id + 1, false);
+		}
+		refresh_events[id] = true;
+	}
+	refresh_events_pending |= !ids.empty();
+}
+
+static void AddRefreshEvents(const std::unordered_map<int, MapEventCache>& cache, int id) {
 	if (need_refresh)
 		return;
-	if (events_cache_by_switch.find(switch_id) != events_cache_by_switch.end())
-		SetNeedRefresh(true);
+	auto it = cache.find(id);
+	if (it != cache.end()) {
+		MarkRefreshEvents(it->second.GetEventIds());
+	}
 }
 
-void Game_Map::SetNeedRefreshForVarChange(int var_id) {
+static void AddRefreshEvents(const std::unordered_map<int, MapEventCache>& cache, int first_id, int last_id) {
 	if (need_refresh)
 		return;
-	if (events_cache_by_variable.find(var_id) != events_cache_by_variable.end())
-		SetNeedRefresh(true);
+	for (const auto& entry : cache) {
+		if (entry.first >= first_id && entry.first <= last_id) {
+			MarkRefreshEvents(entry.second.GetEventIds());
+		}
+	}
+}
+
+void Game_Map::SetNeedRefreshForSwitchChange(int switch_id) {
+	AddRefreshEvents(events_cache_by_switch, switch_id);
+}
+
+void Game_Map::SetNeedRefreshForVarChange(int var_id) {
+	AddRefreshEvents(events_cache_by_variable, var_id);
+}
+
+void Game_Map::SetNeedRefreshForSwitchChange(int first_id, int last_id) {
+	AddRefreshEvents(events_cache_by_switch, first_id, last_id);
+}
+
+void Game_Map::SetNeedRefreshForVarChange(int first_id, int last_id) {
+	AddRefreshEvents(events_cache_by_variable, first_id, last_id);
+}
+
+void Game_Map::SetNeedRefreshForItemChange(int item_id) {
+	AddRefreshEvents(events_cache_by_item, item_id);
+}
+
+void Game_Map::SetNeedRefreshForActorChange(int actor_id) {
+	AddRefreshEvents(events_cache_by_actor, actor_id);
+}
+
+void Game_Map::SetNeedRefreshForTimerChange(int which) {
+	AddRefreshEvents(events_cache_by_timer, which);
 }
 
 void Game_Map::SetNeedRefreshForSwitchChange(std::initializer_list<int> switch_ids) {
@@ -1651,6 +1861,8 @@ void Game_Map::SetChipset(int id) {
 		passages_down.resize(162, (unsigned char) 0x0F);
 	if (passages_up.size() < 144)
 		passages_up.resize(144, (unsigned char) 0x0F);
+
+	RebuildTilePassages();
 }
 
 bool Game_Map::ReloadChipset() {
@@ -1725,23 +1937,56 @@ void Game_Map::RemoveAllPendingMoves() {
 	}
 }
 
-static int DoSubstitute(std::vector<uint8_t>& tiles, int old_id, int new_id) {
+static int DoSubstitute(std::vector<uint8_t>& tiles, int old_id, int new_id, std::vector<bool>& changed) {
 	int num_subst = 0;
+	changed.assign(tiles.size(), false);
 	for (size_t i = 0; i < tiles.size(); ++i) {
 		if (tiles[i] == old_id) {
 			tiles[i] = (uint8_t) new_id;
+			changed[i] = true;
 			++num_subst;
 		}
 	}
 	return num_subst;
 }
 
+int Game_Map::GetPassageRevision() {
+	return passage_revision;
+}
+
 int Game_Map::SubstituteDown(int old_id, int new_id) {
-	return DoSubstitute(map_info.lower_tiles, old_id, new_id);
+	std::vector<bool> changed;
+	int num_subst = DoSubstitute(map_info.lower_tiles, old_id, new_id, changed);
+
+	if (num_subst > 0 && map) {
+		++passage_revision;
+		// Only tiles of block E are substituted
+		for (size_t i = 0; i < tile_passages.size(); ++i) {
+			int tile_raw_id = map->lower_layer[i];
+			if (tile_raw_id >= BLOCK_E && static_cast<size_t>(tile_raw_id - BLOCK_E) < changed.size() && changed[tile_raw_id - BLOCK_E]) {
+				RefreshTilePassage(static_cast<int>(i));
+			}
+		}
+	}
+
+	return num_subst;
 }
 
 int Game_Map::SubstituteUp(int old_id, int new_id) {
-	return DoSubstitute(map_info.upper_tiles, old_id, new_id);
+	std::vector<bool> changed;
+	int num_subst = DoSubstitute(map_info.upper_tiles, old_id, new_id, changed);
+
+	if (num_subst > 0 && map) {
+		++passage_revision;
+		for (size_t i = 0; i < tile_passages.size(); ++i) {
+			int tile_raw_id = map->upper_layer[i];
+			if (tile_raw_id >= BLOCK_F && static_cast<size_t>(tile_raw_id - BLOCK_F) < changed.size() && changed[tile_raw_id - BLOCK_F]) {
+				RefreshTilePassage(static_cast<int>(i));
+			}
+		}
+	}
+
+	return num_subst;
 }
 
 std::string Game_Map::ConstructMapName(int map_id, bool is_easyrpg) {
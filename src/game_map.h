@@ -78,6 +78,9 @@ class MapEventCache {
 public:
 	void AddEvent(lcf::rpg::Event& ev);
 
+	/** @return IDs of the events with a page depending on the cached condition */
+	const std::vector<int>& GetEventIds() const;
+
 private:
 	std::vector<int> event_ids;
 };
@@ -154,7 +157,9 @@ namespace Game_Map {
 	void PlayBgm();
 
 	/**
-	 * Refreshes the map.
+	 * Refreshes the pages of the map events.
+	 * After SetNeedRefresh(true) all events are refreshed, otherwise only
+	 * the events queued by the SetNeedRefreshFor*Change functions.
 	 */
 	void Refresh();
 
@@ -506,10 +511,15 @@ namespace Game_Map {
 	void SetPositionY(int new_position_y, bool reset_panorama = true);
 
 	/**
-	 * @return need refresh flag.
+	 * @return need refresh flag, set for a full refresh or when single events must be refreshed.
 	 */
 	bool GetNeedRefresh();
 
+	/**
+	 * @return Number of event page refreshes done in the current frame.
+	 */
+	int GetPageRefreshCount();
+
 	/**
 	 * Gets the game interpreter.
 	 *
@@ -518,7 +528,8 @@ namespace Game_Map {
 	Game_Interpreter_Map& GetInterpreter();
 
 	/**
-	 * Sets the need refresh flag.
+	 * Sets the need refresh flag. When set all events are refreshed,
+	 * when cleared the queued event refreshes are dropped.
 	 *
 	 * @param refresh need refresh flag.
 	 */
@@ -619,6 +630,12 @@ namespace Game_Map {
 	void OnTranslationChanged();
 
 	Game_Vehicle* GetVehicle(Game_Vehicle::Type which);
+
+	/**
+	 * @return Counter increased whenever the passability of the map tiles changes.
+	 */
+	int GetPassageRevision();
+
 	int SubstituteDown(int old_id, int new_id);
 	int SubstituteUp(int old_id, int new_id);
 
@@ -674,6 +691,18 @@ namespace Game_Map {
 	void UpdateProcessedFlags(bool is_preupdate);
 	bool UpdateCommonEvents(MapUpdateAsyncContext& actx);
 	bool UpdateMapEvents(MapUpdateAsyncContext& actx);
+
+	/** @return Whether map events use the reduced and batched updates */
+	bool IsEventSchedulingEnabled();
+
+	/**
+	 * Enables or disables the reduced update of idle and inactive map events
+	 * and their sprites, and the batch update of walking events
+	 * (see Game_CharacterBatch). The behaviour is identical in both cases.
+	 *
+	 * @param enabled new state
+	 */
+	void SetEventSchedulingEnabled(bool enabled);
 	bool UpdateMessage(MapUpdateAsyncContext& actx);
 	bool UpdateForegroundEvents(MapUpdateAsyncContext& actx);
 
@@ -692,6 +721,11 @@ namespace Game_Map {
 	void SetNeedRefreshForVarChange(int var_id);
 	void SetNeedRefreshForSwitchChange(std::initializer_list<int> switch_ids);
 	void SetNeedRefreshForVarChange(std::initializer_list<int> var_ids);
+	void SetNeedRefreshForSwitchChange(int first_id, int last_id);
+	void SetNeedRefreshForVarChange(int first_id, int last_id);
+	void SetNeedRefreshForItemChange(int item_id);
+	void SetNeedRefreshForActorChange(int actor_id);
+	void SetNeedRefreshForTimerChange(int which);
 
 	void AddEventToSwitchCache(lcf::rpg::Event& ev, int switch_id);
 	void AddEventToVariableCache(lcf::rpg::Event& ev, int var_id);
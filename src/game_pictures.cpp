@@ -15,8 +15,10 @@
  * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cmath>
 #include "bitmap.h"
+#include "game_clock.h"
 #include "options.h"
 #include "cache.h"
 #include "output.h"
@@ -77,6 +79,9 @@ void Game_Pictures::InitGraphics() {
 void Game_Pictures::SetSaveData(std::vector<lcf::rpg::SavePicture> save)
 {
 	pictures.clear();
+	active_pictures.clear();
+	map_frames = 0;
+	battle_frames = 0;
 
 	frame_counter = save.empty() ? 0 : save.back().frames;
 
@@ -92,6 +97,9 @@ void Game_Pictures::SetSaveData(std::vector<lcf::rpg::SavePicture> save)
 	pictures.reserve(num_pictures);
 	for (int i = 0; i < num_pictures; ++i) {
 		pictures.emplace_back(std::move(save[i]));
+		if (pictures.back().needs_update) {
+			active_pictures.push_back(i + 1);
+		}
 	}
 }
 
@@ -103,6 +111,7 @@ std::vector<lcf::rpg::SavePicture> Game_Pictures::GetSaveData() const {
 
 	for (auto& pic: pictures) {
 		save.push_back(pic.data);
+		save.back().frames += GetPendingFrames(pic);
 	}
 
 	// RPG_RT Save game data always has a constant number of pictures
@@ -150,6 +159,8 @@ Game_Pictures::Picture& Game_Pictures::GetPicture(int id) {
 		pictures.reserve(id);
 		while (static_cast<int>(pictures.size()) < id) {
 			pictures.emplace_back(pictures.size() + 1);
+			pictures.back().map_frames_mark = map_frames;
+			pictures.back().battle_frames_mark = battle_frames;
 		}
 	}
 	return pictures[id - 1];
@@ -160,6 +171,33 @@ Game_Pictures::Picture* Game_Pictures::GetPicturePtr(int id) {
 		? &pictures[id - 1] : nullptr;
 }
 
+void Game_Pictures::Activate(Picture& pic) {
+	if (pic.needs_update) {
+		return;
+	}
+
+	pic.data.frames += GetPendingFrames(pic);
+	pic.needs_update = true;
+
+	const int id = pic.data.ID;
+	active_pictures.insert(std::lower_bound(active_pictures.begin(), active_pictures.end(), id), id);
+}
+
+int Game_Pictures::GetPendingFrames(const Picture& pic) const {
+	if (pic.needs_update) {
+		return 0;
+	}
+
+	int frames = 0;
+	if (pic.IsOnMap()) {
+		frames += map_frames - pic.map_frames_mark;
+	}
+	if (pic.IsOnBattle()) {
+		frames += battle_frames - pic.battle_frames_mark;
+	}
+	return frames;
+}
+
 void Game_Pictures::OnMapChange() {
 	for (auto& pic: pictures) {
 		if (pic.data.flags.erase_on_map_change) {
@@ -177,8 +215,6 @@ void Game_Pictures::OnBattleEnd() {
 }
 
 bool Game_Pictures::Picture::Show(const ShowParams& params) {
-	needs_update = true;
-
 	data.name = params.name;
 	data.use_transparent_color = params.use_transparent_color;
 	data.fixed_to_map = params.fixed_to_map;
@@ -252,6 +288,7 @@ bool Game_Pictures::Picture::Show(const ShowParams& params) {
 
 bool Game_Pictures::Show(int id, const ShowParams& params) {
 	auto& pic = GetPicture(id);
+	Activate(pic);
 	if (pic.Show(params)) {
 		if (pic.sprite && !pic.data.name.empty()) {
 			// When the name is empty the current image buffer is reused by ShowPicture command (Used by Yume2kki)
@@ -321,6 +358,7 @@ void Game_Pictures::Picture::Move(const MoveParams& params) {
 
 void Game_Pictures::Move(int id, const MoveParams& params) {
 	auto& pic = GetPicture(id);
+	Activate(pic);
 	pic.Move(params);
 }
 
@@ -397,6 +435,84 @@ void Game_Pictures::OnPictureSpriteReady(FileRequestResult*, int id) {
 		pic->request_id = nullptr;
 		pic->CreateSprite();
 		pic->OnPictureSpriteReady();
+		ReleasePreload(pic->data.name, pic->data.use_transparent_color);
+	}
+}
+
+namespace {
+	/** Maximum number of queued and held preloads */
+	constexpr size_t max_preloads = 8;
+	/** Frames a decoded preload is kept without being shown */
+	constexpr int preload_frames = 600;
+	/** Decoding time per Update, at least one picture is decoded */
+	constexpr auto preload_budget = std::chrono::milliseconds(4);
+}
+
+void Game_Pictures::Preload(StringView name, bool transparent) {
+	if (name.empty()) {
+		return;
+	}
+
+	for (const auto& entry : preloads) {
+		if (entry.transparent == transparent && entry.name == name) {
+			return;
+		}
+	}
+
+	if (preloads.size() >= max_preloads) {
+		// Make room by dropping the oldest decoded picture, pending ones are nearer
+		auto it = std::find_if(preloads.begin(), preloads.end(), [](const auto& entry) {
+			return entry.bitmap != nullptr;
+		});
+		if (it == preloads.end()) {
+			return;
+		}
+		preloads.erase(it);
+	}
+
+	PreloadEntry entry;
+	entry.name = ToString(name);
+	entry.transparent = transparent;
+	entry.request = AsyncHandler::RequestFile("Picture", name);
+	entry.request->SetGraphicFile(true);
+	entry.request->Start();
+	preloads.push_back(std::move(entry));
+}
+
+void Game_Pictures::UpdatePreloads() {
+	if (preloads.empty()) {
+		return;
+	}
+
+	const auto deadline = Game_Clock::now() + preload_budget;
+	bool decoded = false;
+
+	for (auto& entry : preloads) {
+		if (entry.bitmap) {
+			--entry.frames_left;
+			continue;
+		}
+
+		if (!entry.request->IsReady() || (decoded && Game_Clock::now() >= deadline)) {
+			continue;
+		}
+
+		entry.bitmap = Cache::Picture(entry.name, entry.transparent);
+		entry.frames_left = preload_frames;
+		decoded = true;
+	}
+
+	preloads.erase(std::remove_if(preloads.begin(), preloads.end(), [](const auto& entry) {
+		return entry.bitmap && entry.frames_left <= 0;
+	}), preloads.end());
+}
+
+void Game_Pictures::ReleasePreload(StringView name, bool transparent) {
+	auto it = std::find_if(preloads.begin(), preloads.end(), [&](const auto& entry) {
+		return entry.transparent == transparent && entry.name == name;
+	});
+	if (it != preloads.end()) {
+		preloads.erase(it);
 	}
 }
 
@@ -597,11 +713,51 @@ void Game_Pictures::Picture::Update(bool is_battle) {
 	}
 }
 
+bool Game_Pictures::Picture::IsSettled() const {
+	if (data.time_left > 0) {
+		return false;
+	}
+
+	if (Player::IsRPG2k3ECommands() && data.spritesheet_speed > 0) {
+		return false;
+	}
+
+	switch (data.effect_mode) {
+		case lcf::rpg::SavePicture::Effect_none:
+			// Rotation continues until a full revolution is done
+			return !(data.current_effect_power > 0 && data.current_rotation > 0.0);
+		case lcf::rpg::SavePicture::Effect_maniac_fixed_angle:
+			return data.current_effect_power == data.finish_effect_power;
+		default:
+			return false;
+	}
+}
+
 void Game_Pictures::Update(bool is_battle) {
+	UpdatePreloads();
+
 	++frame_counter;
-	for (auto& pic: pictures) {
+	if (Player::IsRPG2k3ECommands()) {
+		++(is_battle ? battle_frames : map_frames);
+	}
+
+	size_t num_active = 0;
+	for (size_t i = 0; i < active_pictures.size(); ++i) {
+		const int id = active_pictures[i];
+		auto& pic = pictures[id - 1];
 		pic.Update(is_battle);
+
+		// Pictures of the other layer were not updated and can be unsynced
+		const bool on_layer = is_battle ? pic.IsOnBattle() : pic.IsOnMap();
+		if (on_layer && pic.IsSettled()) {
+			pic.needs_update = false;
+			pic.map_frames_mark = map_frames;
+			pic.battle_frames_mark = battle_frames;
+			continue;
+		}
+		active_pictures[num_active++] = id;
 	}
+	active_pictures.resize(num_active);
 }
 
 Game_Pictures::ShowParams Game_Pictures::Picture::GetShowParams() const {
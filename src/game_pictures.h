@@ -21,7 +21,9 @@
 // Headers
 #include <string>
 #include <deque>
+#include <vector>
 #include "async_handler.h"
+#include "memory_management.h"
 #include <lcf/rpg/savepicture.h>
 #include "sprite_picture.h"
 
@@ -89,6 +91,17 @@ public:
 
 	void Update(bool is_battle);
 
+	/**
+	 * Decodes a picture ahead of the Show command using it.
+	 * The file is requested immediately and decoded into the picture
+	 * cache by the following Update calls within a time budget. The
+	 * bitmap is kept alive until a picture shows it or it expires.
+	 *
+	 * @param name picture file name
+	 * @param transparent whether the transparent color is used
+	 */
+	void Preload(StringView name, bool transparent);
+
 	void OnMapChange();
 	void OnBattleEnd();
 	void OnMapScrolled(int dx, int dy);
@@ -100,11 +113,18 @@ public:
 		std::unique_ptr<Sprite_Picture> sprite;
 		lcf::rpg::SavePicture data;
 		FileRequestBinding request_id;
+		/** Whether the picture is in the list of updated pictures */
 		bool needs_update = false;
 		int origin = 0;
+		/** Layer update counts when the picture stopped updating */
+		int map_frames_mark = 0;
+		int battle_frames_mark = 0;
 
 		void Update(bool is_battle);
 
+		/** @return Whether further updates only advance the frame counter */
+		bool IsSettled() const;
+
 		bool IsOnMap() const;
 		bool IsOnBattle() const;
 		int NumSpriteSheetFrames() const;
@@ -137,8 +157,43 @@ private:
 	void RequestPictureSprite(Picture& pic);
 	void OnPictureSpriteReady(FileRequestResult*, int id);
 
+	/**
+	 * Adds a picture to the updated pictures.
+	 * The frame counter skipped while not updated is applied.
+	 */
+	void Activate(Picture& pic);
+
+	/** @return Frames the frame counter of a not updated picture is behind */
+	int GetPendingFrames(const Picture& pic) const;
+
+	/** Decodes the downloaded preloads and expires unused ones */
+	void UpdatePreloads();
+
+	/** Drops the preload of a picture once a sprite holds it */
+	void ReleasePreload(StringView name, bool transparent);
+
+	struct PreloadEntry {
+		std::string name;
+		bool transparent = false;
+		FileRequestAsync* request = nullptr;
+		BitmapRef bitmap;
+		/** Updates until an unused decoded bitmap is released */
+		int frames_left = 0;
+	};
+
 	std::vector<Picture> pictures;
+	/**
+	 * IDs of the pictures which are updated, ascending.
+	 * Games using thousands of picture IDs only have a few of them moving,
+	 * settled pictures are removed until the next Show or Move.
+	 */
+	std::vector<int> active_pictures;
 	int frame_counter = 0;
+	/** Updates of the map and the battle layer with picture frame counting */
+	int map_frames = 0;
+	int battle_frames = 0;
+	/** Requested pictures in order of the preload calls */
+	std::vector<PreloadEntry> preloads;
 };
 
 inline bool Game_Pictures::Picture::IsOnMap() const {
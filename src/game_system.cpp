@@ -16,11 +16,13 @@
  */
 
 // Headers
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include "game_system.h"
 #include "async_handler.h"
 #include "game_battle.h"
+#include "game_clock.h"
 #include "audio.h"
 #include "baseui.h"
 #include "bitmap.h"
@@ -37,6 +39,11 @@
 #include "audio_secache.h"
 #include "feature.h"
 
+namespace {
+	/** Decoding time per UpdateSePreloads, at least one SE is decoded */
+	constexpr auto se_preload_budget = std::chrono::milliseconds(2);
+}
+
 Game_System::Game_System()
 	: dbsys(&lcf::Data::system)
 { }
@@ -199,6 +206,26 @@ void Game_System::SePlay(const lcf::rpg::Animation &animation) {
 	}
 }
 
+void Game_System::SePreload(StringView name) {
+	if (name.empty() || name == "(OFF)" || name.ends_with(".script") || name.ends_with(".link")) {
+		return;
+	}
+
+	if (Player::no_audio_flag || !DisplayUi || AudioSeCache::IsFull()) {
+		return;
+	}
+
+	std::string file = ToString(name);
+	if (se_preload_ids.find(file) != se_preload_ids.end() || AudioSeCache::GetCachedSe(file) ||
+			std::find(se_preload_queue.begin(), se_preload_queue.end(), file) != se_preload_queue.end()) {
+		return;
+	}
+
+	FileRequestAsync* request = AsyncHandler::RequestFile("Sound", file);
+	se_preload_ids[file] = request->Bind(&Game_System::OnSePreloadReady, this);
+	request->Start();
+}
+
 StringView Game_System::GetSystemName() {
 	return !data.graphics_name.empty() ?
 		StringView(data.graphics_name) : StringView(lcf::Data::system.system_name);
@@ -623,6 +650,46 @@ void Game_System::OnSeInelukiReady(FileRequestResult* result, lcf::rpg::Sound se
 	Audio().SE_Play(std::move(se_cache), se.volume, se.tempo);
 }
 
+void Game_System::OnSePreloadReady(FileRequestResult* result) {
+	auto item = se_preload_ids.find(result->file);
+	if (item != se_preload_ids.end()) {
+		se_preload_ids.erase(item);
+	}
+
+	// Decoded by UpdateSePreloads to not stall the map setup
+	se_preload_queue.push_back(result->file);
+}
+
+void Game_System::UpdateSePreloads() {
+	const auto deadline = Game_Clock::now() + se_preload_budget;
+	bool decoded = false;
+
+	while (!se_preload_queue.empty() && !(decoded && Game_Clock::now() >= deadline)) {
+		if (AudioSeCache::IsFull()) {
+			se_preload_queue.clear();
+			return;
+		}
+
+		std::string file = std::move(se_preload_queue.front());
+		se_preload_queue.pop_front();
+
+		if (AudioSeCache::GetCachedSe(file)) {
+			continue;
+		}
+
+		Filesystem_Stream::InputStream stream;
+		if (IsStopSoundFilename(file, stream) || !stream) {
+			continue;
+		}
+
+		auto se_cache = AudioSeCache::Create(std::move(stream), file);
+		if (se_cache) {
+			se_cache->Preload();
+			decoded = true;
+		}
+	}
+}
+
 bool Game_System::IsMessageTransparent() {
 	if (Feature::HasRpg2kBattleSystem() && Game_Battle::IsBattleRunning()) {
 		return false;
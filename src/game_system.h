@@ -19,6 +19,7 @@
 #define EP_GAME_SYSTEM_H
 
 // Headers
+#include <deque>
 #include <string>
 #include <map>
 #include <lcf/rpg/animation.h>
@@ -135,6 +136,20 @@ public:
 	 */
 	void SePlay(const lcf::rpg::Animation& animation);
 
+	/**
+	 * Queues a Sound for decoding into the SE cache without playing it.
+	 * Does nothing when the cache is full.
+	 *
+	 * @param name sound file name.
+	 */
+	void SePreload(StringView name);
+
+	/**
+	 * Decodes queued SE preloads for a few milliseconds.
+	 * Called once per frame.
+	 */
+	void UpdateSePreloads();
+
 	/** @return system graphic filename.  */
 	StringView GetSystemName();
 
@@ -443,6 +458,7 @@ private:
 	void OnBgmInelukiReady(FileRequestResult* result);
 	void OnSeReady(FileRequestResult* result, lcf::rpg::Sound se, bool stop_sounds);
 	void OnSeInelukiReady(FileRequestResult* result, lcf::rpg::Sound se);
+	void OnSePreloadReady(FileRequestResult* result);
 	void OnChangeSystemGraphicReady(FileRequestResult* result);
 private:
 	lcf::rpg::SaveSystem data;
@@ -450,6 +466,8 @@ private:
 	FileRequestBinding music_request_id;
 	FileRequestBinding system_request_id;
 	std::map<std::string, FileRequestBinding> se_request_ids;
+	std::map<std::string, FileRequestBinding> se_preload_ids;
+	std::deque<std::string> se_preload_queue;
 	Color bg_color = Color{ 0, 0, 0, 255 };
 	bool bgm_pending = false;
 	int loaded_frame_count = 0;
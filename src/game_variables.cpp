@@ -24,6 +24,11 @@
 #include "rand.h"
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define EP_GAME_VARIABLES_SSE2
+#  include <emmintrin.h>
+#endif
+
 constexpr int Game_Variables::max_warnings;
 constexpr Game_Variables::Var_t Game_Variables::min_2k;
 constexpr Game_Variables::Var_t Game_Variables::max_2k;
@@ -134,6 +139,134 @@ constexpr Var_t VarBitShiftRight(Var_t n, Var_t d) {
 	return n >> d;
 };
 
+/** Collects the first and the last changed index of a write loop */
+struct ChangeTracker {
+	int first = 0;
+	int last = -1;
+
+	void Add(int i) {
+		if (last < 0) {
+			first = i;
+		}
+		last = i;
+	}
+
+	/**
+	 * @param i index of the first lane
+	 * @param unchanged movemask of the lanes with unchanged value
+	 */
+	void Add4(int i, int unchanged) {
+		const int changed = ~unchanged & 0xFFFF;
+		if (changed == 0) {
+			return;
+		}
+		if (last < 0) {
+			int lane = 0;
+			while (!(changed & (0xF << (lane * 4)))) {
+				++lane;
+			}
+			first = i + lane;
+		}
+		int lane = 3;
+		while (!(changed & (0xF << (lane * 4)))) {
+			--lane;
+		}
+		last = i + lane;
+	}
+};
+
+#ifdef EP_GAME_VARIABLES_SSE2
+inline __m128i SimdSelect(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/** @return INT32_MIN for negative lanes of l, INT32_MAX otherwise */
+inline __m128i SimdSaturate(__m128i l) {
+	return _mm_xor_si128(_mm_srai_epi32(l, 31), _mm_set1_epi32(std::numeric_limits<Var_t>::max()));
+}
+
+inline __m128i SimdClamp(__m128i v, __m128i minval, __m128i maxval) {
+	v = SimdSelect(_mm_cmpgt_epi32(v, maxval), maxval, v);
+	return SimdSelect(_mm_cmplt_epi32(v, minval), minval, v);
+}
+#endif
+
+/*
+ * Operations of the vectorized range and array writes. The SSE2 versions
+ * saturate on overflow like the scalar Var* functions.
+ */
+struct OpSet {
+	Var_t operator()(Var_t l, Var_t r) const { return VarSet(l, r); }
+#ifdef EP_GAME_VARIABLES_SSE2
+	__m128i operator()(__m128i, __m128i r) const { return r; }
+#endif
+};
+
+struct OpAdd {
+	Var_t operator()(Var_t l, Var_t r) const { return VarAdd(l, r); }
+#ifdef EP_GAME_VARIABLES_SSE2
+	__m128i operator()(__m128i l, __m128i r) const {
+		const __m128i res = _mm_add_epi32(l, r);
+		// Overflow when the result sign differs from the sign of both operands
+		const __m128i overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(l, res), _mm_xor_si128(r, res)), 31);
+		return SimdSelect(overflow, SimdSaturate(l), res);
+	}
+#endif
+};
+
+struct OpSub {
+	Var_t operator()(Var_t l, Var_t r) const { return VarSub(l, r); }
+#ifdef EP_GAME_VARIABLES_SSE2
+	__m128i operator()(__m128i l, __m128i r) const {
+		const __m128i res = _mm_sub_epi32(l, r);
+		// Overflow when the operand signs differ and the result sign differs from l
+		const __m128i overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(l, r), _mm_xor_si128(l, res)), 31);
+		return SimdSelect(overflow, SimdSaturate(l), res);
+	}
+#endif
+};
+
+struct OpBitOr {
+	Var_t operator()(Var_t l, Var_t r) const { return VarBitOr(l, r); }
+#ifdef EP_GAME_VARIABLES_SSE2
+	__m128i operator()(__m128i l, __m128i r) const { return _mm_or_si128(l, r); }
+#endif
+};
+
+struct OpBitAnd {
+	Var_t operator()(Var_t l, Var_t r) const { return VarBitAnd(l, r); }
+#ifdef EP_GAME_VARIABLES_SSE2
+	__m128i operator()(__m128i l, __m128i r) const { return _mm_and_si128(l, r); }
+#endif
+};
+
+struct OpBitXor {
+	Var_t operator()(Var_t l, Var_t r) const { return VarBitXor(l, r); }
+#ifdef EP_GAME_VARIABLES_SSE2
+	__m128i operator()(__m128i l, __m128i r) const { return _mm_xor_si128(l, r); }
+#endif
+};
+
+/** Only used for shift counts in [0, 31], the lanes of r hold the same count */
+struct OpBitShiftLeft {
+	Var_t operator()(Var_t l, Var_t r) const { return VarBitShiftLeft(l, r); }
+#ifdef EP_GAME_VARIABLES_SSE2
+	__m128i operator()(__m128i l, __m128i r) const { return _mm_sll_epi32(l, _mm_cvtsi32_si128(_mm_cvtsi128_si32(r))); }
+#endif
+};
+
+/** Only used for shift counts in [0, 31], the lanes of r hold the same count */
+struct OpBitShiftRight {
+	Var_t operator()(Var_t l, Var_t r) const { return VarBitShiftRight(l, r); }
+#ifdef EP_GAME_VARIABLES_SSE2
+	__m128i operator()(__m128i l, __m128i r) const { return _mm_sra_epi32(l, _mm_cvtsi32_si128(_mm_cvtsi128_si32(r))); }
+#endif
+};
+
+constexpr bool IsValidShift(Var_t value) {
+	return value >= 0 && value < 32;
+}
+
 }
 
 Game_Variables::Game_Variables(Var_t minval, Var_t maxval)
@@ -198,21 +331,108 @@ void Game_Variables::PrepareArray(const int first_id_a, const int last_id_a, con
 template <typename V, typename F>
 void Game_Variables::WriteRange(const int first_id, const int last_id, V&& value, F&& op) {
 	auto& vv = _variables;
+	ChangeTracker changed;
 	for (int i = std::max(0, first_id - 1); i < last_id; ++i) {
 		auto& v = vv[i];
-		v = Utils::Clamp(op(v, value()), _min, _max);
+		const auto nv = Utils::Clamp(op(v, value()), _min, _max);
+		if (nv != v) {
+			changed.Add(i);
+		}
+		v = nv;
 	}
+	MarkChanged(changed.first, changed.last);
 }
 
 template <typename F>
 void Game_Variables::WriteArray(const int first_id_a, const int last_id_a, const int first_id_b, F&& op) {
 	auto& vv = _variables;
+	ChangeTracker changed;
 	int out_b = std::max(0, first_id_b - 1);
 	for (int i = std::max(0, first_id_a - 1); i < last_id_a; ++i) {
 		auto& v_a = vv[i];
 		auto v_b = vv[out_b++];
-		v_a = Utils::Clamp(op(v_a, v_b), _min, _max);
+		const auto nv = Utils::Clamp(op(v_a, v_b), _min, _max);
+		if (nv != v_a) {
+			changed.Add(i);
+		}
+		v_a = nv;
 	}
+	MarkChanged(changed.first, changed.last);
+}
+
+template <typename F>
+void Game_Variables::WriteRangeSimd(const int first_id, const int last_id, const Var_t value, F&& op) {
+	Var_t* vv = _variables.data();
+	ChangeTracker changed;
+	int i = std::max(0, first_id - 1);
+#ifdef EP_GAME_VARIABLES_SSE2
+	const __m128i r = _mm_set1_epi32(value);
+	const __m128i minval = _mm_set1_epi32(_min);
+	const __m128i maxval = _mm_set1_epi32(_max);
+	for (; i + 4 <= last_id; i += 4) {
+		auto* p = reinterpret_cast<__m128i*>(vv + i);
+		const __m128i v = _mm_loadu_si128(p);
+		const __m128i nv = SimdClamp(op(v, r), minval, maxval);
+		changed.Add4(i, _mm_movemask_epi8(_mm_cmpeq_epi32(v, nv)));
+		_mm_storeu_si128(p, nv);
+	}
+#endif
+	for (; i < last_id; ++i) {
+		const auto nv = Utils::Clamp(op(vv[i], value), _min, _max);
+		if (nv != vv[i]) {
+			changed.Add(i);
+		}
+		vv[i] = nv;
+	}
+	MarkChanged(changed.first, changed.last);
+}
+
+template <typename F>
+void Game_Variables::WriteArraySimd(const int first_id_a, const int last_id_a, const int first_id_b, F&& op) {
+	int i = std::max(0, first_id_a - 1);
+	const int out_b = std::max(0, first_id_b - 1);
+	// The scalar loop reads results of earlier iterations when the source
+	// is less than a vector behind the destination
+	const int distance = i - out_b;
+	if (distance > 0 && distance < 4) {
+		WriteArray(first_id_a, last_id_a, first_id_b, std::forward<F>(op));
+		return;
+	}
+
+	Var_t* vv = _variables.data();
+	const Var_t* src = vv + out_b - i;
+	ChangeTracker changed;
+#ifdef EP_GAME_VARIABLES_SSE2
+	const __m128i minval = _mm_set1_epi32(_min);
+	const __m128i maxval = _mm_set1_epi32(_max);
+	for (; i + 4 <= last_id_a; i += 4) {
+		auto* p = reinterpret_cast<__m128i*>(vv + i);
+		const __m128i v = _mm_loadu_si128(p);
+		const __m128i v_b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		const __m128i nv = SimdClamp(op(v, v_b), minval, maxval);
+		changed.Add4(i, _mm_movemask_epi8(_mm_cmpeq_epi32(v, nv)));
+		_mm_storeu_si128(p, nv);
+	}
+#endif
+	for (; i < last_id_a; ++i) {
+		const auto nv = Utils::Clamp(op(vv[i], src[i]), _min, _max);
+		if (nv != vv[i]) {
+			changed.Add(i);
+		}
+		vv[i] = nv;
+	}
+	MarkChanged(changed.first, changed.last);
+}
+
+bool Game_Variables::TakeChangedRange(int& first_id, int& last_id) {
+	if (changed_first > changed_last) {
+		return false;
+	}
+	first_id = changed_first + 1;
+	last_id = changed_last + 1;
+	changed_first = 0;
+	changed_last = -1;
+	return true;
 }
 
 Game_Variables::Var_t Game_Variables::Set(int variable_id, Var_t value) {
@@ -261,17 +481,17 @@ Game_Variables::Var_t Game_Variables::BitShiftRight(int variable_id, Var_t value
 
 void Game_Variables::SetRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] = {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarSet);
+	WriteRangeSimd(first_id, last_id, value, OpSet());
 }
 
 void Game_Variables::AddRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] += {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarAdd);
+	WriteRangeSimd(first_id, last_id, value, OpAdd());
 }
 
 void Game_Variables::SubRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] -= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarSub);
+	WriteRangeSimd(first_id, last_id, value, OpSub());
 }
 
 void Game_Variables::MultRange(int first_id, int last_id, Var_t value) {
@@ -291,27 +511,35 @@ void Game_Variables::ModRange(int first_id, int last_id, Var_t value) {
 
 void Game_Variables::BitOrRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] |= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitOr);
+	WriteRangeSimd(first_id, last_id, value, OpBitOr());
 }
 
 void Game_Variables::BitAndRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] &= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitAnd);
+	WriteRangeSimd(first_id, last_id, value, OpBitAnd());
 }
 
 void Game_Variables::BitXorRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] ^= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitXor);
+	WriteRangeSimd(first_id, last_id, value, OpBitXor());
 }
 
 void Game_Variables::BitShiftLeftRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] <<= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitShiftLeft);
+	if (IsValidShift(value)) {
+		WriteRangeSimd(first_id, last_id, value, OpBitShiftLeft());
+	} else {
+		WriteRange(first_id, last_id, [value](){ return value; }, VarBitShiftLeft);
+	}
 }
 
 void Game_Variables::BitShiftRightRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] >>= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitShiftRight);
+	if (IsValidShift(value)) {
+		WriteRangeSimd(first_id, last_id, value, OpBitShiftRight());
+	} else {
+		WriteRange(first_id, last_id, [value](){ return value; }, VarBitShiftRight);
+	}
 }
 
 template <typename F>
@@ -511,6 +739,7 @@ void Game_Variables::SortRange(int first_id, int last_id, bool asc) {
 			sorter(std::greater<>());
 		}
 	}
+	MarkChanged(i, last_id - 1);
 }
 
 void Game_Variables::ShuffleRange(int first_id, int last_id) {
@@ -520,6 +749,7 @@ void Game_Variables::ShuffleRange(int first_id, int last_id) {
 		int rnd_num = Rand::GetRandomNumber(first_id, last_id) - 1;
 		std::swap(vv[i], vv[rnd_num]);
 	}
+	MarkChanged(std::max(0, first_id - 1), last_id - 1);
 }
 
 void Game_Variables::SetArray(int first_id_a, int last_id_a, int first_id_b) {
@@ -527,28 +757,39 @@ void Game_Variables::SetArray(int first_id_a, int last_id_a, int first_id_b) {
 	// Maniac Patch uses memcpy which is actually a memmove
 	// This ensures overlapping areas are copied properly
 	if (first_id_a < first_id_b) {
-		WriteArray(first_id_a, last_id_a, first_id_b, VarSet);
+		WriteArraySimd(first_id_a, last_id_a, first_id_b, OpSet());
 	} else {
 		auto& vv = _variables;
+		ChangeTracker changed;
 		const int steps = std::max(0, last_id_a - first_id_a + 1);
 		int out_b = std::max(0, first_id_b + steps - 2);
 		int out_a = std::max(0, last_id_a - 1);
 		for (int i = 0; i < steps; ++i) {
-			auto& v_a = vv[out_a--];
+			auto& v_a = vv[out_a];
 			auto v_b = vv[out_b--];
-			v_a = Utils::Clamp(VarSet(v_a, v_b), _min, _max);
+			const auto nv = Utils::Clamp(VarSet(v_a, v_b), _min, _max);
+			if (nv != v_a) {
+				// Reverse order, the first change is the last index
+				if (changed.last < 0) {
+					changed.last = out_a;
+				}
+				changed.first = out_a;
+			}
+			v_a = nv;
+			--out_a;
 		}
+		MarkChanged(changed.first, changed.last);
 	}
 }
 
 void Game_Variables::AddArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] += var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarAdd);
+	WriteArraySimd(first_id_a, last_id_a, first_id_b, OpAdd());
 }
 
 void Game_Variables::SubArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] -= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarSub);
+	WriteArraySimd(first_id_a, last_id_a, first_id_b, OpSub());
 }
 
 void Game_Variables::MultArray(int first_id_a, int last_id_a, int first_id_b) {
@@ -568,17 +809,17 @@ void Game_Variables::ModArray(int first_id_a, int last_id_a, int first_id_b) {
 
 void Game_Variables::BitOrArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] |= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarBitOr);
+	WriteArraySimd(first_id_a, last_id_a, first_id_b, OpBitOr());
 }
 
 void Game_Variables::BitAndArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] &= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarBitAnd);
+	WriteArraySimd(first_id_a, last_id_a, first_id_b, OpBitAnd());
 }
 
 void Game_Variables::BitXorArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] ^= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarBitXor);
+	WriteArraySimd(first_id_a, last_id_a, first_id_b, OpBitXor());
 }
 
 void Game_Variables::BitShiftLeftArray(int first_id_a, int last_id_a, int first_id_b) {
@@ -595,11 +836,15 @@ void Game_Variables::SwapArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] <-> var[{},{}]!");
 	auto& vv = _variables;
 	const int steps = std::max(0, last_id_a - first_id_a + 1);
-	int out_b = std::max(0, first_id_b + steps - 2);
-	int out_a = std::max(0, last_id_a - 1);
+	const int last_b = std::max(0, first_id_b + steps - 2);
+	const int last_a = std::max(0, last_id_a - 1);
+	int out_b = last_b;
+	int out_a = last_a;
 	for (int i = 0; i < steps; ++i) {
 		std::swap(vv[out_a--], vv[out_b--]);
 	}
+	MarkChanged(out_a + 1, last_a);
+	MarkChanged(out_b + 1, last_b);
 }
 
 StringView Game_Variables::GetName(int _id) const {
@@ -140,6 +140,17 @@ public:
 	Var_t GetMinValue() const;
 
 	int GetMaxDigits() const;
+
+	/**
+	 * Returns the span of variables changed by range and array operations
+	 * since the last call and resets it. Variables written with their old
+	 * value are not part of the span.
+	 *
+	 * @param first_id receives the first changed variable
+	 * @param last_id receives the last changed variable
+	 * @return whether any variable was changed
+	 */
+	bool TakeChangedRange(int& first_id, int& last_id);
 private:
 	bool ShouldWarn(int first_id, int last_id) const;
 	void WarnGet(int variable_id) const;
@@ -155,12 +166,20 @@ private:
 		void WriteRangeVariable(const int first_id, const int last_id, int var_id, F&& op);
 	template <typename F>
 		void WriteArray(const int first_id_a, const int last_id_a, const int first_id_b, F&& op);
+	template <typename F>
+		void WriteRangeSimd(const int first_id, const int last_id, Var_t value, F&& op);
+	template <typename F>
+		void WriteArraySimd(const int first_id_a, const int last_id_a, const int first_id_b, F&& op);
+	void MarkChanged(int first_index, int last_index);
 
 	Variables_t _variables;
 	Var_t _min = 0;
 	Var_t _max = 0;
 	size_t lower_limit = 0;
 	mutable int _warnings = max_warnings;
+	/** Changed span of TakeChangedRange as indices, empty when last < first */
+	int changed_first = 0;
+	int changed_last = -1;
 };
 
 inline void Game_Variables::SetData(Variables_t v) {
@@ -218,4 +237,17 @@ inline Game_Variables::Var_t Game_Variables::GetMinValue() const {
 	return _min;
 }
 
+inline void Game_Variables::MarkChanged(int first_index, int last_index) {
+	if (first_index > last_index) {
+		return;
+	}
+	if (changed_first > changed_last) {
+		changed_first = first_index;
+		changed_last = last_index;
+	} else {
+		changed_first = std::min(changed_first, first_index);
+		changed_last = std::max(changed_last, last_index);
+	}
+}
+
 #endif
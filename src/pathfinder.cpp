@@ -0,0 +1,296 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <unordered_map>
+#include "pathfinder.h"
+#include "game_character.h"
+#include "game_map.h"
+#include "game_player.h"
+#include "game_vehicle.h"
+#include "main_data.h"
+
+namespace {
+	struct PathKey {
+		const Game_Character* self;
+		int from_x;
+		int from_y;
+		int dest_x;
+		int dest_y;
+		int search_limit;
+		bool allow_diagonal;
+		int layer;
+
+		bool operator==(const PathKey& o) const {
+			return self == o.self && from_x == o.from_x && from_y == o.from_y
+				&& dest_x == o.dest_x && dest_y == o.dest_y && search_limit == o.search_limit
+				&& allow_diagonal == o.allow_diagonal && layer == o.layer;
+		}
+	};
+
+	struct PathKeyHash {
+		size_t operator()(const PathKey& k) const {
+			size_t h = std::hash<const void*>()(k.self);
+			for (int v : { k.from_x, k.from_y, k.dest_x, k.dest_y, k.search_limit, k.layer, static_cast<int>(k.allow_diagonal) }) {
+				h = h * 31 + static_cast<size_t>(v);
+			}
+			return h;
+		}
+	};
+
+	struct CachedPath {
+		std::vector<int> directions;
+		bool reached = false;
+	};
+
+	constexpr size_t cache_limit = 256;
+
+	std::unordered_map<PathKey, CachedPath, PathKeyHash> cache;
+	int cache_map_id = 0;
+	int cache_revision = -1;
+	size_t cache_tile_events = 0;
+
+	Pathfinder::Stats stats;
+
+	struct Node {
+		uint32_t generation = 0;
+		int g = 0;
+		int8_t dir = -1;
+		bool closed = false;
+	};
+
+	struct OpenEntry {
+		int f;
+		int g;
+		int index;
+
+		bool operator<(const OpenEntry& o) const {
+			// Lowest cost first, on ties prefer the tile closer to the destination
+			return f != o.f ? f > o.f : g < o.g;
+		}
+	};
+
+	std::vector<Node> nodes;
+	std::vector<OpenEntry> open_list;
+	uint32_t generation = 0;
+
+	int Distance(int a, int b, int size, bool loop) {
+		int d = std::abs(a - b);
+		return loop ? std::min(d, size - d) : d;
+	}
+
+	bool CanStep(const Game_Character& self, int x, int y, int dx, int dy, bool check_events) {
+		auto check = [&](int fx, int fy, int tx, int ty) {
+			return Game_Map::CheckWay(self, fx, fy, tx, ty, check_events, nullptr);
+		};
+
+		if (dx && dy) {
+			// Same order as Game_Character::Move
+			return (check(x, y, x, y + dy) && check(x, y + dy, x + dx, y + dy))
+				|| (check(x, y, x + dx, y) && check(x + dx, y, x + dx, y + dy));
+		}
+		return check(x, y, x + dx, y + dy);
+	}
+
+	/**
+	 * Events with a tile graphic below the characters change the passability
+	 * of their tile, also for searches without events.
+	 */
+	size_t GetTileEventSignature() {
+		size_t h = 0;
+		for (auto& ev: Game_Map::GetEvents()) {
+			if (!ev.IsActive() || ev.GetActivePage() == nullptr || ev.GetThrough()
+					|| ev.GetLayer() != lcf::rpg::EventPage::Layers_below || ev.GetTileId() <= 0) {
+				continue;
+			}
+			for (int v : { ev.GetId(), ev.GetX(), ev.GetY(), ev.GetTileId() }) {
+				h = h * 31 + static_cast<size_t>(v);
+			}
+		}
+		return h;
+	}
+
+	bool Search(const Game_Character& self, int start_x, int start_y, int dest_x, int dest_y,
+			const Pathfinder::Params& params, bool check_events, std::vector<int>& directions) {
+		const int w = Game_Map::GetTilesX();
+		const int h = Game_Map::GetTilesY();
+		const bool loop_h = Game_Map::LoopHorizontal();
+		const bool loop_v = Game_Map::LoopVertical();
+		const int num_dirs = params.allow_diagonal ? 8 : 4;
+
+		auto heuristic = [&](int x, int y) {
+			int dx = Distance(x, dest_x, w, loop_h);
+			int dy = Distance(y, dest_y, h, loop_v);
+			return params.allow_diagonal ? std::max(dx, dy) : dx + dy;
+		};
+
+		nodes.resize(static_cast<size_t>(w) * h);
+		if (++generation == 0) {
+			std::fill(nodes.begin(), nodes.end(), Node());
+			generation = 1;
+		}
+		open_list.clear();
+
+		const int start = start_x + start_y * w;
+		const int dest = dest_x + dest_y * w;
+
+		nodes[start] = { generation, 0, -1, false };
+		open_list.push_back({ heuristic(start_x, start_y), 0, start });
+
+		int best = start;
+		int best_h = heuristic(start_x, start_y);
+		int expanded = 0;
+
+		while (!open_list.empty() && expanded < params.search_limit) {
+			std::pop_heap(open_list.begin(), open_list.end());
+			const OpenEntry cur = open_list.back();
+			open_list.pop_back();
+
+			Node& node = nodes[cur.index];
+			if (node.closed || cur.g != node.g) {
+				// Outdated entry
+				continue;
+			}
+			node.closed = true;
+			++expanded;
+
+			const int x = cur.index % w;
+			const int y = cur.index / w;
+			const int cur_h = cur.f - cur.g;
+			if (cur_h < best_h) {
+				best = cur.index;
+				best_h = cur_h;
+			}
+
+			if (cur.index == dest) {
+				break;
+			}
+
+			for (int dir = 0; dir < num_dirs; ++dir) {
+				const int dx = Game_Character::GetDxFromDirection(dir);
+				const int dy = Game_Character::GetDyFromDirection(dir);
+				const int nx = Game_Map::RoundX(x + dx);
+				const int ny = Game_Map::RoundY(y + dy);
+				if (!Game_Map::IsValid(nx, ny)) {
+					continue;
+				}
+
+				const int next = nx + ny * w;
+				const int g = cur.g + 1;
+				Node& next_node = nodes[next];
+				if (next_node.generation == generation && (next_node.closed || next_node.g <= g)) {
+					continue;
+				}
+
+				if (!CanStep(self, x, y, dx, dy, check_events)) {
+					continue;
+				}
+
+				next_node = { generation, g, static_cast<int8_t>(dir), false };
+				open_list.push_back({ g + heuristic(nx, ny), g, next });
+				std::push_heap(open_list.begin(), open_list.end());
+			}
+		}
+
+		stats.expanded += expanded;
+
+		directions.clear();
+		for (int index = best; index != start; ) {
+			const int dir = nodes[index].dir;
+			directions.push_back(dir);
+			const int x = Game_Map::RoundX(index % w - Game_Character::GetDxFromDirection(dir));
+			const int y = Game_Map::RoundY(index / w - Game_Character::GetDyFromDirection(dir));
+			index = x + y * w;
+		}
+		std::reverse(directions.begin(), directions.end());
+
+		return best == dest;
+	}
+}
+
+bool Pathfinder::FindPath(const Game_Character& character, int dest_x, int dest_y, const Params& params, std::vector<int>& directions) {
+	directions.clear();
+	++stats.searches;
+
+	// The player aboard a vehicle moves with the rules of the vehicle, like Game_Player::MakeWay
+	const Game_Character* mover = &character;
+	if (mover->GetType() == Game_Character::Player && Main_Data::game_player->IsAboard()) {
+		if (const auto* vehicle = Main_Data::game_player->GetVehicle()) {
+			mover = vehicle;
+		}
+	}
+	const Game_Character& self = *mover;
+
+	const int start_x = Game_Map::RoundX(self.GetX());
+	const int start_y = Game_Map::RoundY(self.GetY());
+	dest_x = Game_Map::RoundX(dest_x);
+	dest_y = Game_Map::RoundY(dest_y);
+
+	if (!Game_Map::IsValid(start_x, start_y) || !Game_Map::IsValid(dest_x, dest_y)) {
+		return false;
+	}
+
+	if (start_x == dest_x && start_y == dest_y) {
+		return true;
+	}
+
+	const bool check_events = params.check_events || self.GetType() == Game_Character::Vehicle;
+	if (check_events || self.GetThrough()) {
+		return Search(self, start_x, start_y, dest_x, dest_y, params, true, directions);
+	}
+
+	const size_t tile_events = GetTileEventSignature();
+	if (cache_map_id != Game_Map::GetMapId() || cache_revision != Game_Map::GetPassageRevision() || cache_tile_events != tile_events) {
+		cache.clear();
+		cache_map_id = Game_Map::GetMapId();
+		cache_revision = Game_Map::GetPassageRevision();
+		cache_tile_events = tile_events;
+	}
+
+	const PathKey key = { &self, start_x, start_y, dest_x, dest_y, params.search_limit, params.allow_diagonal, self.GetLayer() };
+	auto it = cache.find(key);
+	if (it != cache.end()) {
+		++stats.cache_hits;
+		directions = it->second.directions;
+		return it->second.reached;
+	}
+
+	bool reached = Search(self, start_x, start_y, dest_x, dest_y, params, false, directions);
+
+	if (cache.size() >= cache_limit) {
+		cache.clear();
+	}
+	cache[key] = { directions, reached };
+
+	return reached;
+}
+
+void Pathfinder::ClearCache() {
+	cache.clear();
+	cache_map_id = 0;
+	cache_revision = -1;
+	cache_tile_events = 0;
+	stats = {};
+}
+
+Pathfinder::Stats Pathfinder::GetStats() {
+	return stats;
+}
@@ -0,0 +1,76 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_PATHFINDER_H
+#define EP_PATHFINDER_H
+
+// Headers
+#include <vector>
+
+class Game_Character;
+
+/**
+ * A* path search on the current map.
+ *
+ * Every step is validated with Game_Map::CheckWay, so the path follows the
+ * same rules as a move route of the character (passability, vehicles,
+ * looping maps). Diagonal steps require both orthogonal ways to be free.
+ */
+namespace Pathfinder {
+	struct Params {
+		/** Maximum number of tiles expanded before the search gives up */
+		int search_limit = 10000;
+		/**
+		 * Events and vehicles block the way. Searches without events are
+		 * cached until the map passability or the tile events change.
+		 * Always enabled for vehicles and the player aboard one, their
+		 * terrain rules depend on it.
+		 */
+		bool check_events = false;
+		/** Allow diagonal steps */
+		bool allow_diagonal = false;
+	};
+
+	struct Stats {
+		int searches = 0;
+		int cache_hits = 0;
+		/** Tiles expanded by all searches */
+		int expanded = 0;
+	};
+
+	/**
+	 * Searches a path from the position of the character to a tile.
+	 * When the tile cannot be reached within the search limit the path
+	 * ends at the expanded tile closest to the destination.
+	 *
+	 * @param self character to move, the player aboard a vehicle moves as the vehicle
+	 * @param dest_x destination x
+	 * @param dest_y destination y
+	 * @param params search parameters
+	 * @param directions receives the directions of the steps (Game_Character::Up...)
+	 * @return Whether the path reaches the destination
+	 */
+	bool FindPath(const Game_Character& self, int dest_x, int dest_y, const Params& params, std::vector<int>& directions);
+
+	/** Drops all cached paths */
+	void ClearCache();
+
+	/** @return search statistics since the last ClearCache */
+	Stats GetStats();
+}
+
+#endif
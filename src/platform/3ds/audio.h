@@ -48,7 +48,10 @@ public:
 	void SE_Stop() override;
 	void Update() override;
 
-	void vGetConfig(Game_ConfigAudio&) const override {}
+	void vGetConfig(Game_ConfigAudio& cfg) const override {
+		// Not supported by this backend
+		cfg.bgm_crossfade.SetOptionVisible(false);
+	}
 
 	void LockMutex() const;
 	void UnlockMutex() const;
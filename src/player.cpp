@@ -35,6 +35,7 @@
 
 #include "async_handler.h"
 #include "audio.h"
+#include "battle_simulator.h"
 #include "cache.h"
 #include "rand.h"
 #include "cmdline_parser.h"
@@ -421,6 +422,7 @@ Game_Config Player::ParseCommandLine() {
 	no_audio_flag = false;
 	is_easyrpg_project = false;
 	Game_Battle::battle_test.enabled = false;
+	Game_Battle::battle_test.simulate_battles = 0;
 
 	std::stringstream ss;
 	for (size_t i = 1; i < arguments.size(); ++i) {
@@ -524,6 +526,16 @@ Game_Config Player::ParseCommandLine() {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 2, "--battle-simulate")) {
+			if (arg.NumValues() >= 2 && arg.ParseValue(0, li_value)) {
+				Game_Battle::battle_test.enabled = true;
+				Game_Battle::battle_test.troop_id = li_value;
+				if (arg.ParseValue(1, li_value) && li_value > 0) {
+					Game_Battle::battle_test.simulate_battles = li_value;
+				}
+			}
+			continue;
+		}
 		if (cp.ParseNext(arg, 1, "--project-path") && arg.NumValues() > 0) {
 			if (arg.NumValues() > 0) {
 				auto gamefs = FileFinder::Root().Create(FileFinder::MakeCanonical(arg.Value(0), 0));
@@ -962,6 +974,7 @@ void Player::GuessNonStandardExtensions() {
 void Player::LoadDatabase() {
 	// Load lcf::Database
 	lcf::Data::Clear();
+	Game_Battler::InvalidateAllStatCaches();
 
 	if (is_easyrpg_project) {
 		std::string edb = FileFinder::Game().FindFile(DATABASE_NAME_EASYRPG);
@@ -1256,6 +1269,27 @@ void Player::SetupBattleTest() {
 		Main_Data::game_party->SetupBattleTest();
 	}
 
+	if (Game_Battle::battle_test.simulate_battles > 0) {
+		BattleSimulator::Config config;
+		config.troop_id = args.troop_id;
+		config.battles = Game_Battle::battle_test.simulate_battles;
+		config.seed = rng_seed >= 0 ? static_cast<uint32_t>(rng_seed) : static_cast<uint32_t>(Rand::GetRandomNumber(0, INT32_MAX));
+
+		const auto start = Game_Clock::now();
+		auto result = BattleSimulator::Run(config);
+		const auto elapsed = std::chrono::duration<double>(Game_Clock::now() - start).count();
+
+		Output::Info("BattleSimulator: troop={} seed={} time={:.2f}s ({:.0f} battles/s)",
+				config.troop_id, config.seed, elapsed, elapsed > 0 ? result.battles / elapsed : 0.0);
+		for (auto& line : BattleSimulator::FormatReport(result)) {
+			Output::Info("{}", line);
+		}
+
+		Game_Battle::battle_test.enabled = false;
+		Scene::Pop();
+		return;
+	}
+
 	Scene::Push(Scene_Battle::Create(std::move(args)), true);
 }
 
@@ -1481,6 +1515,12 @@ Debug options:
                       Providing a single N sets the monster party.
                       Providing four N sets: monster party, formation,
                       condition and terrain ID.
+ --battle-simulate T N
+                      Simulate N battles against monster party T headless with
+                      autobattle on both sides and print a report. The party is
+                      the battle test party of the database. The battles run
+                      one after another on a single thread.
+                      The seed is taken from --seed.
  --hide-title         Hide the title background image and center the command
                       menu.
  --start-map-id N     Overwrite the map used for new games and use MapN.lmu
@@ -16,9 +16,12 @@
  */
 
 // Headers
+#include <algorithm>
 #include "sprite_character.h"
 #include "cache.h"
 #include "game_map.h"
+#include "game_event.h"
+#include "player.h"
 #include "bitmap.h"
 #include "output.h"
 
@@ -127,6 +130,22 @@ void Sprite_Character::ChipsetUpdated() {
 	refresh_bitmap = true;
 }
 
+bool Sprite_Character::IsIdleOffscreen() const {
+	if (character->GetType() != Game_Character::Event
+			|| static_cast<const Game_Event*>(character)->GetUpdateClass() != Game_Event::UpdateClass::Idle) {
+		return false;
+	}
+
+	// Anchored at the bottom center
+	const int width = std::max(chara_width, TILE_SIZE);
+	const int height = std::max(chara_height, TILE_SIZE);
+	const int x = character->GetScreenX() + x_offset;
+	const int y = character->GetScreenY() + y_offset;
+
+	return x + width / 2 < 0 || x - width / 2 > Player::screen_width
+		|| y < 0 || y - height > Player::screen_height;
+}
+
 Rect Sprite_Character::GetCharacterRect(StringView name, int index, const Rect bitmap_rect) {
 	Rect rect;
 	rect.width = 24 * (TILE_SIZE / 16) * 3;
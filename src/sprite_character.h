@@ -78,6 +78,15 @@ public:
 	 */
 	void ChipsetUpdated();
 
+	/**
+	 * Tests whether Update can be skipped: The character is an idle event
+	 * (see Game_Event::UpdateClass) and the sprite is outside of the screen.
+	 * Draw positions the sprite, so it updates normally again once visible.
+	 *
+	 * @return Whether the sprite is idle and not visible
+	 */
+	bool IsIdleOffscreen() const;
+
 private:
 	Game_Character* character;
 
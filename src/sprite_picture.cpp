@@ -24,6 +24,7 @@
 #include "game_windows.h"
 #include "player.h"
 #include "bitmap.h"
+#include <cmath>
 
 Sprite_Picture::Sprite_Picture(int pic_id, Drawable::Flags flags)
 	: Sprite(flags),
@@ -83,6 +84,15 @@ void Sprite_Picture::Draw(Bitmap& dst) {
 		return;
 	}
 
+	// Only older versions of RPG_RT apply the effects of current_bot_trans chunk.
+	const auto top_trans = data.current_top_trans;
+	const auto bottom_trans = feature_bottom_trans ? data.current_bot_trans : top_trans;
+
+	if (top_trans >= 100 && bottom_trans >= 100) {
+		// Fully transparent
+		return;
+	}
+
 	// RPG Maker 2k3 1.12: Spritesheets
 	if (feature_spritesheet
 			&& pic.NumSpriteSheetFrames() > 1
@@ -133,9 +143,9 @@ void Sprite_Picture::Draw(Bitmap& dst) {
 	SetWaverPhase(data.effect_mode == lcf::rpg::SavePicture::Effect_wave ? data.current_waver * (2 * M_PI) / 256 : 0.0);
 	SetWaverDepth(data.effect_mode == lcf::rpg::SavePicture::Effect_wave ? data.current_effect_power * 2 : 0);
 
-	// Only older versions of RPG_RT apply the effects of current_bot_trans chunk.
-	const auto top_trans = data.current_top_trans;
-	const auto bottom_trans = feature_bottom_trans ? data.current_bot_trans : top_trans;
+	if (IsOffScreen(dst)) {
+		return;
+	}
 
 	SetOpacity(
 		(int)(255 * (100 - top_trans) / 100),
@@ -168,6 +178,23 @@ void Sprite_Picture::Draw(Bitmap& dst) {
 	Sprite::Draw(dst);
 }
 
+bool Sprite_Picture::IsOffScreen(const Bitmap& dst) const {
+	// Bounding box around the center, rotation can turn the diagonal in any direction
+	const auto sr = GetSrcRect();
+	const double zoom_x = std::abs(GetZoomX());
+	const double zoom_y = std::abs(GetZoomY());
+	double half_w = sr.width / 2.0 * zoom_x + std::abs(GetRenderOx()) * std::max(zoom_x, 1.0);
+	double half_h = sr.height / 2.0 * zoom_y + std::abs(GetRenderOy()) * std::max(zoom_y, 1.0);
+	if (GetAngle() != 0.0) {
+		half_w = half_h = std::hypot(half_w, half_h);
+	}
+	half_w += std::abs(GetWaverDepth()) + 1;
+	half_h += 1;
+
+	return GetX() + half_w < 0 || GetX() - half_w > dst.GetWidth()
+		|| GetY() + half_h < 0 || GetY() - half_h > dst.GetHeight();
+}
+
 int Sprite_Picture::GetFrameWidth() const {
 	const auto& pic = Main_Data::game_pictures->GetPicture(pic_id);
 	const auto& data = pic.data;
@@ -45,6 +45,12 @@ public:
 	int GetFrameHeight() const;
 
 private:
+	/**
+	 * @param dst screen bitmap
+	 * @return Whether the transformed picture is entirely outside of the screen
+	 */
+	bool IsOffScreen(const Bitmap& dst) const;
+
 	int last_spritesheet_frame = -1;
 	const int pic_id = 0;
 	const bool feature_spritesheet = false;
@@ -89,7 +89,11 @@ void Spriteset_Map::Update() {
 	tilemap->SetOy(Game_Map::GetDisplayY() / (SCREEN_TILE_SIZE / TILE_SIZE));
 	tilemap->SetTone(new_tone);
 
+	const bool event_scheduling = Game_Map::IsEventSchedulingEnabled();
 	for (const auto& character_sprite : character_sprites) {
+		if (event_scheduling && character_sprite->IsIdleOffscreen()) {
+			continue;
+		}
 		character_sprite->Update();
 		character_sprite->SetTone(new_tone);
 	}
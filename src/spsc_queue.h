@@ -0,0 +1,100 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_SPSC_QUEUE_H
+#define EP_SPSC_QUEUE_H
+
+// Headers
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * A bounded lock-free queue for one producer and one consumer thread.
+ *
+ * The elements live in a fixed array, pushing and popping moves them and
+ * never allocates. Push must only be called by the producer and Pop by the
+ * consumer. The roles may change threads when the threads synchronize
+ * otherwise, e.g. through a mutex.
+ *
+ * @tparam T element type, must be default constructible and movable
+ * @tparam N capacity
+ */
+template <typename T, size_t N>
+class SpscQueue {
+public:
+	/**
+	 * Appends an element, called by the producer.
+	 *
+	 * @param value element, only moved from when it was pushed
+	 * @return false when the queue is full
+	 */
+	bool Push(T&& value);
+
+	/**
+	 * Removes the oldest element, called by the consumer.
+	 *
+	 * @param value receives the element
+	 * @return false when the queue is empty
+	 */
+	bool Pop(T& value);
+
+	/** @return whether the queue is empty, exact for the consumer */
+	bool IsEmpty() const;
+
+	/** @return maximum number of elements */
+	static constexpr size_t Capacity() {
+		return N;
+	}
+
+private:
+	std::array<T, N> slots = {};
+	/** Number of pushed elements, written by the producer */
+	std::atomic<size_t> tail = {0};
+	/** Number of popped elements, written by the consumer */
+	std::atomic<size_t> head = {0};
+};
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::Push(T&& value) {
+	const size_t t = tail.load(std::memory_order_relaxed);
+	if (t - head.load(std::memory_order_acquire) == N) {
+		return false;
+	}
+	slots[t % N] = std::move(value);
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::Pop(T& value) {
+	const size_t h = head.load(std::memory_order_relaxed);
+	if (h == tail.load(std::memory_order_acquire)) {
+		return false;
+	}
+	value = std::move(slots[h % N]);
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::IsEmpty() const {
+	return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+
+#endif
@@ -107,8 +107,12 @@
 #  define JOYSTICK_TRIGGER_SENSIBILITY 0.2
 #endif
 
-#if defined(HAVE_LIBSAMPLERATE) || defined(HAVE_LIBSPEEXDSP)
-#  define USE_AUDIO_RESAMPLER
+// Without libsamplerate and libspeexdsp the built-in resampler is used
+#define USE_AUDIO_RESAMPLER
+
+// Opens the music on a worker thread, not available without std::thread
+#if !defined(EMSCRIPTEN) && !defined(__wii__) && !defined(__3DS__) && !defined(PLAYER_AMIGA)
+#  define USE_AUDIO_WORKER_THREAD
 #endif
 
 #if defined(SUPPORT_MOUSE) || defined(SUPPORT_TOUCH)
@@ -62,28 +62,22 @@ void Window::Draw(Bitmap& dst) {
 	if (x < -width || x > dst.GetWidth() || y < -height || y > dst.GetHeight()) return;
 
 	if (windowskin) {
-		if (width > 4 && height > 4 && (back_opacity * opacity / 255 > 0)) {
-			if (background_needs_refresh) RefreshBackground();
+		int bopacity = (width > 4 && height > 4) ? back_opacity * opacity / 255 : 0;
+		int fopacity = (opacity > 0) ? frame_opacity * opacity / 255 : 0;
 
-			if (animation_frames > 0) {
-				int ianimation_count = (int)animation_count;
+		if (bopacity > 0 && background_needs_refresh) RefreshBackground();
+		if (fopacity > 0 && frame_needs_refresh) RefreshFrame();
 
+		if (animation_frames > 0) {
+			int ianimation_count = (int)animation_count;
+
+			if (bopacity > 0) {
 				Rect src_rect(0, height / 2 - ianimation_count, width, ianimation_count * 2);
 
-				dst.Blit(x, y + src_rect.y, *background, src_rect, back_opacity * opacity / 255);
-			} else {
-				dst.Blit(x, y, *background, background->GetRect(), back_opacity * opacity / 255);
+				dst.Blit(x, y + src_rect.y, *background, src_rect, bopacity);
 			}
-		}
-
-		if (width > 0 && height > 0 && opacity > 0) {
-			if (frame_needs_refresh) RefreshFrame();
-
-			int fopacity = frame_opacity * opacity / 255;
-
-			if (animation_frames > 0) {
-				int ianimation_count = (int)animation_count;
 
+			if (fopacity > 0) {
 				if (ianimation_count > 8) {
 					Rect src_rect(0, height / 2 - ianimation_count, 8, ianimation_count * 2 - 16);
 
@@ -101,18 +95,15 @@ void Window::Draw(Bitmap& dst) {
 					dst.Blit(x, y + height / 2 - ianimation_count, *frame_up, Rect(0, 0, width, ianimation_count), fopacity);
 					dst.Blit(x, y + height / 2 , *frame_down, Rect(0, 8 - ianimation_count, width, ianimation_count), fopacity);
 				}
-			} else {
-				dst.Blit(x, y, *frame_up, frame_up->GetRect(), fopacity);
-				dst.Blit(x, y + height - 8, *frame_down, frame_down->GetRect(), fopacity);
-
-				if (frame_left) {
-					dst.Blit(x, y + 8, *frame_left, frame_left->GetRect(), fopacity);
-				}
-
-				if (frame_right) {
-					dst.Blit(x + width - 8, y + 8, *frame_right, frame_right->GetRect(), fopacity);
-				}
 			}
+		} else if (bopacity > 0 || fopacity > 0) {
+			// Background and frame are static while the window is not animating.
+			// They are drawn with a single blit from a pre-composited bitmap.
+			if (composite_needs_refresh || composite_back_opacity != bopacity || composite_frame_opacity != fopacity) {
+				RefreshComposite(bopacity, fopacity);
+			}
+
+			dst.Blit(x, y, *composite, composite->GetRect(), 255);
 		}
 
 		if (width >= 16 && height > 16 && cursor_rect.width > 4 && cursor_rect.height > 4 && animation_frames == 0) {
@@ -177,6 +168,7 @@ void Window::Draw(Bitmap& dst) {
 
 void Window::RefreshBackground() {
 	background_needs_refresh = false;
+	composite_needs_refresh = true;
 
 	BitmapRef bitmap = Bitmap::Create(width, height);
 
@@ -191,6 +183,7 @@ void Window::RefreshBackground() {
 
 void Window::RefreshFrame() {
 	frame_needs_refresh = false;
+	composite_needs_refresh = true;
 
 	BitmapRef up_bitmap = Bitmap::Create(width, 8);
 	BitmapRef down_bitmap = Bitmap::Create(width, 8);
@@ -247,6 +240,36 @@ void Window::RefreshFrame() {
 	}
 }
 
+void Window::RefreshComposite(int bopacity, int fopacity) {
+	composite_needs_refresh = false;
+	composite_back_opacity = bopacity;
+	composite_frame_opacity = fopacity;
+
+	// Opacity changes during open and close animations keep the size
+	if (!composite || composite->width() != width || composite->height() != height) {
+		composite = Bitmap::Create(width, height);
+	}
+
+	composite->Clear();
+
+	if (bopacity > 0) {
+		composite->Blit(0, 0, *background, background->GetRect(), bopacity);
+	}
+
+	if (fopacity > 0) {
+		composite->Blit(0, 0, *frame_up, frame_up->GetRect(), fopacity);
+		composite->Blit(0, height - 8, *frame_down, frame_down->GetRect(), fopacity);
+
+		if (frame_left) {
+			composite->Blit(0, 8, *frame_left, frame_left->GetRect(), fopacity);
+		}
+
+		if (frame_right) {
+			composite->Blit(width - 8, 8, *frame_right, frame_right->GetRect(), fopacity);
+		}
+	}
+}
+
 void Window::RefreshCursor() {
 	cursor_needs_refresh = false;
 
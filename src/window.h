@@ -124,14 +124,20 @@ private:
 	BitmapRef
 		background, frame_down,
 		frame_up, frame_left, frame_right, cursor1, cursor2;
+	/** background and frame blended together, used when not animating */
+	BitmapRef composite;
 
 	void RefreshBackground();
 	void RefreshFrame();
 	void RefreshCursor();
+	void RefreshComposite(int bopacity, int fopacity);
 
 	bool background_needs_refresh;
 	bool frame_needs_refresh;
 	bool cursor_needs_refresh;
+	bool composite_needs_refresh = true;
+	int composite_back_opacity = -1;
+	int composite_frame_opacity = -1;
 	bool pause = false;
 
 	int cursor_frame = 0;
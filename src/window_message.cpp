@@ -185,10 +185,10 @@ void Window_Message::StartMessageProcessing(PendingMessage pm) {
 
 	item_max = min(4, pending_message.GetNumChoices());
 
-	text_index = text.data();
-
 	DebugLog("{}: MSG TEXT \n{}", text);
 
+	LayoutMessage();
+
 	auto open_frames = (!IsVisible() && !Game_Battle::IsBattleRunning()) ? message_animation_frames : 0;
 	SetOpenAnimation(open_frames);
 	DebugLog("{}: MSG START OPEN {}", open_frames);
@@ -196,6 +196,104 @@ void Window_Message::StartMessageProcessing(PendingMessage pm) {
 	InsertNewPage();
 }
 
+void Window_Message::LayoutMessage() {
+	using Type = MessageToken::Type;
+
+	tokens.clear();
+	token_index = 0;
+
+	// Same font that InsertNewPage will use for the pages of this message
+	FontRef font = GetFont() ? GetFont() : Font::Default();
+
+	const auto* iter = text.data();
+	const auto* end = iter + text.size();
+
+	while (iter != end) {
+		auto tret = Utils::TextNext(iter, end, Player::escape_char);
+		iter = tret.next;
+
+		if (EP_UNLIKELY(!tret)) {
+			continue;
+		}
+
+		const auto ch = tret.ch;
+		if (tret.is_exfont) {
+			tokens.push_back({ Type::ExFont, ch });
+			continue;
+		}
+
+		if (ch == '\f') {
+			tokens.push_back({ Type::NewPage, ch });
+			continue;
+		}
+
+		if (ch == '\n') {
+			tokens.push_back({ Type::NewLine, ch });
+			continue;
+		}
+
+		if (Utils::IsControlCharacter(ch)) {
+			// control characters not handled
+			continue;
+		}
+
+		if (tret.is_escape && ch != Player::escape_char) {
+			// Special message codes, the arguments are parsed now
+			int value = 0;
+			if (ch == 'c' || ch == 'C') {
+				auto pres = Game_Message::ParseColor(iter, end, Player::escape_char, true);
+				value = pres.value;
+				iter = pres.next;
+			} else if (ch == 's' || ch == 'S') {
+				auto pres = Game_Message::ParseSpeed(iter, end, Player::escape_char, true);
+				value = pres.value;
+				iter = pres.next;
+			}
+			tokens.push_back({ Type::Command, ch, value });
+			continue;
+		}
+
+		if (font->CanShape()) {
+			// Shape the text up to the next command or control character
+			auto iter_shape = iter;
+			std::u32string text32;
+			text32 += ch;
+
+			while (true) {
+				tret = Utils::TextNext(iter_shape, end, Player::escape_char);
+
+				if (EP_UNLIKELY(!tret)) {
+					break;
+				}
+
+				auto iter_prev_shape = iter_shape;
+				iter_shape = tret.next;
+				auto chs = tret.ch;
+
+				if (iter_shape == end || tret.is_exfont || tret.is_escape || Utils::IsControlCharacter(chs)) {
+					iter_shape = iter_prev_shape;
+					break;
+				}
+
+				text32 += tret.ch;
+			}
+			iter = iter_shape;
+
+			for (auto& shape: font->Shape(text32)) {
+				tokens.push_back({ Type::Shape, shape.code, 0, shape });
+			}
+			continue;
+		}
+
+		tokens.push_back({ Type::Glyph, ch });
+	}
+}
+
+bool Window_Message::IsNextToken(MessageToken::Type type, size_t offset) const {
+	size_t idx = token_index + offset;
+	return idx < tokens.size() && tokens[idx].type == type;
+}
+
 void Window_Message::OnFinishPage() {
 	DebugLog("{}: FINISH PAGE");
 
@@ -319,8 +417,7 @@ void Window_Message::InsertNewPage() {
 		ShowGoldWindow();
 	} else {
 		// If first character is gold, the gold window appears immediately and animates open with the main window.
-		auto tret = Utils::TextNext(text_index, (text.data() + text.size()), Player::escape_char);
-		if (tret && tret.is_escape && tret.ch == '$') {
+		if (IsNextToken(MessageToken::Type::Command) && tokens[token_index].ch == '$') {
 			ShowGoldWindow();
 		}
 	}
@@ -358,7 +455,8 @@ void Window_Message::InsertNewLine() {
 void Window_Message::FinishMessageProcessing() {
 	DebugLog("{}: FINISH MSG");
 	text.clear();
-	text_index = text.data();
+	tokens.clear();
+	token_index = 0;
 
 	SetPause(false);
 	kill_page = false;
@@ -465,60 +563,53 @@ void Window_Message::UpdateMessage() {
 
 	auto system = Cache::SystemOrBlack();
 
-	while (true) {
-		const auto* end = text.data() + text.size();
+	using Type = MessageToken::Type;
 
+	while (true) {
 		if (wait_count > 0) {
 			DebugLog("{}: MSG WAIT LOOP {}", wait_count);
 			--wait_count;
 			break;
 		}
 
-		if (!shape_ret.empty()) {
-			if (!DrawGlyph(*page_font, *system, shape_ret[0])) {
-				continue;
-			}
-
-			shape_ret.erase(shape_ret.begin());
-			continue;
-		}
-
 		if (GetPause() || GetIndex() >= 0 || number_input_window->GetActive()) {
 			break;
 		}
 
-		if (text_index == end) {
+		if (token_index == tokens.size()) {
 			FinishMessageProcessing();
 			break;
 		}
 
-		auto tret = Utils::TextNext(text_index, end, Player::escape_char);
-		auto text_prev = text_index;
-		text_index = tret.next;
+		// Advance first: The wait calculation of DrawGlyph looks at the tokens after the glyph
+		const auto& token = tokens[token_index++];
+		const auto ch = token.ch;
 
-		if (EP_UNLIKELY(!tret)) {
+		if (token.type == Type::Glyph || token.type == Type::ExFont) {
+			if (!DrawGlyph(*page_font, *system, ch, token.type == Type::ExFont)) {
+				--token_index;
+			}
 			continue;
 		}
 
-		const auto ch = tret.ch;
-		if (tret.is_exfont) {
-			if (!DrawGlyph(*page_font, *system, ch, true)) {
-				text_index = text_prev;
+		if (token.type == Type::Shape) {
+			if (!DrawGlyph(*page_font, *system, token.shape)) {
+				--token_index;
 			}
 			continue;
 		}
 
-		if (ch == '\f') {
-			if (text_index != end) {
+		if (token.type == Type::NewPage) {
+			if (token_index != tokens.size()) {
 				InsertNewPage();
 				SetWait(1);
 			}
 			continue;
 		}
 
-		if (ch == '\n') {
+		if (token.type == Type::NewLine) {
 			int wait_frames = 0;
-			bool end_page = (*text_index == '\f');
+			bool end_page = IsNextToken(Type::NewPage);
 
 			if (!instant_speed) {
 				if (!prev_char_printable) {
@@ -544,130 +635,81 @@ void Window_Message::UpdateMessage() {
 			continue;
 		}
 
-		if (Utils::IsControlCharacter(ch)) {
-			// control characters not handled
-			continue;
-		}
-
-		if (tret.is_escape && ch != Player::escape_char) {
-			// Special message codes
-			switch (ch) {
-			case 'c':
-			case 'C':
-				{
-					// Color
-					auto pres = Game_Message::ParseColor(text_index, end, Player::escape_char, true);
-					auto value = pres.value;
-					text_index = pres.next;
-					DebugLogText("{}: MSG Color \\c[{}]", value);
-					SetWaitForNonPrintable(0);
-					text_color = value > 19 ? 0 : value;
-				}
-				break;
-			case 's':
-			case 'S':
-				{
-					// Speed modifier
-					auto pres = Game_Message::ParseSpeed(text_index, end, Player::escape_char, true);
-					text_index = pres.next;
-					DebugLogText("{}: MSG Speed \\s[{}]", pres.value);
-					SetWaitForNonPrintable(0);
-					speed = Utils::Clamp(pres.value, 1, 20);
-				}
-				break;
-			case '_':
-				// Insert half size space
-				contents_x += Text::GetSize(*page_font, " ").width / 2;
-				DebugLogText("{}: MSG HalfWait \\_");
-				SetWaitForCharacter(1);
-				break;
-			case '$':
-				// Show Gold Window
-				ShowGoldWindow();
-				DebugLogText("{}: MSG Gold \\$");
-				SetWaitForNonPrintable(speed);
-				break;
-			case '!':
-				// Text pause
-				DebugLogText("{}: MSG Pause \\!");
+		// Special message codes
+		switch (ch) {
+		case 'c':
+		case 'C':
+			{
+				// Color
+				auto value = token.value;
+				DebugLogText("{}: MSG Color \\c[{}]", value);
 				SetWaitForNonPrintable(0);
-				SetPause(true);
-				break;
-			case '^':
-				// Force message close
-				// The close happens at the end of the message, not where
-				// the ^ is encountered
-				DebugLogText("{}: MSG Kill Page \\^");
-				kill_page = true;
-				SetWaitForNonPrintable(speed);
-				break;
-			case '>':
-				// Instant speed start
-				DebugLogText("{}: MSG Instant Speed Start \\>");
-				SetWaitForNonPrintable(0);
-				instant_speed = true;
-				break;
-			case '<':
-				// Instant speed stop - also cancels shift key and forces a delay.
-				instant_speed = false;
-				instant_speed_forced = false;
-				DebugLogText("{}: MSG Instant Speed Stop \\<");
-				SetWaitForNonPrintable(speed);
-				break;
-			case '.':
-				// 1/4 second sleep
-				// Despite documentation saying 1/4 second, RPG_RT waits for 16 frames.
-				// RPG_RT also has a bug(??) where speeds >= 17 slow this down by 1 more frame per speed.
-				SetWaitForNonPrintable(16 + Utils::Clamp(speed - 16, 0, 4));
-				DebugLogText("{}: MSG Quick Sleep \\.");
-				break;
-			case '|':
-				// Second sleep
-				// Despite documentation saying 1 second, RPG_RT waits for 61 frames.
-				SetWaitForNonPrintable(61);
-				DebugLogText("{}: MSG Sleep \\|");
-				break;
-			default:
-				// Unknown characters will not display anything but do wait.
-				SetWaitForNonPrintable(speed);
-				break;
-			}
-			continue;
-		}
-
-		if (page_font->CanShape()) {
-			assert(shape_ret.empty());
-
-			auto text_index_shape = text_index;
-			std::u32string text32;
-			text32 += ch;
-
-			while (true) {
-				tret = Utils::TextNext(text_index_shape, end, Player::escape_char);
-
-				if (EP_UNLIKELY(!tret)) {
-					break;
-				}
-
-				auto text_prev_shape = text_index_shape;
-				text_index_shape = tret.next;
-				auto chs = tret.ch;
-
-				if (text_index_shape == end || tret.is_exfont || tret.is_escape || Utils::IsControlCharacter(chs)) {
-					text_index = text_prev_shape;
-					break;
-				}
-
-				text32 += tret.ch;
-			}
-
-			shape_ret = page_font->Shape(text32);
-			continue;
-		} else {
-			if (!DrawGlyph(*page_font, *system, ch, false)) {
-				text_index = text_prev;
-				continue;
+				text_color = value > 19 ? 0 : value;
 			}
+			break;
+		case 's':
+		case 'S':
+			// Speed modifier
+			DebugLogText("{}: MSG Speed \\s[{}]", token.value);
+			SetWaitForNonPrintable(0);
+			speed = Utils::Clamp(token.value, 1, 20);
+			break;
+		case '_':
+			// Insert half size space
+			contents_x += Text::GetSize(*page_font, " ").width / 2;
+			DebugLogText("{}: MSG HalfWait \\_");
+			SetWaitForCharacter(1);
+			break;
+		case '$':
+			// Show Gold Window
+			ShowGoldWindow();
+			DebugLogText("{}: MSG Gold \\$");
+			SetWaitForNonPrintable(speed);
+			break;
+		case '!':
+			// Text pause
+			DebugLogText("{}: MSG Pause \\!");
+			SetWaitForNonPrintable(0);
+			SetPause(true);
+			break;
+		case '^':
+			// Force message close
+			// The close happens at the end of the message, not where
+			// the ^ is encountered
+			DebugLogText("{}: MSG Kill Page \\^");
+			kill_page = true;
+			SetWaitForNonPrintable(speed);
+			break;
+		case '>':
+			// Instant speed start
+			DebugLogText("{}: MSG Instant Speed Start \\>");
+			SetWaitForNonPrintable(0);
+			instant_speed = true;
+			break;
+		case '<':
+			// Instant speed stop - also cancels shift key and forces a delay.
+			instant_speed = false;
+			instant_speed_forced = false;
+			DebugLogText("{}: MSG Instant Speed Stop \\<");
+			SetWaitForNonPrintable(speed);
+			break;
+		case '.':
+			// 1/4 second sleep
+			// Despite documentation saying 1/4 second, RPG_RT waits for 16 frames.
+			// RPG_RT also has a bug(??) where speeds >= 17 slow this down by 1 more frame per speed.
+			SetWaitForNonPrintable(16 + Utils::Clamp(speed - 16, 0, 4));
+			DebugLogText("{}: MSG Quick Sleep \\.");
+			break;
+		case '|':
+			// Second sleep
+			// Despite documentation saying 1 second, RPG_RT waits for 61 frames.
+			SetWaitForNonPrintable(61);
+			DebugLogText("{}: MSG Sleep \\|");
+			break;
+		default:
+			// Unknown characters will not display anything but do wait.
+			SetWaitForNonPrintable(speed);
+			break;
 		}
 	}
 }
@@ -840,13 +882,10 @@ void Window_Message::SetWaitForNonPrintable(int frames) {
 void Window_Message::SetWaitForCharacter(int width) {
 	int frames = 0;
 	if (!instant_speed && width > 0) {
-		bool is_last_for_page;
-		if (!shape_ret.empty()) {
-			is_last_for_page = (shape_ret.size() == 1) && (
-				(text.data() + text.size() - text_index) <= 1 || (*text_index == '\n' && *(text_index + 1) == '\f'));
-		} else {
-			is_last_for_page = (text.data() + text.size() - text_index) <= 1 || (*text_index == '\n' && *(text_index + 1) == '\f');
-		}
+		// token_index points to the token after the glyph that was drawn.
+		// The text always ends with a page break, so one token left means end of text.
+		bool is_last_for_page = (tokens.size() - token_index) <= 1
+			|| (IsNextToken(MessageToken::Type::NewLine) && IsNextToken(MessageToken::Type::NewPage, 1));
 
 		if (is_last_for_page) {
 			// RPG_RT always waits 2 frames for last character on the page.
@@ -859,12 +898,7 @@ void Window_Message::SetWaitForCharacter(int width) {
 			} else {
 				frames = width / 2;
 				if (width & 1) {
-					bool is_last_for_line;
-					if (!shape_ret.empty()) {
-						is_last_for_line = shape_ret.size() == 1 && (*text_index == '\n');
-					} else {
-						is_last_for_line = (*text_index == '\n');
-					}
+					bool is_last_for_line = IsNextToken(MessageToken::Type::NewLine);
 					if (is_last_for_line) {
 						DebugLogText("{}: is_last_for_line");
 					}
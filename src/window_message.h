@@ -20,6 +20,7 @@
 
 // Headers
 #include <string>
+#include <vector>
 #include "window_gold.h"
 #include "window_numberinput.h"
 #include "window_selectable.h"
@@ -139,6 +140,32 @@ public:
 	void SetMaxLinesPerPage(int lines);
 
 protected:
+	/** A pre-parsed element of the message text, created by LayoutMessage. */
+	struct MessageToken {
+		enum class Type : uint8_t {
+			/** Glyph drawn with the page font */
+			Glyph,
+			/** Glyph drawn with the ExFont */
+			ExFont,
+			/** Glyph produced by the font shaper */
+			Shape,
+			/** Line break */
+			NewLine,
+			/** Page break */
+			NewPage,
+			/** Message command code (\c, \s, \$, ...) */
+			Command
+		};
+
+		Type type = Type::Glyph;
+		/** Codepoint of the glyph or character of the command */
+		char32_t ch = 0;
+		/** Parsed argument of the \c and \s commands */
+		int value = 0;
+		/** Shaping result when type is Shape */
+		Font::ShapeRet shape = {};
+	};
+
 	/** Async operation */
 	AsyncOp aop;
 	/** X-position of next char. */
@@ -149,10 +176,12 @@ protected:
 	int line_count = 0;
 	/** Maximum number of lines per page */
 	int max_lines_per_page = 4;
-	/** Index of the next char in text that will be output. */
-	const char* text_index = nullptr;
 	/** text message that will be displayed. */
 	std::string text;
+	/** text split into glyphs and commands, built once per message. */
+	std::vector<MessageToken> tokens;
+	/** Index of the next token that will be output. */
+	size_t token_index = 0;
 	/** Text color. */
 	int text_color = 0;
 	/** Current speed modifier. */
@@ -188,7 +217,18 @@ protected:
 
 	PendingMessage pending_message;
 
-	std::vector<Font::ShapeRet> shape_ret;
+	/**
+	 * Parses text into tokens. All command codes are parsed and text runs
+	 * are shaped here so that UpdateMessage only has to draw the glyphs.
+	 */
+	void LayoutMessage();
+
+	/**
+	 * @param type token type to check
+	 * @param offset offset relative to the next token
+	 * @return true if the token at the offset exists and is of the given type
+	 */
+	bool IsNextToken(MessageToken::Type type, size_t offset = 0) const;
 
 	bool DrawGlyph(Font& font, const Bitmap& system, char32_t glyph, bool is_exfont);
 	bool DrawGlyph(Font& font, const Bitmap& system, const Font::ShapeRet& shape);
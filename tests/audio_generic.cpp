@@ -0,0 +1,339 @@
+#include "system.h"
+
+#if defined(WANT_DRWAV) || defined(HAVE_LIBSNDFILE)
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "audio_generic.h"
+#include "audio_secache.h"
+#include "game_config.h"
+#include "doctest.h"
+
+namespace {
+/** Set while the test runs the audio callback */
+thread_local bool count_allocations = false;
+std::atomic<int> callback_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+	if (count_allocations) {
+		++callback_allocations;
+	}
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	if (p && count_allocations) {
+		++callback_allocations;
+	}
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	operator delete(p);
+}
+
+TEST_SUITE_BEGIN("GenericAudio");
+
+namespace {
+constexpr int frames_per_callback = 735;
+
+class TestAudio : public GenericAudio {
+public:
+	explicit TestAudio(const Game_ConfigAudio& cfg) : GenericAudio(cfg) {
+		SetFormat(44100, AudioDecoder::Format::S16, 2);
+	}
+
+	void LockMutex() const override {
+		mutex.lock();
+	}
+
+	void UnlockMutex() const override {
+		mutex.unlock();
+	}
+
+	/** @return the first left sample of one audio callback */
+	int Callback(int frames = frames_per_callback) {
+		count_allocations = true;
+		LockMutex();
+		Decode(reinterpret_cast<uint8_t*>(out.data()), frames * 2 * static_cast<int>(sizeof(int16_t)));
+		UnlockMutex();
+		count_allocations = false;
+		return out[0];
+	}
+
+	/** Updates like the main loop until the requested BGM plays */
+	void WaitForBgm() {
+		auto start = std::chrono::steady_clock::now();
+		while (BGM_GetType().empty() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+			Update();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		REQUIRE_FALSE(BGM_GetType().empty());
+	}
+
+private:
+	mutable std::mutex mutex;
+	std::vector<int16_t> out = std::vector<int16_t>(frames_per_callback * 2);
+};
+
+/** 16 bit samples with a constant value, 2 seconds of stereo by default */
+Filesystem_Stream::InputStream MakeWav(int16_t value, uint32_t frames = 88200, uint32_t rate = 44100, uint16_t channels = 2) {
+	const uint32_t data_size = frames * channels * 2;
+	std::vector<uint8_t> file;
+	auto put16 = [&](uint16_t v) {
+		file.push_back(v & 0xFF);
+		file.push_back(v >> 8);
+	};
+	auto put32 = [&](uint32_t v) {
+		put16(v & 0xFFFF);
+		put16(v >> 16);
+	};
+
+	file.insert(file.end(), { 'R', 'I', 'F', 'F' });
+	put32(36 + data_size);
+	file.insert(file.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+	put32(16);
+	put16(1);
+	put16(channels);
+	put32(rate);
+	put32(rate * channels * 2);
+	put16(channels * 2);
+	put16(16);
+	file.insert(file.end(), { 'd', 'a', 't', 'a' });
+	put32(data_size);
+	for (uint32_t i = 0; i < frames * channels; ++i) {
+		put16(static_cast<uint16_t>(value));
+	}
+
+	return Filesystem_Stream::InputStream(new Filesystem_Stream::InputMemoryStreamBuf(std::move(file)), "test.wav");
+}
+}
+
+TEST_CASE("PlayLoadsInBackground") {
+	Game_ConfigAudio cfg;
+	TestAudio audio(cfg);
+
+	audio.BGM_Play(MakeWav(4000), 100, 100, 0);
+	REQUIRE(audio.BGM_IsPlaying());
+	REQUIRE_EQ(audio.BGM_GetTicks(), 0);
+
+	// Nothing plays before the main loop picked up the loaded BGM
+	REQUIRE_EQ(audio.Callback(), 0);
+
+	audio.WaitForBgm();
+	REQUIRE_EQ(audio.Callback(), doctest::Approx(4000).epsilon(0.01));
+	REQUIRE(audio.BGM_IsPlaying());
+}
+
+TEST_CASE("StopDiscardsLoad") {
+	Game_ConfigAudio cfg;
+	TestAudio audio(cfg);
+
+	audio.BGM_Play(MakeWav(4000), 100, 100, 0);
+	audio.BGM_Stop();
+	REQUIRE_FALSE(audio.BGM_IsPlaying());
+
+	for (int i = 0; i < 100; ++i) {
+		audio.Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	REQUIRE_FALSE(audio.BGM_IsPlaying());
+	REQUIRE_EQ(audio.Callback(), 0);
+}
+
+TEST_CASE("UnsupportedFormat") {
+	Game_ConfigAudio cfg;
+	TestAudio audio(cfg);
+
+	std::vector<uint8_t> file(1000, 'x');
+	audio.BGM_Play(Filesystem_Stream::InputStream(new Filesystem_Stream::InputMemoryStreamBuf(std::move(file)), "test.xyz"), 100, 100, 0);
+	REQUIRE(audio.BGM_IsPlaying());
+
+	auto start = std::chrono::steady_clock::now();
+	while (audio.BGM_IsPlaying() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+		audio.Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	REQUIRE_FALSE(audio.BGM_IsPlaying());
+	REQUIRE_EQ(audio.Callback(), 0);
+}
+
+TEST_CASE("FaultyBgmStopsPlaying") {
+	Game_ConfigAudio cfg;
+	TestAudio audio(cfg);
+
+	// Opens fine, but decoding never returns data
+	audio.BGM_Play(MakeWav(4000, 0), 100, 100, 0);
+	audio.WaitForBgm();
+	REQUIRE(audio.BGM_IsPlaying());
+
+	REQUIRE_EQ(audio.Callback(), 0);
+	REQUIRE_FALSE(audio.BGM_IsPlaying());
+}
+
+TEST_CASE("ChangeWithoutCrossfade") {
+	Game_ConfigAudio cfg;
+	TestAudio audio(cfg);
+
+	audio.BGM_Play(MakeWav(4000), 100, 100, 0);
+	audio.WaitForBgm();
+
+	// The previous BGM stops right away
+	audio.BGM_Play(MakeWav(-2000), 100, 100, 0);
+	REQUIRE_EQ(audio.Callback(), 0);
+
+	audio.WaitForBgm();
+	REQUIRE_EQ(audio.Callback(), doctest::Approx(-2000).epsilon(0.01));
+}
+
+TEST_CASE("Crossfade") {
+	Game_ConfigAudio cfg;
+	cfg.bgm_crossfade.Set(500);
+	TestAudio audio(cfg);
+
+	audio.BGM_Play(MakeWav(4000), 100, 100, 0);
+	audio.WaitForBgm();
+
+	// The previous BGM plays until the new one is loaded
+	audio.BGM_Play(MakeWav(-2000), 100, 100, 0);
+	REQUIRE_EQ(audio.Callback(), doctest::Approx(4000).epsilon(0.01));
+
+	audio.WaitForBgm();
+	int first = audio.Callback();
+	REQUIRE_GT(first, 0);
+
+	// Fades out within 500 ms (decoders advance 1/60 s per callback)
+	int last = first;
+	for (int i = 0; i < 30; ++i) {
+		int sample = audio.Callback();
+		REQUIRE_LE(sample, last);
+		last = sample;
+	}
+	REQUIRE_EQ(audio.Callback(), doctest::Approx(-2000).epsilon(0.01));
+	REQUIRE_EQ(audio.BGM_GetType(), "wav");
+}
+
+TEST_CASE("CallbackDoesNotAllocate") {
+	Game_ConfigAudio cfg;
+	cfg.bgm_crossfade.Set(200);
+	TestAudio audio(cfg);
+
+	audio.BGM_Play(MakeWav(4000), 100, 100, 0);
+	audio.WaitForBgm();
+
+	// The first callback sizes the mixing buffers
+	audio.Callback();
+	callback_allocations = 0;
+
+	// Short SE, resampled and converted to the output format, a crossfade and
+	// smaller callbacks. The finished decoders are freed by Update.
+	for (int i = 0; i < 120; ++i) {
+		if (i % 10 == 0) {
+			auto se = AudioSeCache::Create(MakeWav(1000, 1000, 22050, 1), "se" + std::to_string(i % 3));
+			REQUIRE(se);
+			audio.SE_Play(std::move(se), 100, i % 20 == 0 ? 100 : 150);
+		}
+		if (i == 30) {
+			audio.BGM_Play(MakeWav(-2000), 100, 100, 0);
+			audio.WaitForBgm();
+		}
+		if (i == 95) {
+			audio.SE_Stop();
+		}
+		audio.Update();
+		audio.Callback(i % 2 ? frames_per_callback : frames_per_callback / 2);
+	}
+
+	REQUIRE_EQ(callback_allocations, 0);
+	REQUIRE_EQ(audio.Callback(), doctest::Approx(-2000).epsilon(0.01));
+	REQUIRE_EQ(audio.GetStallStatistics().stalls, 0);
+}
+
+TEST_CASE("PlayedOnce") {
+	Game_ConfigAudio cfg;
+	TestAudio audio(cfg);
+
+	// 50 ms, loops after 3 callbacks
+	audio.BGM_Play(MakeWav(4000, 2205), 100, 100, 0);
+	audio.WaitForBgm();
+	REQUIRE_FALSE(audio.BGM_PlayedOnce());
+
+	for (int i = 0; i < 5; ++i) {
+		audio.Callback();
+	}
+	REQUIRE(audio.BGM_PlayedOnce());
+
+	// Reported before the audio callback ran again
+	audio.BGM_Stop();
+	REQUIRE_FALSE(audio.BGM_IsPlaying());
+	REQUIRE_FALSE(audio.BGM_PlayedOnce());
+	REQUIRE_EQ(audio.BGM_GetTicks(), 0);
+	REQUIRE_EQ(audio.Callback(), 0);
+}
+
+TEST_CASE("FullQueueWaitsForLock") {
+	Game_ConfigAudio cfg;
+	TestAudio audio(cfg);
+
+	// Without audio callbacks the commands are processed by the caller
+	for (int i = 0; i < 300; ++i) {
+		auto se = AudioSeCache::Create(MakeWav(1000, 1000, 22050, 1), "se");
+		REQUIRE(se);
+		audio.SE_Play(std::move(se), 100, 100);
+	}
+	auto stats = audio.GetStallStatistics();
+	REQUIRE_EQ(stats.commands, 300);
+	REQUIRE_GT(stats.stalls, 0);
+	REQUIRE_GE(stats.max_stall.count(), 0);
+
+	audio.Update();
+	REQUIRE_GT(audio.Callback(), 0);
+}
+
+TEST_CASE("SeCacheEvictsLeastRecentlyUsed") {
+	AudioSeCache::Clear();
+	AudioSeCache::SetOutputFrequency(0);
+	AudioSeCache::SetMemoryLimit(1024 * 1024);
+
+	auto preload = [](const char* name) {
+		auto se = AudioSeCache::Create(MakeWav(1000, 1000), name);
+		REQUIRE(se);
+		se->Preload();
+	};
+
+	// 4000 bytes each
+	preload("a");
+	preload("b");
+	preload("c");
+
+	// Used again, "b" is the least recently used now
+	AudioSeCache::GetCachedSe("a")->CreateSeDecoder();
+
+	AudioSeCache::SetMemoryLimit(8000);
+	REQUIRE(AudioSeCache::GetCachedSe("a"));
+	REQUIRE_FALSE(AudioSeCache::GetCachedSe("b"));
+	REQUIRE(AudioSeCache::GetCachedSe("c"));
+
+	// "c" is the least recently used but still playing
+	auto playing = AudioSeCache::GetCachedSe("c")->GetSeData();
+	preload("d");
+	REQUIRE_FALSE(AudioSeCache::GetCachedSe("a"));
+	REQUIRE(AudioSeCache::GetCachedSe("c"));
+	REQUIRE(AudioSeCache::GetCachedSe("d"));
+
+	AudioSeCache::Clear();
+	AudioSeCache::SetMemoryLimit(8 * 1024 * 1024);
+}
+
+TEST_SUITE_END();
+
+#endif
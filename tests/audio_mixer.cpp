@@ -0,0 +1,89 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "audio_mixer.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("AudioMixer");
+
+using Format = AudioDecoderBase::Format;
+
+TEST_CASE("AccumulateStereo") {
+	// Odd length to cover the scalar tail
+	const std::vector<int16_t> src = { 16384, -16384, 32767, -32768, 0, 8192, -8192, 4096, 1, -1, 100, 200, 300, 400 };
+	std::vector<float> mix(src.size(), 0.25f);
+
+	AudioMixer::Accumulate(mix.data(), src.data(), Format::S16, 2, 7, 0.5f);
+
+	for (size_t i = 0; i < src.size(); ++i) {
+		REQUIRE_EQ(mix[i], doctest::Approx(0.25 + src[i] / 32768.0 * 0.5));
+	}
+}
+
+TEST_CASE("AccumulateMono") {
+	const std::vector<float> src = { 0.5f, -0.5f, 1.0f, -1.0f, 0.25f };
+	std::vector<float> mix(src.size() * 2, 0.0f);
+
+	AudioMixer::Accumulate(mix.data(), src.data(), Format::F32, 1, 5, 1.0f);
+
+	for (size_t i = 0; i < src.size(); ++i) {
+		REQUIRE_EQ(mix[i * 2], src[i]);
+		REQUIRE_EQ(mix[i * 2 + 1], src[i]);
+	}
+}
+
+TEST_CASE("AccumulateFormats") {
+	const std::vector<uint8_t> u8 = { 0, 64, 128, 255 };
+	const std::vector<uint16_t> u16 = { 0, 16384, 32768, 65535 };
+	const std::vector<int32_t> s32 = { INT32_MIN, -1073741824, 0, 1073741824 };
+	const std::vector<double> expected = { -1.0, -0.5, 0.0, 0.5 };
+
+	std::vector<float> mix(4, 0.0f);
+	AudioMixer::Accumulate(mix.data(), u8.data(), Format::U8, 2, 2, 1.0f);
+	for (int i = 0; i < 3; ++i) {
+		REQUIRE_EQ(mix[i], doctest::Approx(expected[i]));
+	}
+
+	mix.assign(4, 0.0f);
+	AudioMixer::Accumulate(mix.data(), u16.data(), Format::U16, 2, 2, 1.0f);
+	for (int i = 0; i < 3; ++i) {
+		REQUIRE_EQ(mix[i], doctest::Approx(expected[i]));
+	}
+
+	mix.assign(4, 0.0f);
+	AudioMixer::Accumulate(mix.data(), s32.data(), Format::S32, 2, 2, 1.0f);
+	for (int i = 0; i < 4; ++i) {
+		REQUIRE_EQ(mix[i], doctest::Approx(expected[i]));
+	}
+}
+
+TEST_CASE("Limit") {
+	const std::vector<float> mix = { 0.0f, 0.5f, -0.5f, 0.79f, 1.0f, -1.0f, 1.5f, -1.5f, 0.25f };
+	std::vector<int16_t> out(mix.size());
+
+	SUBCASE("clip") {
+		AudioMixer::Limit(out.data(), mix.data(), static_cast<int>(mix.size()), 1.0f);
+		REQUIRE_EQ(out[0], 0);
+		REQUIRE_EQ(out[1], 16384);
+		REQUIRE_EQ(out[2], -16384);
+		REQUIRE_EQ(out[4], 32767);
+		REQUIRE_EQ(out[5], -32768);
+		REQUIRE_EQ(out[6], 32767);
+		REQUIRE_EQ(out[7], -32768);
+		REQUIRE_EQ(out[8], 8192);
+	}
+
+	SUBCASE("compress") {
+		AudioMixer::Limit(out.data(), mix.data(), static_cast<int>(mix.size()), 2.0f);
+		// Below the threshold nothing changes
+		REQUIRE_EQ(out[1], 16384);
+		REQUIRE_EQ(out[3], static_cast<int16_t>(0.79f * 32768.0f));
+		// Above it the range up to the total volume is mapped into the headroom
+		REQUIRE_EQ(out[4], doctest::Approx((0.8 + 0.2 / 6.0) * 32768.0).epsilon(0.001));
+		REQUIRE_EQ(out[5], -out[4]);
+		REQUIRE_EQ(out[6], doctest::Approx((0.8 + 0.7 / 6.0) * 32768.0).epsilon(0.001));
+		REQUIRE_EQ(out[7], -out[6]);
+	}
+}
+
+TEST_SUITE_END();
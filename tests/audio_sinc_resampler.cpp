@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "audio_sinc_resampler.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("AudioSincResampler");
+
+namespace {
+constexpr double pi = 3.14159265358979323846;
+
+using Quality = AudioSincResampler::Quality;
+
+/** Interleaved sine, frequency relative to the sample rate */
+std::vector<float> MakeSine(int frames, int channels, double freq) {
+	std::vector<float> data(frames * channels);
+	for (int i = 0; i < frames; ++i) {
+		for (int c = 0; c < channels; ++c) {
+			// Every channel has a different phase
+			data[i * channels + c] = static_cast<float>(0.5 * std::sin(2.0 * pi * freq * i + c));
+		}
+	}
+	return data;
+}
+
+/** Feeds the input in odd sized chunks and reads until the end */
+std::vector<float> Resample(AudioSincResampler& r, const std::vector<float>& in) {
+	const int channels = r.GetChannels();
+	const int frames = static_cast<int>(in.size()) / channels;
+
+	std::vector<float> out;
+	std::vector<float> buf(61 * channels);
+	int pos = 0;
+	bool finished = false;
+	for (;;) {
+		int n = r.Read(buf.data(), 61);
+		out.insert(out.end(), buf.begin(), buf.begin() + n * channels);
+		if (n > 0) {
+			continue;
+		}
+		if (pos < frames) {
+			int count = std::min(97, frames - pos);
+			r.Write(&in[pos * channels], count);
+			pos += count;
+		} else if (!finished) {
+			r.Finish();
+			finished = true;
+		} else {
+			break;
+		}
+	}
+	return out;
+}
+
+/** @return SNR in dB of the resampled sine, the borders are skipped */
+double SineSnr(const std::vector<float>& out, int channels, double freq, double ratio) {
+	const int frames = static_cast<int>(out.size()) / channels;
+	double signal = 0.0;
+	double noise = 0.0;
+	for (int j = 100; j < frames - 100; ++j) {
+		for (int c = 0; c < channels; ++c) {
+			double ideal = 0.5 * std::sin(2.0 * pi * freq * j * ratio + c);
+			double err = out[j * channels + c] - ideal;
+			signal += ideal * ideal;
+			noise += err * err;
+		}
+	}
+	return 10.0 * std::log10(signal / noise);
+}
+}
+
+TEST_CASE("Passthrough") {
+	AudioSincResampler r(1, Quality::Medium);
+	auto in = MakeSine(1000, 1, 0.01);
+	auto out = Resample(r, in);
+
+	REQUIRE_EQ(out.size(), in.size());
+	for (size_t i = 0; i < in.size(); ++i) {
+		REQUIRE_EQ(out[i], doctest::Approx(in[i]).epsilon(0.001));
+	}
+}
+
+TEST_CASE("Length") {
+	for (double ratio : { 0.5, 0.75, 1.5, 2.0 }) {
+		AudioSincResampler r(2, Quality::Low);
+		r.SetRatio(ratio);
+		auto out = Resample(r, MakeSine(22050, 2, 0.01));
+
+		REQUIRE_EQ(static_cast<double>(out.size() / 2), doctest::Approx(22050 / ratio).epsilon(0.001));
+	}
+}
+
+TEST_CASE("Quality") {
+	const double freq = 1000.0 / 22050.0;
+
+	auto check = [&](Quality quality, double min_snr) {
+		for (double ratio : { 0.5, 2.0 }) {
+			CAPTURE(ratio);
+			AudioSincResampler r(2, quality);
+			r.SetRatio(ratio);
+			auto out = Resample(r, MakeSine(22050, 2, freq));
+			REQUIRE_GT(SineSnr(out, 2, freq, ratio), min_snr);
+		}
+	};
+
+	SUBCASE("low") {
+		check(Quality::Low, 30.0);
+	}
+	SUBCASE("medium") {
+		check(Quality::Medium, 65.0);
+	}
+	SUBCASE("high") {
+		check(Quality::High, 85.0);
+	}
+}
+
+TEST_CASE("AntiAliasing") {
+	// Above the output Nyquist when downsampling by 2
+	const double freq = 0.35;
+	auto in = MakeSine(8000, 1, freq);
+
+	AudioSincResampler r(1, Quality::High);
+	r.SetRatio(2.0);
+	auto out = Resample(r, in);
+
+	double energy = 0.0;
+	for (size_t j = 100; j < out.size() - 100; ++j) {
+		energy += out[j] * out[j];
+	}
+	double rms = std::sqrt(energy / (out.size() - 200));
+	REQUIRE_LT(rms, 0.01);
+}
+
+TEST_CASE("RatioChange") {
+	const double freq = 0.01;
+	auto in = MakeSine(20000, 1, freq);
+
+	AudioSincResampler r(1, Quality::Medium);
+	r.SetRatio(0.5);
+
+	// Switch the pitch in the middle of the stream, the phase continues
+	std::vector<float> out(30000);
+	int pos = 0;
+	int produced = 0;
+	double t = 0.0;
+	double max_err = 0.0;
+	while (produced < 30000 && pos < 20000) {
+		if (produced >= 10000 && r.GetRatio() != 1.5) {
+			r.SetRatio(1.5);
+		}
+		int n = r.Read(&out[produced], 1);
+		if (n == 0) {
+			r.Write(&in[pos], 100);
+			pos += 100;
+			continue;
+		}
+		if (produced > 100) {
+			max_err = std::max(max_err, std::abs(out[produced] - 0.5 * std::sin(2.0 * pi * freq * t)));
+		}
+		t += r.GetRatio();
+		++produced;
+	}
+
+	REQUIRE_GT(produced, 19900);
+	REQUIRE_LT(max_err, 0.001);
+}
+
+TEST_CASE("Reset") {
+	AudioSincResampler r(1, Quality::Low);
+	auto in = MakeSine(500, 1, 0.02);
+	auto a = Resample(r, in);
+	r.Reset();
+	auto b = Resample(r, in);
+
+	REQUIRE_EQ(a, b);
+}
+
+TEST_SUITE_END();
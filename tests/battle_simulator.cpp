@@ -0,0 +1,87 @@
+#include "test_mock_actor.h"
+#include "battle_simulator.h"
+#include "game_actor.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("BattleSimulator");
+
+static Game_Actor* SetupParty() {
+	MakeDBActor(1, 1, 50, 100, 0, 100, 10, 10, 10);
+	MakeDBEnemy(1, 50, 0, 10, 10, 10, 10);
+
+	auto* actor = Main_Data::game_party->GetActors()[0];
+	actor->SetHp(actor->GetMaxHp());
+	return actor;
+}
+
+TEST_CASE("Distribution") {
+	BattleSimulator::Distribution d;
+	REQUIRE_EQ(d.GetPercentile(50), 0);
+
+	for (int i = 10; i > 0; --i) {
+		d.Add(i);
+	}
+
+	REQUIRE_EQ(d.GetCount(), 10);
+	REQUIRE_EQ(d.GetMin(), 1);
+	REQUIRE_EQ(d.GetMax(), 10);
+	REQUIRE_EQ(d.GetMean(), doctest::Approx(5.5));
+	REQUIRE_EQ(d.GetPercentile(0), 1);
+	REQUIRE_EQ(d.GetPercentile(50), 5);
+	REQUIRE_EQ(d.GetPercentile(90), 9);
+	REQUIRE_EQ(d.GetPercentile(100), 10);
+}
+
+TEST_CASE("Victory") {
+	const MockBattle mb(1, 1);
+	auto* actor = SetupParty();
+
+	BattleSimulator::Config config;
+	config.battles = 20;
+	config.seed = 1;
+	auto result = BattleSimulator::Run(config);
+
+	REQUIRE_EQ(result.battles, 20);
+	REQUIRE_EQ(result.victories, 20);
+	REQUIRE_EQ(result.turns.GetCount(), 20);
+	REQUIRE_GE(result.turns.GetMin(), 1);
+	REQUIRE_GT(result.party_hit_damage.GetCount(), 0);
+	REQUIRE_EQ(result.troop_hit_damage.GetCount(), 0);
+	REQUIRE_EQ(result.party_damage_taken.GetMax(), 0);
+	REQUIRE_EQ(result.troop_damage_taken.GetMin(), 50);
+	REQUIRE_EQ(result.troop_damage_taken.GetMax(), 50);
+
+	// The party is restored after the simulation
+	REQUIRE_EQ(actor->GetHp(), 100);
+	REQUIRE(Game_Battle::IsBattleRunning());
+}
+
+TEST_CASE("Deterministic") {
+	const MockBattle mb(1, 1);
+	SetupParty();
+
+	BattleSimulator::Config config;
+	config.battles = 50;
+	config.seed = 7;
+
+	auto a = BattleSimulator::Run(config);
+	auto b = BattleSimulator::Run(config);
+
+	REQUIRE_EQ(a.victories, b.victories);
+	REQUIRE_EQ(a.turns.GetMean(), b.turns.GetMean());
+	REQUIRE_EQ(a.party_hit_damage.GetCount(), b.party_hit_damage.GetCount());
+	REQUIRE_EQ(a.party_hit_damage.GetMean(), b.party_hit_damage.GetMean());
+}
+
+TEST_CASE("InvalidTroop") {
+	const MockBattle mb(1, 1);
+	SetupParty();
+
+	BattleSimulator::Config config;
+	config.troop_id = 999;
+	auto result = BattleSimulator::Run(config);
+
+	REQUIRE_EQ(result.battles, 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,113 @@
+#include <cstring>
+#include <random>
+#include "bitmap.h"
+#include "bitmap_blit.h"
+#include "pixel_format.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("BitmapBlit");
+
+namespace {
+std::mt19937 rng(1234);
+
+int Random(int lo, int hi) {
+	return std::uniform_int_distribution<int>(lo, hi)(rng);
+}
+
+/** Premultiplied pixels, a quarter fully transparent and a quarter opaque */
+BitmapRef MakeRandomBitmap(int w, int h) {
+	auto bitmap = Bitmap::Create(w, h, true);
+	const auto& format = Bitmap::pixel_format;
+
+	for (int y = 0; y < h; ++y) {
+		auto* row = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(bitmap->pixels()) + y * bitmap->pitch());
+		for (int x = 0; x < w; ++x) {
+			int a;
+			switch (Random(0, 3)) {
+				case 0: a = 0; break;
+				case 1: a = 255; break;
+				default: a = Random(1, 254); break;
+			}
+			row[x] = format.r.pack(Random(0, a)) | format.g.pack(Random(0, a))
+				| format.b.pack(Random(0, a)) | format.a.pack(a);
+		}
+	}
+	return bitmap;
+}
+
+BitmapRef Copy(const Bitmap& src) {
+	auto bitmap = Bitmap::Create(src.width(), src.height(), true);
+	for (int y = 0; y < src.height(); ++y) {
+		memcpy(static_cast<uint8_t*>(bitmap->pixels()) + y * bitmap->pitch(),
+			static_cast<const uint8_t*>(src.pixels()) + y * src.pitch(), src.width() * 4);
+	}
+	return bitmap;
+}
+
+bool Equal(const Bitmap& a, const Bitmap& b) {
+	for (int y = 0; y < a.height(); ++y) {
+		if (memcmp(static_cast<const uint8_t*>(a.pixels()) + y * a.pitch(),
+				static_cast<const uint8_t*>(b.pixels()) + y * b.pitch(), a.width() * 4) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Runs the blit with the kernels and with pixman on copies of dst and compares the bytes */
+template <typename F>
+void CheckSame(const Bitmap& dst, F&& blit) {
+	auto kernel = Copy(dst);
+	auto reference = Copy(dst);
+
+	BitmapBlit::SetEnabled(true);
+	blit(*kernel);
+	BitmapBlit::SetEnabled(false);
+	blit(*reference);
+	BitmapBlit::SetEnabled(true);
+
+	REQUIRE(Equal(*kernel, *reference));
+}
+
+void TestFormat(const DynamicFormat& format) {
+	Bitmap::SetFormat(format);
+	REQUIRE(BitmapBlit::IsFormatSupported(Bitmap::pixel_format));
+
+	for (int i = 0; i < 200; ++i) {
+		// Odd sizes to cover the scalar tail after the four pixel steps
+		auto src = MakeRandomBitmap(Random(1, 37), Random(1, 13));
+		auto dst = MakeRandomBitmap(Random(1, 41), Random(1, 17));
+
+		const int sx = Random(0, src->width() - 1);
+		const int sy = Random(0, src->height() - 1);
+		const Rect src_rect(sx, sy, Random(1, src->width() - sx), Random(1, src->height() - sy));
+		// Partly outside of the destination to cover clipping
+		const int x = Random(-8, dst->width());
+		const int y = Random(-8, dst->height());
+		const int opacity = Random(0, 3) == 0 ? 255 : Random(1, 255);
+		const bool flip_x = Random(0, 1);
+		const bool flip_y = Random(0, 1);
+
+		CAPTURE(i);
+		CheckSame(*dst, [&](Bitmap& b) { b.Blit(x, y, *src, src_rect, Opacity(opacity)); });
+		CheckSame(*dst, [&](Bitmap& b) { b.Blit(x, y, *src, src_rect, Opacity(opacity), Bitmap::BlendMode::Normal); });
+		CheckSame(*dst, [&](Bitmap& b) { b.Blit(x, y, *src, src_rect, Opacity::Opaque(), Bitmap::BlendMode::NormalWithoutAlpha); });
+		CheckSame(*dst, [&](Bitmap& b) { b.BlitFast(x, y, *src, src_rect, Opacity::Opaque()); });
+		CheckSame(*dst, [&](Bitmap& b) { b.FlipBlit(x, y, *src, src_rect, flip_x, flip_y, Opacity(opacity)); });
+
+		const Color color(Random(0, 255), Random(0, 255), Random(0, 255), Random(0, 255));
+		CheckSame(*dst, [&](Bitmap& b) { b.BlendBlit(x, y, *src, src_rect, color, Opacity::Opaque()); });
+	}
+}
+}
+
+TEST_CASE("SameAsPixman") {
+	SUBCASE("alpha high") {
+		TestFormat(format_R8G8B8A8_a().format());
+	}
+	SUBCASE("alpha low") {
+		TestFormat(format_A8R8G8B8_a().format());
+	}
+}
+
+TEST_SUITE_END();
@@ -860,4 +860,76 @@ TEST_CASE("ChangeParam") {
 	}
 }
 
+TEST_CASE("StatCache") {
+	const MockActor m;
+	Game_Battler::SetStatCacheVerify(false);
+
+	auto actor = MakeActor(1, 1, 99, 100, 10, 11, 12, 13, 14);
+	lcf::Data::actors[0].parameters.attack[1] = 50;
+
+	REQUIRE_EQ(actor.GetAtk(), 11);
+
+	SUBCASE("level") {
+		actor.SetLevel(2);
+		REQUIRE_EQ(actor.GetBaseAtk(), 50);
+		REQUIRE_EQ(actor.GetAtk(), 50);
+	}
+
+	SUBCASE("equipment") {
+		MakeDBEquip(1, lcf::rpg::Item::Type_weapon, 20);
+		REQUIRE_EQ(actor.GetAtk(), 11);
+
+		actor.SetEquipment(1, 1);
+		REQUIRE_EQ(actor.GetAtk(), 31);
+
+		actor.SetEquipment(1, 0);
+		REQUIRE_EQ(actor.GetAtk(), 11);
+	}
+
+	SUBCASE("two weapons") {
+		MakeDBEquip(1, lcf::rpg::Item::Type_weapon, 20);
+		actor.SetTwoWeapons(true);
+		actor.SetEquipment(1, 1);
+		actor.SetEquipment(2, 1);
+		REQUIRE_EQ(actor.GetAtk(Game_Battler::WeaponSecondary), 31);
+		REQUIRE_EQ(actor.GetAtk(), 51);
+
+		actor.SetEquipment(2, 0);
+		REQUIRE_EQ(actor.GetAtk(Game_Battler::WeaponSecondary), 11);
+		REQUIRE_EQ(actor.GetAtk(), 31);
+	}
+
+	SUBCASE("modifier") {
+		actor.SetBaseAtk(40);
+		REQUIRE_EQ(actor.GetAtk(), 40);
+
+		actor.SetAtkModifier(5);
+		REQUIRE_EQ(actor.GetAtk(), 45);
+	}
+
+	SUBCASE("state") {
+		auto& state = lcf::Data::states[1];
+		state.affect_attack = true;
+		state.affect_type = lcf::rpg::State::AffectType_double;
+
+		actor.AddState(2, true);
+		REQUIRE_EQ(actor.GetAtk(), 22);
+
+		actor.RemoveState(2, false);
+		REQUIRE_EQ(actor.GetAtk(), 11);
+	}
+
+	SUBCASE("database") {
+		MakeDBEquip(1, lcf::rpg::Item::Type_weapon, 20);
+		actor.SetEquipment(1, 1);
+		REQUIRE_EQ(actor.GetAtk(), 31);
+
+		lcf::Data::items[0].atk_points1 = 30;
+		REQUIRE_EQ(actor.GetAtk(), 41);
+
+		lcf::Data::actors[0].parameters.attack[0] = 30;
+		REQUIRE_EQ(actor.GetAtk(), 60);
+	}
+}
+
 TEST_SUITE_END();
@@ -2,7 +2,12 @@
 #include "doctest.h"
 #include "options.h"
 #include "game_map.h"
+#include "game_switches.h"
+#include "game_variables.h"
 #include "main_data.h"
+#include "mock_game.h"
+#include "rand.h"
+#include "test_mock_actor.h"
 #include <climits>
 
 TEST_SUITE_BEGIN("Game_Event");
@@ -28,4 +33,254 @@ TEST_CASE("IdName") {
 	}
 }
 
+static void AddConditionEvent(lcf::rpg::Map& map, int id, int switch_id, int var_id) {
+	map.events.push_back({});
+	auto& ev = map.events.back();
+	ev.ID = id;
+	ev.pages.resize(2);
+	ev.pages[0].ID = 1;
+	ev.pages[1].ID = 2;
+	auto& cond = ev.pages[1].condition;
+	if (switch_id > 0) {
+		cond.flags.switch_a = true;
+		cond.switch_a_id = switch_id;
+	}
+	if (var_id > 0) {
+		cond.flags.variable = true;
+		cond.variable_id = var_id;
+		cond.variable_value = 5;
+		cond.compare_operator = 1;
+	}
+}
+
+TEST_CASE("RefreshDependingEvents") {
+	const MockGame mg(MockMap::ePass40x30);
+
+	auto map = MakeMockMap(MockMap::ePass40x30);
+	AddConditionEvent(*map, 2, 1, 0);
+	AddConditionEvent(*map, 3, 0, 1);
+	Game_Map::Setup(std::move(map));
+
+	REQUIRE(Game_Map::GetNeedRefresh());
+	int count = Game_Map::GetPageRefreshCount();
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetPageRefreshCount() - count, 3);
+	REQUIRE_EQ(MockGame::GetEvent(2)->GetActivePage()->ID, 1);
+	REQUIRE_EQ(MockGame::GetEvent(3)->GetActivePage()->ID, 1);
+
+	// Unused switch
+	Main_Data::game_switches->Set(2, true);
+	Game_Map::SetNeedRefreshForSwitchChange(2);
+	REQUIRE_FALSE(Game_Map::GetNeedRefresh());
+
+	Main_Data::game_switches->Set(1, true);
+	Game_Map::SetNeedRefreshForSwitchChange(1);
+	REQUIRE(Game_Map::GetNeedRefresh());
+	count = Game_Map::GetPageRefreshCount();
+	Game_Map::Refresh();
+	REQUIRE_FALSE(Game_Map::GetNeedRefresh());
+	REQUIRE_EQ(Game_Map::GetPageRefreshCount() - count, 1);
+	REQUIRE_EQ(MockGame::GetEvent(2)->GetActivePage()->ID, 2);
+	REQUIRE_EQ(MockGame::GetEvent(3)->GetActivePage()->ID, 1);
+
+	Main_Data::game_variables->Set(1, 5);
+	Game_Map::SetNeedRefreshForVarChange(1, 10);
+	count = Game_Map::GetPageRefreshCount();
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetPageRefreshCount() - count, 1);
+	REQUIRE_EQ(MockGame::GetEvent(3)->GetActivePage()->ID, 2);
+
+	// Repeated changes refresh each event once
+	for (int i = 0; i < 100; ++i) {
+		Main_Data::game_variables->Set(1, i % 10);
+		Game_Map::SetNeedRefreshForVarChange(1);
+		Main_Data::game_switches->Flip(1);
+		Game_Map::SetNeedRefreshForSwitchChange(1);
+	}
+	count = Game_Map::GetPageRefreshCount();
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetPageRefreshCount() - count, 2);
+	REQUIRE_FALSE(Game_Map::GetNeedRefresh());
+
+	// A full refresh overrides the queued events
+	Game_Map::SetNeedRefreshForSwitchChange(1);
+	Game_Map::SetNeedRefresh(true);
+	count = Game_Map::GetPageRefreshCount();
+	Game_Map::Refresh();
+	REQUIRE_EQ(Game_Map::GetPageRefreshCount() - count, 3);
+}
+
+static void AddEventPage(lcf::rpg::Map& map, int id, int x, int y, int anim_type, int move_type) {
+	map.events.push_back({});
+	auto& ev = map.events.back();
+	ev.ID = id;
+	ev.x = x;
+	ev.y = y;
+	ev.pages.resize(1);
+	ev.pages[0].ID = 1;
+	ev.pages[0].animation_type = anim_type;
+	ev.pages[0].move_type = move_type;
+	if (move_type == lcf::rpg::EventPage::MoveType_custom) {
+		lcf::rpg::MoveCommand cmd;
+		cmd.command_id = static_cast<int>(lcf::rpg::MoveCommand::Code::move_right);
+		ev.pages[0].move_route.move_commands.push_back(cmd);
+		cmd.command_id = static_cast<int>(lcf::rpg::MoveCommand::Code::move_left);
+		ev.pages[0].move_route.move_commands.push_back(cmd);
+		ev.pages[0].move_route.repeat = true;
+	}
+}
+
+static lcf::rpg::EventCommand MakeCommand(lcf::rpg::EventCommand::Code code, std::vector<int32_t> params) {
+	lcf::rpg::EventCommand cmd;
+	cmd.code = static_cast<int>(code);
+	cmd.parameters = lcf::DBArray<int32_t>(params.begin(), params.end());
+	return cmd;
+}
+
+/** State of the map after a frame */
+struct MapFrame {
+	std::vector<lcf::rpg::SaveMapEvent> events;
+	std::vector<bool> switches;
+	std::vector<int32_t> variables;
+
+	bool operator==(const MapFrame& o) const {
+		return events == o.events && switches == o.switches && variables == o.variables;
+	}
+};
+
+/**
+ * Runs the map events for a number of frames and records the event data
+ * (position, animation, interpreter state), the switches and the variables.
+ */
+static std::vector<MapFrame> ReplayEvents(bool event_scheduling, int frames, int& num_idle) {
+	using Code = lcf::rpg::EventCommand::Code;
+	const MockGame mg(MockMap::ePass40x30);
+
+	auto map = MakeMockMap(MockMap::ePass40x30);
+	AddEventPage(*map, 2, 5, 5, AnimType::AnimType_non_continuous, MoveType::MoveType_stationary);
+	AddEventPage(*map, 3, 6, 5, AnimType::AnimType_fixed_graphic, MoveType::MoveType_stationary);
+	AddEventPage(*map, 4, 7, 5, AnimType::AnimType_non_continuous, MoveType::MoveType_stationary);
+	AddEventPage(*map, 5, 8, 5, AnimType::AnimType_spin, MoveType::MoveType_stationary);
+	AddEventPage(*map, 6, 9, 5, AnimType::AnimType_continuous, MoveType::MoveType_stationary);
+	AddEventPage(*map, 7, 20, 20, AnimType::AnimType_non_continuous, MoveType::MoveType_random);
+	AddEventPage(*map, 8, 10, 10, AnimType::AnimType_non_continuous, MoveType::MoveType_custom);
+	AddEventPage(*map, 9, 30, 20, AnimType::AnimType_spin, MoveType::MoveType_random);
+	AddEventPage(*map, 10, 30, 10, AnimType::AnimType_continuous, MoveType::MoveType_vertical);
+
+	// Parallel process which flips switch 1 and counts in variable 1
+	AddEventPage(*map, 11, 1, 1, AnimType::AnimType_non_continuous, MoveType::MoveType_stationary);
+	auto& parallel = map->events.back().pages[0];
+	parallel.trigger = lcf::rpg::EventPage::Trigger_parallel;
+	parallel.event_commands.push_back(MakeCommand(Code::ControlSwitches, { 0, 1, 1, 2 }));
+	parallel.event_commands.push_back(MakeCommand(Code::ControlVars, { 0, 1, 1, 1, 0, 1 }));
+	parallel.event_commands.push_back(MakeCommand(Code::Wait, { 3 }));
+
+	// Walks while switch 1 is on and stands idle otherwise
+	AddEventPage(*map, 12, 15, 15, AnimType::AnimType_non_continuous, MoveType::MoveType_stationary);
+	map->events.back().pages.push_back(map->events.back().pages[0]);
+	auto& walking = map->events.back().pages[1];
+	walking.ID = 2;
+	walking.move_type = MoveType::MoveType_random;
+	walking.condition.flags.switch_a = true;
+	walking.condition.switch_a_id = 1;
+
+	Game_Map::Setup(std::move(map));
+	Game_Map::Refresh();
+	Game_Map::SetEventSchedulingEnabled(event_scheduling);
+	Rand::SeedRandomNumberGenerator(1234);
+
+	MockGame::GetEvent(4)->Flash(31, 0, 0, 31, 60);
+	MockGame::GetEvent(9)->Flash(0, 31, 0, 31, 90);
+
+	std::vector<MapFrame> history;
+	num_idle = 0;
+	for (int frame = 0; frame < frames; ++frame) {
+		if (frame == 150) {
+			lcf::rpg::MoveRoute route;
+			lcf::rpg::MoveCommand cmd;
+			cmd.command_id = static_cast<int>(lcf::rpg::MoveCommand::Code::move_down);
+			route.move_commands.push_back(cmd);
+			MockGame::GetEvent(2)->ForceMoveRoute(route, 8);
+		}
+
+		for (auto& ev: Game_Map::GetEvents()) {
+			num_idle += ev.GetUpdateClass() == Game_Event::UpdateClass::Idle;
+		}
+
+		if (Game_Map::GetNeedRefresh()) {
+			Game_Map::Refresh();
+		}
+		Game_Map::UpdateProcessedFlags(false);
+		MapUpdateAsyncContext actx;
+		Game_Map::UpdateCommonEvents(actx);
+		Game_Map::UpdateMapEvents(actx);
+
+		MapFrame state;
+		for (auto& ev: Game_Map::GetEvents()) {
+			state.events.push_back(ev.GetSaveData());
+		}
+		state.switches = Main_Data::game_switches->GetData();
+		state.variables = Main_Data::game_variables->GetData();
+		history.push_back(std::move(state));
+	}
+
+	Game_Map::SetEventSchedulingEnabled(true);
+	return history;
+}
+
+TEST_CASE("EventSchedulingEquivalence") {
+	const int frames = 600;
+	int num_idle = 0;
+	auto reference = ReplayEvents(false, frames, num_idle);
+	auto scheduled = ReplayEvents(true, frames, num_idle);
+
+	REQUIRE_GT(num_idle, 0);
+	REQUIRE_EQ(reference.size(), scheduled.size());
+	for (size_t i = 0; i < reference.size(); ++i) {
+		CAPTURE(i);
+		REQUIRE(reference[i] == scheduled[i]);
+	}
+
+	// The parallel process ran every 3 tenths of a second
+	REQUIRE_FALSE(scheduled.back().variables.empty());
+	REQUIRE_GT(scheduled.back().variables[0], frames / 40);
+}
+
+TEST_CASE("RefreshEquippedItemEvents") {
+	using Code = lcf::rpg::EventCommand::Code;
+	const MockGame mg(MockMap::ePass40x30);
+
+	// The item is only equipped by actor 2
+	lcf::Data::actors.resize(2);
+	lcf::Data::actors[0].ID = 1;
+	lcf::Data::actors[1].ID = 2;
+	MakeDBActor(2, 1, 50, 10)->initial_equipment.weapon_id = 5;
+	lcf::Data::items.resize(5);
+	for (int i = 0; i < 5; ++i) {
+		lcf::Data::items[i].ID = i + 1;
+	}
+	MakeDBEquip(5, lcf::rpg::Item::Type_weapon);
+	Main_Data::game_actors = std::make_unique<Game_Actors>();
+	REQUIRE_EQ(Main_Data::game_actors->GetActor(2)->GetWeaponId(), 5);
+
+	auto map = MakeMockMap(MockMap::ePass40x30);
+	AddConditionEvent(*map, 2, 0, 0);
+	map->events.back().pages[1].condition.flags.item = true;
+	map->events.back().pages[1].condition.item_id = 5;
+	Game_Map::Setup(std::move(map));
+	Game_Map::Refresh();
+	REQUIRE_EQ(MockGame::GetEvent(2)->GetActivePage()->ID, 1);
+
+	auto& interpreter = Game_Map::GetInterpreter();
+	interpreter.ExecuteCommand(MakeCommand(Code::ChangePartyMember, { 0, 0, 2 }));
+	REQUIRE(Game_Map::GetNeedRefresh());
+	Game_Map::Refresh();
+	REQUIRE_EQ(MockGame::GetEvent(2)->GetActivePage()->ID, 2);
+
+	interpreter.ExecuteCommand(MakeCommand(Code::ChangePartyMember, { 1, 0, 2 }));
+	REQUIRE(Game_Map::GetNeedRefresh());
+	Game_Map::Refresh();
+	REQUIRE_EQ(MockGame::GetEvent(2)->GetActivePage()->ID, 1);
+}
+
 TEST_SUITE_END();
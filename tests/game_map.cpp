@@ -0,0 +1,81 @@
+#include "game_map.h"
+#include "mock_game.h"
+#include "pathfinder.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Game_Map");
+
+TEST_CASE("SubstitutePassability") {
+	const MockGame mg(MockMap::ePass40x30);
+
+	lcf::Data::chipsets[0].passable_data_upper[1] = Passable::Counter;
+	Game_Map::SetChipset(1);
+
+	REQUIRE(Game_Map::IsPassableTile(nullptr, Passable::Down, 5, 5));
+	REQUIRE_FALSE(Game_Map::IsCounter(5, 5));
+	REQUIRE_EQ(Game_Map::GetTerrainTag(5, 5), 1);
+
+	REQUIRE_EQ(Game_Map::SubstituteUp(0, 1), 1);
+	REQUIRE_FALSE(Game_Map::IsPassableTile(nullptr, Passable::Down, 5, 5));
+	REQUIRE(Game_Map::IsCounter(5, 5));
+
+	REQUIRE_EQ(Game_Map::SubstituteUp(1, 0), 2);
+	REQUIRE(Game_Map::IsPassableTile(nullptr, Passable::Down, 5, 5));
+	REQUIRE_FALSE(Game_Map::IsCounter(5, 5));
+}
+
+TEST_CASE("FindPath") {
+	const MockGame mg(MockMap::ePass40x30);
+	Pathfinder::ClearCache();
+
+	// Wall at x = 10 with a gap at the bottom
+	auto map = MakeMockMap(MockMap::ePass40x30);
+	for (int y = 0; y < 29; ++y) {
+		map->upper_layer[10 + y * 40] = BLOCK_F + 1;
+	}
+	lcf::Data::chipsets[0].passable_data_upper[1] = 0;
+
+	// Tile event with the wall tile, moved into the gap later
+	map->events.resize(1);
+	map->events[0].ID = 1;
+	map->events[0].x = 5;
+	map->events[0].y = 5;
+	map->events[0].pages.resize(1);
+	map->events[0].pages[0].ID = 1;
+	map->events[0].pages[0].character_index = 1;
+	map->events[0].pages[0].layer = lcf::rpg::EventPage::Layers_below;
+	Game_Map::Setup(std::move(map));
+
+	auto& player = *MockGame::GetPlayer();
+	player.SetX(0);
+	player.SetY(0);
+
+	std::vector<int> directions;
+	Pathfinder::Params params;
+	REQUIRE(Pathfinder::FindPath(player, 20, 0, params, directions));
+	REQUIRE_EQ(directions.size(), 20 + 29 * 2);
+
+	REQUIRE(Pathfinder::FindPath(player, 20, 0, params, directions));
+	REQUIRE_EQ(Pathfinder::GetStats().cache_hits, 1);
+
+	params.allow_diagonal = true;
+	REQUIRE(Pathfinder::FindPath(player, 20, 0, params, directions));
+	REQUIRE_EQ(directions.size(), 29 * 2);
+
+	// Tile events change the passability without a cached path going stale
+	auto& ev = *MockGame::GetEvent(1);
+	ev.SetX(10);
+	ev.SetY(29);
+	REQUIRE_FALSE(Pathfinder::FindPath(player, 20, 0, params, directions));
+	ev.SetActive(false);
+	REQUIRE(Pathfinder::FindPath(player, 20, 0, params, directions));
+	REQUIRE_EQ(directions.size(), 29 * 2);
+
+	// All tiles blocked
+	params.allow_diagonal = false;
+	REQUIRE(Game_Map::SubstituteUp(0, 1) > 0);
+	REQUIRE_FALSE(Pathfinder::FindPath(player, 20, 0, params, directions));
+	REQUIRE(directions.empty());
+}
+
+TEST_SUITE_END();
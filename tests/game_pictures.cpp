@@ -0,0 +1,215 @@
+#include <memory>
+#include "bitmap.h"
+#include "cache.h"
+#include "drawable_list.h"
+#include "drawable_mgr.h"
+#include "filefinder.h"
+#include "game_clock.h"
+#include "game_pictures.h"
+#include "main_data.h"
+#include "pixel_format.h"
+#include "player.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Game_Pictures");
+
+namespace {
+class EngineGuard {
+public:
+	explicit EngineGuard(int engine) {
+		_engine = Player::game_config.engine;
+		Player::game_config.engine = engine;
+	}
+
+	EngineGuard(const EngineGuard&) = delete;
+	EngineGuard& operator=(const EngineGuard&) = delete;
+
+	~EngineGuard() {
+		Player::game_config.engine = _engine;
+	}
+private:
+	int _engine = {};
+};
+
+Game_Pictures::ShowParams MakeShowParams(int x, int y) {
+	Game_Pictures::ShowParams params;
+	params.position_x = x;
+	params.position_y = y;
+	return params;
+}
+
+/** Game directory, drawables and an empty cache for pictures with sprites */
+class PictureGuard {
+public:
+	PictureGuard() {
+		Bitmap::SetFormat(format_R8G8B8A8_a().format());
+		FileFinder::SetGameFilesystem(FileFinder::Root().Subtree(EP_TEST_PATH "/game"));
+		DrawableMgr::SetLocalList(&list);
+		Cache::ClearAll();
+		Game_Clock::ResetFrame(Game_Clock::now());
+		Main_Data::game_pictures = std::make_unique<Game_Pictures>();
+	}
+
+	PictureGuard(const PictureGuard&) = delete;
+	PictureGuard& operator=(const PictureGuard&) = delete;
+
+	~PictureGuard() {
+		Main_Data::game_pictures.reset();
+		Cache::ClearAll();
+		DrawableMgr::SetLocalList(nullptr);
+		FileFinder::SetGameFilesystem({});
+	}
+private:
+	DrawableList list;
+};
+
+/** Lets time pass and misses the cache, which frees the bitmaps nobody holds */
+void FreeUnusedBitmaps() {
+	static int misses = 0;
+	Game_Clock::ResetFrame(Game_Clock::GetFrameTime() + std::chrono::seconds(10));
+	Cache::Picture("miss" + std::to_string(++misses), false);
+}
+
+Game_Pictures::MoveParams MakeMoveParams(int x, int y, int duration) {
+	Game_Pictures::MoveParams params;
+	params.position_x = x;
+	params.position_y = y;
+	params.duration = duration;
+	return params;
+}
+}
+
+TEST_CASE("Move") {
+	const EngineGuard eg(Player::EngineRpg2k3 | Player::EngineMajorUpdated | Player::EngineEnglish);
+	Game_Pictures pictures;
+
+	REQUIRE(pictures.Show(1, MakeShowParams(10, 20)));
+	pictures.Update(false);
+
+	pictures.Move(1, MakeMoveParams(20, 40, -10));
+	for (int i = 0; i < 5; ++i) {
+		pictures.Update(false);
+	}
+
+	const auto& data = pictures.GetPicture(1).data;
+	REQUIRE_EQ(data.current_x, doctest::Approx(15.0));
+	REQUIRE_EQ(data.current_y, doctest::Approx(30.0));
+
+	for (int i = 0; i < 5; ++i) {
+		pictures.Update(false);
+	}
+	REQUIRE_EQ(data.current_x, 20.0);
+	REQUIRE_EQ(data.current_y, 40.0);
+}
+
+TEST_CASE("Frames") {
+	const EngineGuard eg(Player::EngineRpg2k3 | Player::EngineMajorUpdated | Player::EngineEnglish);
+	Game_Pictures pictures;
+
+	auto map_params = MakeShowParams(0, 0);
+	auto battle_params = MakeShowParams(0, 0);
+	battle_params.map_layer = 0;
+	battle_params.battle_layer = 1;
+
+	REQUIRE(pictures.Show(1, map_params));
+	REQUIRE(pictures.Show(2, battle_params));
+	REQUIRE(pictures.Show(3, map_params));
+	pictures.Move(3, MakeMoveParams(100, 100, -20));
+
+	for (int i = 0; i < 10; ++i) {
+		pictures.Update(false);
+	}
+	for (int i = 0; i < 4; ++i) {
+		pictures.Update(true);
+	}
+
+	// Settled pictures still count the frames of their layer
+	auto save = pictures.GetSaveData();
+	REQUIRE_EQ(save[0].frames, 10);
+	REQUIRE_EQ(save[1].frames, 4);
+	REQUIRE_EQ(save[2].frames, 10);
+
+	pictures.Move(1, MakeMoveParams(5, 5, -2));
+	REQUIRE_EQ(pictures.GetPicture(1).data.frames, 10);
+	pictures.Update(false);
+	REQUIRE_EQ(pictures.GetPicture(1).data.frames, 11);
+
+	REQUIRE(pictures.Show(2, battle_params));
+	save = pictures.GetSaveData();
+	REQUIRE_EQ(save[1].frames, 0);
+}
+
+TEST_CASE("Rotation") {
+	const EngineGuard eg(Player::EngineRpg2k3 | Player::EngineMajorUpdated | Player::EngineEnglish);
+	Game_Pictures pictures;
+
+	auto params = MakeShowParams(0, 0);
+	params.effect_mode = lcf::rpg::SavePicture::Effect_rotation;
+	params.effect_power = 8;
+	REQUIRE(pictures.Show(1, params));
+
+	const auto& data = pictures.GetPicture(1).data;
+	for (int i = 1; i <= 10; ++i) {
+		pictures.Update(false);
+		REQUIRE_EQ(data.current_rotation, 8.0 * i);
+	}
+}
+
+TEST_CASE("PreloadShow") {
+	const EngineGuard eg(Player::EngineRpg2k3 | Player::EngineMajorUpdated | Player::EngineEnglish);
+	const PictureGuard pg;
+	auto& pictures = *Main_Data::game_pictures;
+
+	pictures.Preload("preload", false);
+	pictures.Update(false);
+
+	// The preload holds the decoded bitmap in the cache until it is shown
+	std::weak_ptr<Bitmap> preloaded = Cache::Picture("preload", false);
+	FreeUnusedBitmaps();
+	REQUIRE_FALSE(preloaded.expired());
+
+	auto params = MakeShowParams(0, 0);
+	params.name = "preload";
+	REQUIRE(pictures.Show(1, params));
+
+	const auto& pic = pictures.GetPicture(1);
+	REQUIRE(pic.sprite);
+	REQUIRE_EQ(pic.sprite->GetBitmap(), preloaded.lock());
+
+	// Shown pictures are held by the sprite, the preload is released
+	pictures.Erase(1);
+	FreeUnusedBitmaps();
+	REQUIRE(preloaded.expired());
+}
+
+TEST_CASE("PreloadEviction") {
+	const EngineGuard eg(Player::EngineRpg2k3 | Player::EngineMajorUpdated | Player::EngineEnglish);
+	const PictureGuard pg;
+	auto& pictures = *Main_Data::game_pictures;
+
+	std::vector<std::weak_ptr<Bitmap>> preloaded;
+	for (int i = 0; i < 9; ++i) {
+		auto name = "preload" + std::to_string(i);
+		pictures.Preload(name, false);
+		pictures.Update(false);
+		preloaded.push_back(Cache::Picture(name, false));
+	}
+
+	// Only 8 preloads are held, the oldest decoded one was dropped
+	FreeUnusedBitmaps();
+	REQUIRE(preloaded[0].expired());
+	for (int i = 1; i < 9; ++i) {
+		REQUIRE_FALSE(preloaded[i].expired());
+	}
+
+	// Preloads which are never shown expire
+	for (int i = 0; i < 600; ++i) {
+		pictures.Update(false);
+	}
+	FreeUnusedBitmaps();
+	for (auto& bitmap : preloaded) {
+		REQUIRE(bitmap.expired());
+	}
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,342 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "midisequencer.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("MidiSequencer");
+
+using namespace std::chrono_literals;
+
+namespace {
+/** Builds a track of a standard MIDI file */
+class TrackWriter {
+public:
+	void Event(uint32_t delta, std::vector<uint8_t> bytes) {
+		WriteVariable(delta);
+		data.insert(data.end(), bytes.begin(), bytes.end());
+	}
+
+	void Tempo(uint32_t delta, uint32_t tempo) {
+		Event(delta, { 0xFF, 0x51, 0x03, static_cast<uint8_t>(tempo >> 16), static_cast<uint8_t>(tempo >> 8), static_cast<uint8_t>(tempo) });
+	}
+
+	void Sysex(uint32_t delta, std::vector<uint8_t> bytes) {
+		WriteVariable(delta);
+		data.push_back(0xF0);
+		WriteVariable(static_cast<uint32_t>(bytes.size()));
+		data.insert(data.end(), bytes.begin(), bytes.end());
+	}
+
+	void Finish(std::vector<uint8_t>& file) {
+		Event(0, { 0xFF, 0x2F, 0x00 });
+		uint32_t size = static_cast<uint32_t>(data.size());
+		file.insert(file.end(), { 'M', 'T', 'r', 'k',
+			static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16), static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size) });
+		file.insert(file.end(), data.begin(), data.end());
+	}
+
+private:
+	void WriteVariable(uint32_t value) {
+		uint8_t buf[5];
+		int n = 0;
+		do {
+			buf[n++] = value & 0x7F;
+			value >>= 7;
+		} while (value);
+		while (n > 1) {
+			data.push_back(buf[--n] | 0x80);
+		}
+		data.push_back(buf[0]);
+	}
+
+	std::vector<uint8_t> data;
+};
+
+std::vector<uint8_t> MakeHeader(int tracks, int division) {
+	return { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, static_cast<uint8_t>(tracks),
+		static_cast<uint8_t>(division >> 8), static_cast<uint8_t>(division) };
+}
+
+struct Reader {
+	const std::vector<uint8_t>* data;
+	size_t pos = 0;
+
+	static int Getc(void* instance) {
+		auto* r = static_cast<Reader*>(instance);
+		if (r->pos >= r->data->size()) {
+			return EOF;
+		}
+		return (*r->data)[r->pos++];
+	}
+};
+
+bool Load(midisequencer::sequencer& seq, const std::vector<uint8_t>& file) {
+	Reader r;
+	r.data = &file;
+	return seq.load(&r, Reader::Getc);
+}
+
+/**
+ * 2 tracks with tempo changes, about 5000 random controller, program,
+ * pitch bend, pressure and note events, RPN changes and a GS reset.
+ */
+std::vector<uint8_t> MakeSong() {
+	auto file = MakeHeader(2, 96);
+
+	TrackWriter tempo;
+	tempo.Tempo(0, 500000);
+	tempo.Tempo(960, 250000);
+	tempo.Tempo(2000, 600000);
+	tempo.Finish(file);
+
+	TrackWriter track;
+	uint32_t seed = 7;
+	auto rnd = [&](int max) {
+		seed = seed * 1103515245 + 12345;
+		return static_cast<int>((seed >> 16) % max);
+	};
+	const uint8_t controllers[] = { 0, 1, 7, 10, 11, 32, 64, 71, 91, 93 };
+	for (int i = 0; i < 5000; ++i) {
+		uint32_t delta = rnd(4);
+		uint8_t ch = static_cast<uint8_t>(rnd(16));
+		uint8_t value = static_cast<uint8_t>(rnd(128));
+		if (i == 2500) {
+			track.Sysex(delta, { 0x41, 0x10, 0x42, 0x12, 0x40, 0x00, 0x7F, 0x00, 0x41, 0xF7 });
+			continue;
+		}
+		switch (rnd(10)) {
+			case 0:
+			case 1:
+				track.Event(delta, { static_cast<uint8_t>(0x90 | ch), static_cast<uint8_t>(40 + rnd(40)), 100 });
+				break;
+			case 2:
+				track.Event(delta, { static_cast<uint8_t>(0x80 | ch), static_cast<uint8_t>(40 + rnd(40)), 64 });
+				break;
+			case 3:
+				track.Event(delta, { static_cast<uint8_t>(0xC0 | ch), value });
+				break;
+			case 4:
+				track.Event(delta, { static_cast<uint8_t>(0xE0 | ch), static_cast<uint8_t>(rnd(128)), value });
+				break;
+			case 5:
+				track.Event(delta, { static_cast<uint8_t>(0xD0 | ch), value });
+				break;
+			case 6: {
+				// Bend range or tuning, then the RPN is deselected
+				uint8_t rpn = static_cast<uint8_t>(rnd(3));
+				track.Event(delta, { static_cast<uint8_t>(0xB0 | ch), 101, 0 });
+				track.Event(0, { static_cast<uint8_t>(0xB0 | ch), 100, rpn });
+				track.Event(0, { static_cast<uint8_t>(0xB0 | ch), 6, value });
+				track.Event(0, { static_cast<uint8_t>(0xB0 | ch), 38, static_cast<uint8_t>(rnd(128)) });
+				track.Event(0, { static_cast<uint8_t>(0xB0 | ch), 101, 127 });
+				track.Event(0, { static_cast<uint8_t>(0xB0 | ch), 100, 127 });
+				break;
+			}
+			case 7:
+				if (rnd(20) == 0) {
+					track.Event(delta, { static_cast<uint8_t>(0xB0 | ch), 121, 0 });
+					break;
+				}
+				// fall through
+			default:
+				track.Event(delta, { static_cast<uint8_t>(0xB0 | ch), controllers[rnd(10)], value });
+				break;
+		}
+	}
+	track.Finish(file);
+
+	return file;
+}
+
+/** Controller state as a synthesizer keeps it */
+class Recorder : public midisequencer::output {
+public:
+	struct Channel {
+		std::array<int, 128> controllers;
+		int program;
+		int pitch_bend;
+		int pressure;
+		std::array<int, 6> rpn;
+
+		bool operator==(const Channel& o) const {
+			return controllers == o.controllers && program == o.program && pitch_bend == o.pitch_bend
+				&& pressure == o.pressure && rpn == o.rpn;
+		}
+	};
+
+	std::array<Channel, 16> channels;
+	std::vector<uint32_t> notes;
+
+	Recorder() {
+		reset();
+	}
+
+	void midi_message(int, uint_least32_t message) override {
+		auto& ch = channels[message & 0x0F];
+		int value1 = (message >> 8) & 0x7F;
+		int value2 = (message >> 16) & 0x7F;
+		switch (message & 0xF0) {
+			case 0x80:
+			case 0x90:
+				notes.push_back(message);
+				break;
+			case 0xB0:
+				if (value1 == 121) {
+					ResetControllers(ch);
+				} else if (value1 < 120) {
+					ch.controllers[value1] = value2;
+				}
+				if ((value1 == 6 || value1 == 38) && ch.controllers[101] == 0 && ch.controllers[100] < 3) {
+					ch.rpn[ch.controllers[100] * 2 + (value1 == 38)] = value2;
+				}
+				break;
+			case 0xC0:
+				ch.program = value1;
+				break;
+			case 0xD0:
+				ch.pressure = value1;
+				break;
+			case 0xE0:
+				ch.pitch_bend = value1 | (value2 << 7);
+				break;
+		}
+	}
+
+	void sysex_message(int, const void*, std::size_t) override {
+		// The only sysex of the song is a reset
+		reset();
+	}
+
+	void meta_event(int, const void*, std::size_t) override {
+	}
+
+	void reset() override {
+		for (auto& ch: channels) {
+			ch.controllers.fill(0);
+			ch.controllers[7] = 100;
+			ch.controllers[10] = 64;
+			ch.program = 0;
+			ch.rpn = { 2, 0, 64, 0, 64, 0 };
+			ResetControllers(ch);
+		}
+	}
+
+	/** State without the data entry values, they are part of the RPNs */
+	std::array<Channel, 16> GetState() const {
+		auto state = channels;
+		for (auto& ch: state) {
+			ch.controllers[6] = 0;
+			ch.controllers[38] = 0;
+		}
+		return state;
+	}
+
+private:
+	static void ResetControllers(Channel& ch) {
+		for (int i = 1; i < 128; ++i) {
+			if (i != 7 && i != 10 && i != 32 && (i < 91 || i > 95)) {
+				ch.controllers[i] = 0;
+			}
+		}
+		ch.controllers[11] = 127;
+		ch.controllers[100] = 127;
+		ch.controllers[101] = 127;
+		ch.pitch_bend = 8192;
+		ch.pressure = 0;
+	}
+};
+}
+
+TEST_CASE("Ticks") {
+	auto file = MakeHeader(1, 96);
+	TrackWriter track;
+	track.Tempo(0, 500000);
+	track.Event(480, { 0x90, 60, 100 });
+	track.Tempo(480, 250000);
+	track.Event(960, { 0x80, 60, 64 });
+	track.Finish(file);
+
+	midisequencer::sequencer seq;
+	REQUIRE(Load(seq, file));
+
+	// 10 quarters at 0.5 s, then 0.25 s per quarter
+	REQUIRE_EQ(seq.get_ticks(0us), 0);
+	REQUIRE_EQ(seq.get_ticks(2500000us), 480);
+	REQUIRE_EQ(seq.get_ticks(5000000us), 960);
+	REQUIRE_EQ(seq.get_ticks(5250000us), 1056);
+	REQUIRE_EQ(seq.get_ticks(7500000us), 1920);
+
+	REQUIRE_EQ(seq.get_time(480), 2500000us);
+	REQUIRE_EQ(seq.get_time(1056), 5250000us);
+	REQUIRE_EQ(seq.get_time(1920), 7500000us);
+	REQUIRE_EQ(seq.get_total_time(), 7500000us);
+}
+
+TEST_CASE("SeekMatchesLinearPlayback") {
+	auto file = MakeSong();
+
+	midisequencer::sequencer linear_seq;
+	REQUIRE(Load(linear_seq, file));
+	Recorder linear;
+
+	const auto total = linear_seq.get_total_time();
+	const auto step = 1500us;
+	auto time = 0us;
+
+	for (int i = 1; i <= 12; ++i) {
+		const auto target = total * i / 11;
+		while (time < target) {
+			time = std::min(time + step, target);
+			linear_seq.play(time, &linear);
+		}
+		CAPTURE(time.count());
+
+		midisequencer::sequencer seq;
+		REQUIRE(Load(seq, file));
+		Recorder seeked;
+		seq.set_time(time, &seeked);
+		REQUIRE(seeked.GetState() == linear.GetState());
+
+		// Playback continues with the same notes
+		const auto next = time + 100000us;
+		size_t notes = linear.notes.size();
+		auto linear_time = time;
+		while (linear_time < next) {
+			linear_time += step;
+			linear_seq.play(linear_time, &linear);
+		}
+		seeked.notes.clear();
+		auto seek_time = time;
+		while (seek_time < next) {
+			seek_time += step;
+			seq.play(seek_time, &seeked);
+		}
+		REQUIRE_EQ(std::vector<uint32_t>(linear.notes.begin() + notes, linear.notes.end()), seeked.notes);
+		REQUIRE(seeked.GetState() == linear.GetState());
+		time = linear_time;
+	}
+}
+
+TEST_CASE("PlayBackwardsRestoresState") {
+	auto file = MakeSong();
+
+	midisequencer::sequencer seq;
+	REQUIRE(Load(seq, file));
+	Recorder out;
+	const auto half = seq.get_total_time() / 2;
+	seq.play(seq.get_total_time(), &out);
+
+	// Jumping back does not replay the notes before the target
+	out.notes.clear();
+	seq.play(half, &out);
+	REQUIRE(out.notes.empty());
+
+	midisequencer::sequencer linear_seq;
+	REQUIRE(Load(linear_seq, file));
+	Recorder linear;
+	linear_seq.play(half, &linear);
+	REQUIRE(out.GetState() == linear.GetState());
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,134 @@
+#include "system.h"
+
+#ifdef WANT_FMMIDI
+#include <vector>
+#include "decoder_fmmidi.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("MidiSynth");
+
+namespace {
+/**
+ * Renders a note sample by sample and in blocks of odd sizes, the key is
+ * released and the damper pressed inside of a block.
+ */
+void CheckBlockRendering(const midisynth::FMPARAMETER& params, int note, bool vibrato, bool tremolo) {
+	midisynth::fm_sound_generator a(params, note, 1.0f);
+	midisynth::fm_sound_generator b(params, note, 1.0f);
+	for (auto* gen: { &a, &b }) {
+		gen->set_rate(44100);
+		if (vibrato) {
+			gen->set_vibrato(0.3f, 5.0f);
+		}
+		if (tremolo) {
+			gen->set_tremolo(90, 4.0f);
+		}
+	}
+
+	const int key_off = 7001;
+	const int damper = 15003;
+	std::vector<int> expected;
+	for (int i = 0; i < 20000; ++i) {
+		if (i == key_off) {
+			a.key_off();
+		}
+		if (i == damper) {
+			a.set_damper(100);
+		}
+		expected.push_back(a.get_next());
+	}
+
+	std::vector<int> out(20000);
+	int pos = 0;
+	for (int size: { 3, 100, 6898, 7899, 103, 4997 }) {
+		if (pos == key_off) {
+			b.key_off();
+		}
+		if (pos == damper) {
+			b.set_damper(100);
+		}
+		b.render(&out[pos], size);
+		pos += size;
+	}
+
+	REQUIRE_EQ(out, expected);
+}
+}
+
+TEST_CASE("BlockRendering") {
+	FmMidiDecoder decoder;
+
+	for (int program = 0; program < 128; ++program) {
+		CAPTURE(program);
+		midisynth::FMPARAMETER params;
+		decoder.note_factory->get_program(program, params);
+		const int note = 30 + program % 60;
+
+		CheckBlockRendering(params, note, false, false);
+		CheckBlockRendering(params, note, true, true);
+	}
+}
+
+TEST_CASE("VoiceLimit") {
+	FmMidiDecoder decoder;
+	auto& synth = *decoder.synth;
+	std::vector<int_least16_t> out(256 * 2);
+
+	synth.set_max_notes(0);
+	for (int note = 40; note < 80; ++note) {
+		synth.note_on(note % 16, note, 100);
+	}
+	REQUIRE_EQ(synth.get_num_notes(), 40);
+
+	synth.all_sound_off_immediately();
+	synth.synthesize(out.data(), 256, 44100);
+	REQUIRE_EQ(synth.get_num_notes(), 0);
+
+	synth.set_max_notes(8);
+	for (int note = 40; note < 80; ++note) {
+		synth.note_on(note % 16, note, 100);
+		REQUIRE_LE(synth.get_num_notes(), 8);
+	}
+	REQUIRE_EQ(synth.get_num_notes(), 8);
+
+	// Releasing and starting notes never exceeds the limit
+	for (int note = 40; note < 80; ++note) {
+		synth.note_off(note % 16, note, 64);
+		synth.note_on((note + 3) % 16, note + 1, 100);
+		synth.synthesize(out.data(), 256, 44100);
+		REQUIRE_LE(synth.get_num_notes(), 8);
+	}
+}
+
+TEST_CASE("RenderThreads") {
+	FmMidiDecoder serial;
+	FmMidiDecoder threaded;
+	threaded.synth->set_render_threads(3);
+	REQUIRE_EQ(serial.synth->get_render_threads(), 1);
+	REQUIRE_EQ(threaded.synth->get_render_threads(), 3);
+
+	std::vector<int_least16_t> expected(256 * 2);
+	std::vector<int_least16_t> out(256 * 2);
+	for (int block = 0; block < 200; ++block) {
+		for (auto* decoder: { &serial, &threaded }) {
+			auto& synth = *decoder->synth;
+			if (block == 0) {
+				for (int ch = 0; ch < 16; ++ch) {
+					synth.program_change(ch, ch * 7);
+				}
+			}
+			synth.note_on(block % 16, 40 + block % 37, 100);
+			synth.note_off((block + 5) % 16, 40 + (block + 20) % 37, 64);
+		}
+		serial.synth->synthesize(expected.data(), 256, 44100);
+		threaded.synth->synthesize(out.data(), 256, 44100);
+		REQUIRE_EQ(out, expected);
+	}
+
+	threaded.synth->set_render_threads(1);
+	REQUIRE_EQ(threaded.synth->get_render_threads(), 1);
+}
+
+TEST_SUITE_END();
+
+#endif
@@ -0,0 +1,85 @@
+#include <memory>
+#include <thread>
+#include "spsc_queue.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("SpscQueue");
+
+TEST_CASE("PushPop") {
+	SpscQueue<int, 4> queue;
+	int value = 0;
+
+	REQUIRE(queue.IsEmpty());
+	REQUIRE_FALSE(queue.Pop(value));
+
+	for (int i = 1; i <= 4; ++i) {
+		REQUIRE(queue.Push(std::move(i)));
+	}
+	REQUIRE_FALSE(queue.Push(5));
+	REQUIRE_FALSE(queue.IsEmpty());
+
+	for (int i = 1; i <= 4; ++i) {
+		REQUIRE(queue.Pop(value));
+		REQUIRE_EQ(value, i);
+	}
+	REQUIRE(queue.IsEmpty());
+	REQUIRE_FALSE(queue.Pop(value));
+}
+
+TEST_CASE("Wraparound") {
+	SpscQueue<int, 3> queue;
+	int value = 0;
+
+	for (int i = 0; i < 10; ++i) {
+		REQUIRE(queue.Push(i * 2));
+		REQUIRE(queue.Push(i * 2 + 1));
+		REQUIRE(queue.Pop(value));
+		REQUIRE_EQ(value, i * 2);
+		REQUIRE(queue.Pop(value));
+		REQUIRE_EQ(value, i * 2 + 1);
+	}
+	REQUIRE(queue.IsEmpty());
+}
+
+TEST_CASE("FullKeepsValue") {
+	SpscQueue<std::unique_ptr<int>, 1> queue;
+
+	REQUIRE(queue.Push(std::make_unique<int>(1)));
+	auto value = std::make_unique<int>(2);
+	REQUIRE_FALSE(queue.Push(std::move(value)));
+	REQUIRE(value);
+
+	std::unique_ptr<int> out;
+	REQUIRE(queue.Pop(out));
+	REQUIRE_EQ(*out, 1);
+	REQUIRE(queue.Push(std::move(value)));
+	REQUIRE_FALSE(value);
+}
+
+TEST_CASE("Threads") {
+	SpscQueue<int, 16> queue;
+	const int count = 100000;
+
+	std::thread producer([&]() {
+		for (int i = 0; i < count; ++i) {
+			while (!queue.Push(int(i))) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int expected = 0;
+	int value;
+	while (expected < count) {
+		if (queue.Pop(value)) {
+			REQUIRE_EQ(value, expected);
+			++expected;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+	REQUIRE(queue.IsEmpty());
+}
+
+TEST_SUITE_END();
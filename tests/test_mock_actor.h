@@ -12,6 +12,7 @@
 #include "main_data.h"
 #include "player.h"
 #include "output.h"
+#include "doctest.h"
 #include <lcf/data.h>
 
 static void InitEmptyDB() {
@@ -82,6 +83,9 @@ public:
 		Player::game_config.engine = eng;
 
 		InitEmptyDB();
+		Game_Battler::InvalidateAllStatCaches();
+		// Every cached stat is compared with the uncached computation
+		Game_Battler::SetStatCacheVerify(true);
 
 		Main_Data::Cleanup();
 
@@ -97,6 +101,9 @@ public:
 	}
 
 	~MockActor() {
+		CHECK_EQ(Game_Battler::GetStatCacheMismatches(), 0);
+		Game_Battler::SetStatCacheVerify(false);
+
 		Main_Data::Cleanup();
 
 		lcf::Data::data = {};
@@ -607,4 +607,92 @@ TEST_CASE("Sort") {
 	REQUIRE_EQ(s.Get(4), 4);
 }
 
+TEST_CASE("RangeOverflow") {
+	constexpr int n = 11;
+	lcf::Data::variables.resize(n);
+
+	auto _min = std::numeric_limits<Game_Variables::Var_t>::min();
+	auto _max = std::numeric_limits<Game_Variables::Var_t>::max();
+
+	Game_Variables v(_min, _max);
+	v.SetWarning(0);
+
+	// Covers the vectorized part and the remainder of the range
+	v.SetRange(1, n, _max);
+	v.AddRange(1, n, 1);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE_EQ(v.Get(i), _max);
+	}
+
+	v.SubRange(1, n, -1);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE_EQ(v.Get(i), _max);
+	}
+
+	v.SetRange(1, n, _min);
+	v.AddRange(1, n, -1);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE_EQ(v.Get(i), _min);
+	}
+
+	v.SubRange(1, n, 1);
+	for (int i = 1; i <= n; ++i) {
+		REQUIRE_EQ(v.Get(i), _min);
+	}
+
+	Game_Variables c(minval, maxval);
+	c.SetWarning(0);
+	c.SetData({ _min, _max, -5, 5, maxval, minval, 0, _max, _min, 1, -1 });
+	c.AddRange(1, n, maxval);
+	REQUIRE_EQ(c.GetData(), Game_Variables::Variables_t{ minval, maxval, maxval - 5, maxval, maxval, 0, maxval, maxval, minval, maxval, maxval - 1 });
+}
+
+TEST_CASE("ArrayOverlap") {
+	constexpr int n = 20;
+	lcf::Data::variables.resize(n);
+
+	for (int first_b = 1; first_b <= 10; ++first_b) {
+		CAPTURE(first_b);
+		Game_Variables v(minval, maxval);
+		Game_Variables e(minval, maxval);
+		v.EnumerateRange(1, n, 1);
+		e.EnumerateRange(1, n, 1);
+
+		v.AddArray(6, 15, first_b);
+		for (int i = 0; i < 10; ++i) {
+			e.Add(6 + i, e.Get(first_b + i));
+		}
+
+		REQUIRE_EQ(v.GetData(), e.GetData());
+	}
+}
+
+TEST_CASE("ChangedRange") {
+	auto s = make();
+	int first = 0;
+	int last = 0;
+
+	REQUIRE_FALSE(s.TakeChangedRange(first, last));
+
+	s.SetRange(1, max_vars, 0);
+	REQUIRE_FALSE(s.TakeChangedRange(first, last));
+
+	s.Set(2, 2);
+	s.Set(4, 4);
+	REQUIRE_FALSE(s.TakeChangedRange(first, last));
+
+	s.BitAndRange(1, max_vars, 4);
+	REQUIRE(s.TakeChangedRange(first, last));
+	REQUIRE_EQ(first, 2);
+	REQUIRE_EQ(last, 2);
+
+	s.AddRange(3, 3, 1);
+	s.SetArray(5, 5, 3);
+	REQUIRE(s.TakeChangedRange(first, last));
+	REQUIRE_EQ(first, 3);
+	REQUIRE_EQ(last, 5);
+
+	REQUIRE_FALSE(s.TakeChangedRange(first, last));
+}
+
 TEST_SUITE_END();